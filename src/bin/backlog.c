@@ -1,7 +1,16 @@
 #include "private.h"
 #include <Elementary.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "termpty.h"
 #include "backlog.h" 
+#if defined(BINARY_TYTEST)
+#include "unit_tests.h"
+#endif
 
 
 static int ts_comp = 0;
@@ -10,49 +19,1362 @@ static int ts_freeops = 0;
 static Eina_List *ptys = NULL;
 
 static int64_t _mem_used = 0;
+static int64_t _mem_peak = 0;
+/* What the backlogs take whatever their lines: the rings of lines, their
+ * indexes and the caches, left out of Config.scrollback_budget */
+static int64_t _mem_fixed = 0;
+/* Ticks every time a terminal is shown, see termpty_backlog_viewed() */
+static uint64_t _views = 0;
+
+/* The terminals have locks of their own, see termpty_backlog_lock(). These
+ * only guard what they share: the list of terminals, held while the budget
+ * is enforced on them, and the counters above.  No terminal lock is waited
+ * for with either held */
+static Eina_Lock _ptys_lock;
+static Eina_Lock _accounting_lock;
+static Eina_Bool _backlog_locks_ready = EINA_FALSE;
 
 static void
-_accounting_change(int64_t diff)
+_accounting_take(void)
+{
+   if (_backlog_locks_ready)
+     eina_lock_take(&_accounting_lock);
+}
+
+static void
+_accounting_release(void)
+{
+   if (_backlog_locks_ready)
+     eina_lock_release(&_accounting_lock);
+}
+
+static int64_t
+_accounting_round(int64_t diff)
 {
    if (diff > 0)
-     {
-        diff = ROUND_UP(diff, 16);
-     }
-   else
-     {
-        diff = DIV_ROUND_UP(-1 * diff, 16) * -16;
-     }
+     return ROUND_UP(diff, 16);
+   return DIV_ROUND_UP(-1 * diff, 16) * -16;
+}
+
+static void
+_accounting_change(int64_t diff)
+{
+   diff = _accounting_round(diff);
+   _accounting_take();
    _mem_used += diff;
+   if (_mem_used > _mem_peak)
+     _mem_peak = _mem_used;
+   _accounting_release();
+}
+
+static void
+_accounting_fixed_change(int64_t diff)
+{
+   diff = _accounting_round(diff);
+   _accounting_take();
+   _mem_used += diff;
+   _mem_fixed += diff;
+   if (_mem_used > _mem_peak)
+     _mem_peak = _mem_used;
+   _accounting_release();
+}
+
+/* What the lines of all the backlogs take */
+static int64_t
+_accounting_lines_get(void)
+{
+   int64_t used;
+
+   _accounting_take();
+   used = _mem_used - _mem_fixed;
+   _accounting_release();
+   return used;
+}
+
+static void
+_ts_count(int comp, int uncomp, int freeops)
+{
+   _accounting_take();
+   ts_comp += comp;
+   ts_uncomp += uncomp;
+   ts_freeops += freeops;
+   _accounting_release();
 }
 
 int64_t
 termpty_backlog_memory_get(void)
 {
-   return _mem_used;
+   int64_t used;
+
+   _accounting_take();
+   used = _mem_used;
+   _accounting_release();
+   return used;
+}
+
+int64_t
+termpty_backlog_memory_peak_get(void)
+{
+   int64_t peak;
+
+   _accounting_take();
+   peak = _mem_peak;
+   _accounting_release();
+   return peak;
 }
 
 
 void
 termpty_save_register(Termpty *ty)
 {
-   termpty_backlog_lock();
+   if (_backlog_locks_ready)
+     eina_lock_take(&_ptys_lock);
    ptys = eina_list_append(ptys, ty);
-   termpty_backlog_unlock();
+   if (_backlog_locks_ready)
+     eina_lock_release(&_ptys_lock);
 }
 
 void
 termpty_save_unregister(Termpty *ty)
 {
-   termpty_backlog_lock();
-   ptys = eina_list_remove(ptys, ty);
-   termpty_backlog_unlock();
+   if (_backlog_locks_ready)
+     eina_lock_take(&_ptys_lock);
+   ptys = eina_list_remove(ptys, ty);
+   if (_backlog_locks_ready)
+     eina_lock_release(&_ptys_lock);
+}
+
+/* Spilling {{{ */
+
+#define SPILL_MAP_MIN (1024 * 1024)
+
+static Termspill *
+_spill_new(void)
+{
+   Termspill *spill = calloc(1, sizeof(Termspill));
+
+   if (spill)
+     spill->fd = -1;
+   return spill;
+}
+
+static void
+_spill_block_add(Termspill *spill, Termsavecomp *block)
+{
+   block->spill = spill;
+   block->prev = spill->last;
+   block->next = NULL;
+   if (spill->last)
+     spill->last->next = block;
+   else
+     spill->first = block;
+   spill->last = block;
+   spill->mem += block->size;
+}
+
+static void
+_spill_block_remove(Termspill *spill, Termsavecomp *block)
+{
+   if (block->prev)
+     block->prev->next = block->next;
+   else
+     spill->first = block->next;
+   if (block->next)
+     block->next->prev = block->prev;
+   else
+     spill->last = block->prev;
+   block->prev = block->next = NULL;
+   spill->mem -= block->size;
+}
+
+/* A new file of XDG_RUNTIME_DIR, only reached through the descriptor
+ * returned: it goes away with it and its mappings. -1 if none */
+static int
+_spill_file_new(void)
+{
+   const char *dir = getenv("XDG_RUNTIME_DIR");
+   char path[PATH_MAX];
+   int fd;
+
+   if (!dir || !dir[0])
+     {
+        WRN("XDG_RUNTIME_DIR is not set, the backlog stays in memory");
+        return -1;
+     }
+   snprintf(path, sizeof(path), "%s/terminology-backlog-XXXXXX", dir);
+   fd = mkstemp(path);
+   if (fd < 0)
+     {
+        ERR("can not create '%s': %s", path, strerror(errno));
+        return -1;
+     }
+   unlink(path);
+   if (fcntl(fd, F_SETFD, FD_CLOEXEC) < 0)
+     ERR("fcntl(FD_CLOEXEC) failed: %s", strerror(errno));
+   return fd;
+}
+
+static Eina_Bool
+_spill_open(Termspill *spill)
+{
+   spill->fd = _spill_file_new();
+   return spill->fd >= 0;
+}
+
+/* Ring of @size lines mapped from a file of its own, zeroed. The slots of
+ * the spilled blocks are no longer touched: the kernel writes them back
+ * there and drops them from memory, as anonymous pages could not be without
+ * swap. NULL if that can not be done */
+static Termsave *
+_spill_ring_new(size_t size)
+{
+   size_t len = size * sizeof(Termsave);
+   Termsave *ring;
+   int fd = _spill_file_new();
+
+   if (fd < 0)
+     return NULL;
+   if (ftruncate(fd, len) < 0)
+     {
+        ERR("can not size the backlog: %s", strerror(errno));
+        close(fd);
+        return NULL;
+     }
+   ring = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if (ring == MAP_FAILED)
+     {
+        ERR("can not map the backlog: %s", strerror(errno));
+        return NULL;
+     }
+   return ring;
+}
+
+/* Maps at least @size bytes of the file, growing with it */
+static Eina_Bool
+_spill_map(Termspill *spill, size_t size)
+{
+   unsigned char *map;
+   size_t map_size = MAX(spill->map_size, SPILL_MAP_MIN);
+
+   if (size <= spill->map_size)
+     return EINA_TRUE;
+   while (map_size < size)
+     map_size *= 2;
+   map = mmap(NULL, map_size, PROT_READ, MAP_SHARED, spill->fd, 0);
+   if (map == MAP_FAILED)
+     {
+        ERR("can not map the backlog: %s", strerror(errno));
+        return EINA_FALSE;
+     }
+   if (spill->map)
+     munmap(spill->map, spill->map_size);
+   spill->map = map;
+   spill->map_size = map_size;
+   return EINA_TRUE;
+}
+
+/* Gives @size bytes at @offset back to the holes of the file, merged with
+ * the ones next to them. The file shrinks when that is at its end */
+static void
+_spill_hole_add(Termspill *spill, size_t offset, size_t size)
+{
+   Termextent *hole;
+   unsigned int i;
+
+   for (i = 0; (i < spill->nholes) && (spill->holes[i].offset < offset); i++)
+     ;
+   if ((i > 0) &&
+       (spill->holes[i - 1].offset + spill->holes[i - 1].size == offset))
+     {
+        hole = &spill->holes[i - 1];
+        hole->size += size;
+        if ((i < spill->nholes) &&
+            (hole->offset + hole->size == spill->holes[i].offset))
+          {
+             hole->size += spill->holes[i].size;
+             spill->nholes--;
+             memmove(&spill->holes[i], &spill->holes[i + 1],
+                     (spill->nholes - i) * sizeof(Termextent));
+          }
+     }
+   else if ((i < spill->nholes) && (offset + size == spill->holes[i].offset))
+     {
+        spill->holes[i].offset = offset;
+        spill->holes[i].size += size;
+     }
+   else
+     {
+        if (spill->nholes == spill->holes_max)
+          {
+             unsigned int max = MAX(spill->holes_max * 2, 8);
+
+             hole = realloc(spill->holes, max * sizeof(Termextent));
+             /* the space is lost till the file is emptied */
+             if (!hole)
+               return;
+             spill->holes = hole;
+             spill->holes_max = max;
+          }
+        memmove(&spill->holes[i + 1], &spill->holes[i],
+                (spill->nholes - i) * sizeof(Termextent));
+        spill->holes[i].offset = offset;
+        spill->holes[i].size = size;
+        spill->nholes++;
+     }
+
+   hole = &spill->holes[spill->nholes - 1];
+   if (hole->offset + hole->size == spill->size)
+     {
+        /* what is past the size is overwritten anyway */
+        if (ftruncate(spill->fd, hole->offset) < 0)
+          ERR("can not truncate the backlog: %s", strerror(errno));
+        spill->size = hole->offset;
+        spill->nholes--;
+     }
+#if defined(FALLOC_FL_PUNCH_HOLE)
+   else
+     fallocate(spill->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+               offset, size);
+#endif
+}
+
+/* Where @size bytes go: the first hole they fit in, or the end of the file
+ */
+static size_t
+_spill_alloc(Termspill *spill, size_t size)
+{
+   size_t offset;
+   unsigned int i;
+
+   for (i = 0; i < spill->nholes; i++)
+     {
+        Termextent *hole = &spill->holes[i];
+
+        if (hole->size < size)
+          continue;
+        offset = hole->offset;
+        hole->offset += size;
+        hole->size -= size;
+        if (!hole->size)
+          {
+             spill->nholes--;
+             memmove(hole, hole + 1, (spill->nholes - i) * sizeof(Termextent));
+          }
+        return offset;
+     }
+   offset = spill->size;
+   spill->size += size;
+   return offset;
+}
+
+/* Writes the data of @block to the file and frees it */
+static Eina_Bool
+_spill_write(Termspill *spill, Termsavecomp *block)
+{
+   size_t done = 0, offset;
+
+   if ((spill->fd < 0) && (!_spill_open(spill)))
+     return EINA_FALSE;
+   offset = _spill_alloc(spill, block->size);
+   if (!_spill_map(spill, spill->size))
+     goto fail;
+   while (done < block->size)
+     {
+        ssize_t len = pwrite(spill->fd, block->data + done,
+                             block->size - done, offset + done);
+        if (len < 0)
+          {
+             if (errno == EINTR)
+               continue;
+             ERR("can not write the backlog: %s", strerror(errno));
+             goto fail;
+          }
+        done += len;
+     }
+   block->offset = offset;
+   spill->used += block->size;
+   free(block->data);
+   block->data = NULL;
+   _accounting_change((-1) * (int64_t)block->size);
+   return EINA_TRUE;
+
+fail:
+   _spill_hole_add(spill, offset, block->size);
+   return EINA_FALSE;
+}
+
+/* The file space of a block no longer in the backlog */
+static void
+_spill_release(Termspill *spill, const Termsavecomp *block)
+{
+   spill->used -= block->size;
+   if (spill->used == 0)
+     {
+        /* whatever holes could not be kept track of */
+        spill->nholes = 0;
+        if (ftruncate(spill->fd, 0) < 0)
+          ERR("can not truncate the backlog: %s", strerror(errno));
+        spill->size = 0;
+        return;
+     }
+   _spill_hole_add(spill, block->offset, block->size);
+}
+
+/* Sends the oldest blocks of @ty to its file until the ones left in memory
+ * fit in @max bytes */
+static void
+_backlog_spill(Termpty *ty, size_t max)
+{
+   Termspill *spill = ty->spill;
+
+   while ((spill->mem > max) && (!spill->failed))
+     {
+        Termsavecomp *block = spill->first;
+
+        if (!_spill_write(spill, block))
+          {
+             /* keep the backlog in memory from now on */
+             spill->failed = EINA_TRUE;
+             return;
+          }
+        _spill_block_remove(spill, block);
+     }
+}
+
+static void
+_spill_free(Termspill *spill)
+{
+   if (spill->map)
+     munmap(spill->map, spill->map_size);
+   if (spill->fd >= 0)
+     close(spill->fd);
+   free(spill->holes);
+   free(spill);
+}
+
+/* }}} */
+/* Arena {{{ */
+
+/* Cells of the lines of a size class are carved out of aligned chunks, so
+ * that a line finds its chunk from its cells, and the free slots of a chunk
+ * are chained through their first cells.
+ * Longer lines go to malloc() */
+#define ARENA_CHUNK_SIZE (64 * 1024)
+#define ARENA_CHUNK_HEADER ROUND_UP(sizeof(Termchunk), 16)
+/* Percentage of free slots in a size class above which its lines are moved
+ * to as few chunks as possible, see _arena_compact() */
+#define ARENA_FRAGMENTATION_MAX 50
+/* Compacting walks the whole backlog: once done, the next lines saved do
+ * not compact again before 1 / ARENA_COMPACT_WAIT of it was saved */
+#define ARENA_COMPACT_WAIT 8
+
+struct tag_Termchunk
+{
+   Termchunk     *prev, *next;
+   Termcell      *free; // slots given back
+   unsigned int   used; // slots in use
+   unsigned int   top; // slots ever given, the next ones are still unused
+   unsigned char  cls;
+   Eina_Bool      evacuate;
+};
+
+static const unsigned int _arena_cells[TERMPTY_ARENA_CLASSES] = {
+     8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512
+};
+
+static int
+_arena_class(unsigned int w)
+{
+   int cls;
+
+   for (cls = 0; cls < TERMPTY_ARENA_CLASSES; cls++)
+     {
+        if (w <= _arena_cells[cls])
+          return cls;
+     }
+   return -1;
+}
+
+static unsigned int
+_arena_slots(int cls)
+{
+   return (ARENA_CHUNK_SIZE - ARENA_CHUNK_HEADER)
+      / (_arena_cells[cls] * sizeof(Termcell));
+}
+
+static Termchunk *
+_arena_chunk_of(const Termcell *cells)
+{
+   return (Termchunk *)((uintptr_t)cells & ~(uintptr_t)(ARENA_CHUNK_SIZE - 1));
+}
+
+/* Full chunks go last, so that the first one always has a free slot if
+ * any does */
+static void
+_arena_chunk_link(Termarena *arena, Termchunk *chunk)
+{
+   if (chunk->used == _arena_slots(chunk->cls))
+     {
+        chunk->prev = arena->last;
+        chunk->next = NULL;
+        if (arena->last)
+          arena->last->next = chunk;
+        else
+          arena->first = chunk;
+        arena->last = chunk;
+     }
+   else
+     {
+        chunk->prev = NULL;
+        chunk->next = arena->first;
+        if (arena->first)
+          arena->first->prev = chunk;
+        else
+          arena->last = chunk;
+        arena->first = chunk;
+     }
+}
+
+static void
+_arena_chunk_unlink(Termarena *arena, Termchunk *chunk)
+{
+   if (chunk->prev)
+     chunk->prev->next = chunk->next;
+   else
+     arena->first = chunk->next;
+   if (chunk->next)
+     chunk->next->prev = chunk->prev;
+   else
+     arena->last = chunk->prev;
+   chunk->prev = chunk->next = NULL;
+}
+
+static void
+_arena_chunk_free(Termarena *arena, Termchunk *chunk)
+{
+   arena->nchunks--;
+   free(chunk);
+   _accounting_change((-1) * (int64_t)ARENA_CHUNK_SIZE);
+}
+
+static Termcell *
+_arena_alloc(Termpty *ty, int cls)
+{
+   Termarena *arena = &ty->arena[cls];
+   Termchunk *chunk = arena->first;
+   Termcell *cells;
+   size_t slot = _arena_cells[cls] * sizeof(Termcell);
+
+   if (!chunk || chunk->used == _arena_slots(cls))
+     {
+        void *mem;
+
+        if (posix_memalign(&mem, ARENA_CHUNK_SIZE, ARENA_CHUNK_SIZE))
+          return NULL;
+        chunk = mem;
+        memset(chunk, 0, sizeof(Termchunk));
+        chunk->cls = cls;
+        _arena_chunk_link(arena, chunk);
+        arena->nchunks++;
+        _accounting_change(ARENA_CHUNK_SIZE);
+     }
+   if (chunk->free)
+     {
+        cells = chunk->free;
+        chunk->free = *(Termcell **)cells;
+     }
+   else
+     cells = (Termcell *)((unsigned char *)chunk + ARENA_CHUNK_HEADER
+                          + chunk->top++ * slot);
+   chunk->used++;
+   arena->used++;
+   if (chunk->used == _arena_slots(cls))
+     {
+        _arena_chunk_unlink(arena, chunk);
+        _arena_chunk_link(arena, chunk);
+     }
+   return cells;
+}
+
+static void
+_arena_free(Termpty *ty, Termcell *cells)
+{
+   Termchunk *chunk = _arena_chunk_of(cells);
+   Termarena *arena = &ty->arena[chunk->cls];
+   Eina_Bool full = (chunk->used == _arena_slots(chunk->cls));
+
+   *(Termcell **)cells = chunk->free;
+   chunk->free = cells;
+   chunk->used--;
+   arena->used--;
+   if (chunk->evacuate)
+     return;
+   if (chunk->used == 0)
+     {
+        /* the last one is kept, not to allocate it again on the next line */
+        _arena_chunk_unlink(arena, chunk);
+        if (arena->nchunks > 1)
+          {
+             _arena_chunk_free(arena, chunk);
+             return;
+          }
+        chunk->free = NULL;
+        chunk->top = 0;
+        _arena_chunk_link(arena, chunk);
+     }
+   else if (full)
+     {
+        _arena_chunk_unlink(arena, chunk);
+        _arena_chunk_link(arena, chunk);
+     }
+}
+
+static Eina_Bool
+_arena_fragmented(const Termarena *arena, int cls)
+{
+   size_t slots = _arena_slots(cls);
+   size_t capacity = arena->nchunks * slots;
+   size_t unused = capacity - arena->used;
+
+   return (unused >= 2 * slots)
+      && (unused * 100 > capacity * ARENA_FRAGMENTATION_MAX);
+}
+
+static int
+_chunk_used_cmp(const void *a, const void *b)
+{
+   const Termchunk *ca = *(Termchunk * const *)a;
+   const Termchunk *cb = *(Termchunk * const *)b;
+
+   return (cb->used > ca->used) - (cb->used < ca->used);
+}
+
+/* Takes the emptiest chunks of @cls out of the arena, to be evacuated.
+ * They are chained on @evacuated */
+static Termchunk *
+_arena_evacuate_prepare(Termpty *ty, int cls, Termchunk *evacuated)
+{
+   Termarena *arena = &ty->arena[cls];
+   Termchunk **chunks, *chunk;
+   unsigned int i, n = 0, keep;
+
+   chunks = malloc(arena->nchunks * sizeof(Termchunk *));
+   if (!chunks)
+     return evacuated;
+   for (chunk = arena->first; chunk; chunk = chunk->next)
+     chunks[n++] = chunk;
+   qsort(chunks, n, sizeof(Termchunk *), _chunk_used_cmp);
+   keep = DIV_ROUND_UP(arena->used, _arena_slots(cls));
+   for (i = keep; i < n; i++)
+     {
+        chunk = chunks[i];
+        _arena_chunk_unlink(arena, chunk);
+        chunk->evacuate = EINA_TRUE;
+        chunk->next = evacuated;
+        evacuated = chunk;
+     }
+   free(chunks);
+   return evacuated;
+}
+
+/* Moves the lines of the size classes too fragmented to the fullest
+ * chunks of their class, and frees the chunks left empty */
+static void
+_arena_compact(Termpty *ty)
+{
+   Termchunk *evacuated = NULL, *chunk, *next;
+   size_t i;
+   int cls;
+
+   for (cls = 0; cls < TERMPTY_ARENA_CLASSES; cls++)
+     {
+        if (_arena_fragmented(&ty->arena[cls], cls))
+          evacuated = _arena_evacuate_prepare(ty, cls, evacuated);
+     }
+   if (!evacuated)
+     return;
+
+   for (i = 0; i < ty->backsize; i++)
+     {
+        Termsave *ts = &ty->back[i];
+        Termcell *cells;
+
+        if (!ts->cells || ts->comp || _arena_class(ts->w) < 0
+            || !_arena_chunk_of(ts->cells)->evacuate)
+          continue;
+        cells = _arena_alloc(ty, _arena_class(ts->w));
+        if (!cells)
+          continue;
+        memcpy(cells, ts->cells, ts->w * sizeof(Termcell));
+        _arena_free(ty, ts->cells);
+        ts->cells = cells;
+     }
+
+   for (chunk = evacuated; chunk; chunk = next)
+     {
+        next = chunk->next;
+        chunk->evacuate = EINA_FALSE;
+        if (chunk->used == 0)
+          _arena_chunk_free(&ty->arena[chunk->cls], chunk);
+        else
+          _arena_chunk_link(&ty->arena[chunk->cls], chunk);
+     }
+   ty->arena_wait = ty->backsize / ARENA_COMPACT_WAIT;
+}
+
+/* Frees every chunk at once, whatever lines are still in there */
+static void
+_arena_release(Termpty *ty)
+{
+   int cls;
+
+   for (cls = 0; cls < TERMPTY_ARENA_CLASSES; cls++)
+     {
+        Termarena *arena = &ty->arena[cls];
+
+        while (arena->first)
+          {
+             Termchunk *chunk = arena->first;
+
+             _arena_chunk_unlink(arena, chunk);
+             _arena_chunk_free(arena, chunk);
+          }
+        arena->used = 0;
+     }
+}
+
+/* Cells malloc()'ed for a line of @w cells, too long for the arena: the
+ * size classes go on, alternating between 2^n and 3 * 2^(n-1), so that a
+ * line growing row after row is seldom moved */
+static size_t
+_cells_capacity(unsigned int w)
+{
+   size_t capacity = _arena_cells[TERMPTY_ARENA_CLASSES - 1];
+
+   while (capacity < w)
+     capacity = (capacity % 3) ? capacity / 2 * 3 : capacity / 3 * 4;
+   return capacity;
+}
+
+static Termcell *
+_cells_new(Termpty *ty, unsigned int w)
+{
+   int cls = _arena_class(w);
+   Termcell *cells;
+
+   if (cls >= 0)
+     return _arena_alloc(ty, cls);
+   cells = malloc(_cells_capacity(w) * sizeof(Termcell));
+   if (cells)
+     _accounting_change(_cells_capacity(w) * sizeof(Termcell));
+   return cells;
+}
+
+static void
+_cells_free(Termpty *ty, Termcell *cells, unsigned int w)
+{
+   if (_arena_class(w) >= 0)
+     {
+        _arena_free(ty, cells);
+        return;
+     }
+   free(cells);
+   _accounting_change((-1) * (int64_t)(_cells_capacity(w) * sizeof(Termcell)));
+}
+
+/* Gives @cells of @w cells room for @new_w, possibly moving them */
+static Termcell *
+_cells_resize(Termpty *ty, Termcell *cells, unsigned int w,
+              unsigned int new_w)
+{
+   int cls = _arena_class(w), new_cls = _arena_class(new_w);
+   size_t capacity = _cells_capacity(w), new_capacity;
+   Termcell *new_cells;
+
+   if (cls >= 0 && cls == new_cls)
+     return cells;
+   if (cls < 0 && new_cls < 0)
+     {
+        new_capacity = _cells_capacity(new_w);
+        if (new_capacity == capacity)
+          return cells;
+        new_cells = realloc(cells, new_capacity * sizeof(Termcell));
+        if (!new_cells)
+          return NULL;
+        _accounting_change((-1) * (int64_t)(capacity * sizeof(Termcell)));
+        _accounting_change(new_capacity * sizeof(Termcell));
+        return new_cells;
+     }
+   new_cells = _cells_new(ty, new_w);
+   if (!new_cells)
+     return NULL;
+   memcpy(new_cells, cells, MIN(w, new_w) * sizeof(Termcell));
+   _cells_free(ty, cells, w);
+   return new_cells;
+}
+
+/* }}} */
+
+static void
+_block_free(Termpty *ty, Termsavecomp *block)
+{
+   int i;
+
+   for (i = 0; i < TERMPTY_CACHE_SIZE; i++)
+     {
+        if (ty->cache.entries[i].block == block)
+          ty->cache.entries[i].block = NULL;
+     }
+   if (block->data)
+     {
+        if (block->spill)
+          _spill_block_remove(block->spill, block);
+        free(block->data);
+        _accounting_change((-1) * (int64_t)block->size);
+     }
+   else
+     _spill_release(block->spill, block);
+   _accounting_change((-1) * (int64_t)(sizeof(Termsavecomp)
+       + (block->natts + block->nclusters) * sizeof(uint32_t)));
+   free(block);
+}
+
+/* Cells of @block, decompressed in the cache of @ty */
+static Termcell *
+_block_expand(Termpty *ty, const Termsavecomp *block)
+{
+   Termcache *cache = ty->cache.entries, *entry = &cache[0];
+   Eina_Binbuf *in, *out;
+   Eina_Bool ok;
+   int i;
+
+   ty->cache.use++;
+   for (i = 0; i < TERMPTY_CACHE_SIZE; i++)
+     {
+        if (cache[i].block == block)
+          {
+             cache[i].last_use = ty->cache.use;
+             return cache[i].cells;
+          }
+        if (cache[i].last_use < entry->last_use)
+          entry = &cache[i];
+     }
+
+   entry->block = NULL;
+   if (entry->size < block->wout)
+     {
+        Termcell *cells = realloc(entry->cells,
+                                  block->wout * sizeof(Termcell));
+        if (!cells)
+          return NULL;
+        _accounting_fixed_change((-1)
+                                 * (int64_t)(entry->size * sizeof(Termcell)));
+        _accounting_fixed_change(block->wout * sizeof(Termcell));
+        entry->cells = cells;
+        entry->size = block->wout;
+     }
+   in = eina_binbuf_manage_new(block->data ? block->data
+                               : block->spill->map + block->offset,
+                               block->size, EINA_TRUE);
+   out = eina_binbuf_manage_new((unsigned char *)entry->cells,
+                                block->wout * sizeof(Termcell), EINA_TRUE);
+   ok = in && out && emile_expand(in, out, EMILE_LZ4);
+   if (in)
+     eina_binbuf_free(in);
+   if (out)
+     eina_binbuf_free(out);
+   if (!ok)
+     {
+        ERR("can not expand %u lines of backlog", block->lines);
+        return NULL;
+     }
+   entry->block = block;
+   entry->last_use = ty->cache.use;
+   return entry->cells;
+}
+
+Termcell *
+termpty_save_cells_get(Termpty *ty, Termsave *ts)
+{
+   Termcell *cells;
+
+   if (!ts->comp)
+     return ts->cells;
+   cells = _block_expand(ty, ts->block);
+   if (!cells)
+     return NULL;
+   return cells + ts->block->offsets[ts->line];
+}
+
+/* Gives back to @ts its own cells */
+Termsave *
+termpty_save_extract(Termpty *ty, Termsave *ts)
+{
+   Termsavecomp *block;
+   Termcell *cells, *expanded;
+
+   if (!ts) return NULL;
+   if (!ts->comp) return ts;
+
+   block = ts->block;
+   expanded = termpty_save_cells_get(ty, ts);
+   if (!expanded)
+     return NULL;
+   cells = _cells_new(ty, ts->w);
+   if (!cells)
+     return NULL;
+   memcpy(cells, expanded, ts->w * sizeof(Termcell));
+   ts->cells = cells;
+   ts->comp = 0;
+   ts->line = 0;
+   _ts_count(-1, 1, 0);
+   if (--block->lines == 0)
+     _block_free(ty, block);
+   return ts;
+}
+
+static int
+_id_cmp(const void *a, const void *b)
+{
+   uint32_t ia = *(const uint32_t *)a, ib = *(const uint32_t *)b;
+
+   return (ia > ib) - (ia < ib);
+}
+
+/* Sorts @ids and returns how many different ones there are, moved first */
+static uint32_t
+_ids_unique(uint32_t *ids, uint32_t n)
+{
+   uint32_t i, len = 0;
+
+   if (n == 0)
+     return 0;
+   qsort(ids, n, sizeof(uint32_t), _id_cmp);
+   for (i = 1; i < n; i++)
+     {
+        if (ids[i] != ids[len])
+          ids[++len] = ids[i];
+     }
+   return len + 1;
+}
+
+/* Compresses the TERMPTY_SAVE_BLOCK_LINES lines of the backlog from @start
+ * into one block, provided they are all there and not compressed yet.
+ * Returns EINA_FALSE when that is worth trying again later, on lack of
+ * memory */
+static Eina_Bool
+_backlog_block_compress(Termpty *ty, size_t start)
+{
+   Termsavecomp *block;
+   Termcell *cells = NULL;
+   uint32_t *ids = NULL;
+   Eina_Binbuf *in = NULL, *out = NULL;
+   unsigned int offsets[TERMPTY_SAVE_BLOCK_LINES];
+   uint32_t natts, nclusters = 0;
+   size_t i, n = 0, size;
+   Eina_Bool done = EINA_FALSE;
+
+   for (i = 0; i < TERMPTY_SAVE_BLOCK_LINES; i++)
+     {
+        Termsave *ts = &ty->back[start + i];
+
+        if (!ts->cells || ts->comp)
+          return EINA_TRUE;
+        offsets[i] = n;
+        n += ts->w;
+     }
+   if (n == 0)
+     return EINA_TRUE;
+
+   cells = malloc(n * sizeof(Termcell));
+   ids = malloc(2 * n * sizeof(uint32_t));
+   if (!cells || !ids)
+     goto end;
+   for (i = 0; i < TERMPTY_SAVE_BLOCK_LINES; i++)
+     {
+        Termsave *ts = &ty->back[start + i];
+
+        memcpy(cells + offsets[i], ts->cells, ts->w * sizeof(Termcell));
+     }
+   for (i = 0; i < n; i++)
+     {
+        ids[i] = cells[i].att_id;
+        if (EINA_UNLIKELY(TERMPTY_CODEPOINT_IS_CLUSTER(cells[i].codepoint)))
+          ids[n + nclusters++] = cells[i].codepoint & ~TERMPTY_CLUSTER_FLAG;
+     }
+   natts = _ids_unique(ids, n);
+   nclusters = _ids_unique(ids + n, nclusters);
+
+   in = eina_binbuf_manage_new((unsigned char *)cells, n * sizeof(Termcell),
+                               EINA_TRUE);
+   if (!in)
+     goto end;
+   out = emile_compress(in, EMILE_LZ4, EMILE_DEFAULT);
+   if (!out)
+     goto end;
+   /* nothing to gain, nor later */
+   done = EINA_TRUE;
+   if (eina_binbuf_length_get(out) >= n * sizeof(Termcell))
+     goto end;
+   done = EINA_FALSE;
+
+   /* the data goes on its own, to be spilled */
+   size = sizeof(Termsavecomp) + (natts + nclusters) * sizeof(uint32_t);
+   block = calloc(1, size);
+   if (!block)
+     goto end;
+   block->lines = TERMPTY_SAVE_BLOCK_LINES;
+   block->size = eina_binbuf_length_get(out);
+   block->wout = n;
+   memcpy(block->offsets, offsets, sizeof(offsets));
+   block->natts = natts;
+   block->nclusters = nclusters;
+   block->ids = (uint32_t *)(block + 1);
+   memcpy(block->ids, ids, natts * sizeof(uint32_t));
+   memcpy(block->ids + natts, ids + n, nclusters * sizeof(uint32_t));
+   block->data = eina_binbuf_string_steal(out);
+   _accounting_change(size);
+   _accounting_change(block->size);
+
+   for (i = 0; i < TERMPTY_SAVE_BLOCK_LINES; i++)
+     {
+        Termsave *ts = &ty->back[start + i];
+
+        _cells_free(ty, ts->cells, ts->w);
+        ts->block = block;
+        ts->comp = 1;
+        ts->line = i;
+     }
+   _ts_count(TERMPTY_SAVE_BLOCK_LINES, -TERMPTY_SAVE_BLOCK_LINES, 0);
+
+   if (ty->config && ty->config->scrollback_spill > 0)
+     {
+        if (!ty->spill)
+          ty->spill = _spill_new();
+        if (ty->spill)
+          {
+             _spill_block_add(ty->spill, block);
+             _backlog_spill(ty, ty->config->scrollback_spill);
+          }
+     }
+   done = EINA_TRUE;
+
+end:
+   if (in)
+     eina_binbuf_free(in);
+   if (out)
+     eina_binbuf_free(out);
+   free(ids);
+   free(cells);
+   return done;
+}
+
+/* Index {{{ */
+
+static int
+_index_value(const Termpty *ty, const Termsave *ts)
+{
+   if (!ts->cells)
+     return 0;
+   return (ts->w == 0) ? 1 : DIV_ROUND_UP(ts->w, ty->w);
+}
+
+/* Sum of the rows of the slots 0 to @i included */
+static int
+_index_prefix(const int *rows, ssize_t i)
+{
+   size_t k;
+   int sum = 0;
+
+   for (k = i + 1; k > 0; k -= k & -k)
+     sum += rows[k - 1];
+   return sum;
+}
+
+static void
+_index_add(int *rows, size_t n, size_t i, int delta)
+{
+   size_t k;
+
+   for (k = i + 1; k <= n; k += k & -k)
+     rows[k - 1] += delta;
+}
+
+/* First slot whose prefix reaches @v, or @n */
+static size_t
+_index_lower_bound(const int *rows, size_t n, int v)
+{
+   size_t pos = 0, step = 1;
+
+   while (step * 2 <= n)
+     step *= 2;
+   for (; step > 0; step /= 2)
+     {
+        if ((pos + step <= n) && (rows[pos + step - 1] < v))
+          {
+             pos += step;
+             v -= rows[pos - 1];
+          }
+     }
+   return pos;
+}
+
+static void
+_index_free(Termpty *ty)
+{
+   Backlog_Index *index = &ty->backlog_index;
+
+   if (index->rows)
+     {
+        free(index->rows);
+        _accounting_fixed_change((-1) * (int64_t)(ty->backsize * sizeof(int)));
+     }
+   memset(index, 0, sizeof(Backlog_Index));
+}
+
+/* Rebuilds the tree if the screen changed width since */
+static Eina_Bool
+_index_ready(Termpty *ty)
+{
+   Backlog_Index *index = &ty->backlog_index;
+   size_t i, n = ty->backsize;
+
+   if (index->rows && (index->w == ty->w))
+     return EINA_TRUE;
+   if ((n == 0) || (ty->w <= 0) || !ty->back)
+     return EINA_FALSE;
+   if (!index->rows)
+     {
+        index->rows = malloc(n * sizeof(int));
+        if (!index->rows)
+          return EINA_FALSE;
+        _accounting_fixed_change(n * sizeof(int));
+     }
+   for (i = 0; i < n; i++)
+     index->rows[i] = _index_value(ty, &ty->back[i]);
+   for (i = 1; i <= n; i++)
+     {
+        size_t parent = i + (i & -i);
+
+        if (parent <= n)
+          index->rows[parent - 1] += index->rows[i - 1];
+     }
+   for (i = 1; (i < n) && BACKLOG_ROW_GET(ty, i)->cells; i++)
+     ;
+   index->lines = i - 1;
+   index->w = ty->w;
+   return EINA_TRUE;
+}
+
+/* To call once the cells of @ts changed */
+static void
+_index_update(Termpty *ty, const Termsave *ts)
+{
+   Backlog_Index *index = &ty->backlog_index;
+   size_t i;
+   int old;
+
+   /* else rebuilt on the next lookup */
+   if (!index->rows || (index->w != ty->w))
+     return;
+   if ((ts < ty->back) || (ts >= ty->back + ty->backsize))
+     return;
+   i = ts - ty->back;
+   old = _index_prefix(index->rows, i) - _index_prefix(index->rows, i - 1);
+   if (old != _index_value(ty, ts))
+     _index_add(index->rows, ty->backsize, i, _index_value(ty, ts) - old);
+}
+
+/* }}} */
+/* Budget {{{ */
+
+/* Takes the lock of @ty if it is free or already held by the caller */
+static Eina_Bool
+_backlog_trylock(Termpty *ty)
+{
+   if (!ty->lock.ready)
+     return EINA_TRUE;
+   if (eina_lock_take_try(&ty->lock.lock) != EINA_LOCK_SUCCEED)
+     return EINA_FALSE;
+   ty->lock.depth++;
+   return EINA_TRUE;
+}
+
+static int
+_view_cmp(const void *a, const void *b)
+{
+   const Termpty *ta = *(Termpty * const *)a;
+   const Termpty *tb = *(Termpty * const *)b;
+
+   return (ta->backlog_view > tb->backlog_view)
+      - (ta->backlog_view < tb->backlog_view);
+}
+
+/* Compresses every block of lines of @ty, the hot ones included, but for
+ * the block of the newest line: it may still grow */
+static void
+_budget_compress(Termpty *ty, int64_t target)
+{
+   size_t start, newest;
+
+   if (!ty->backsize)
+     return;
+   newest = BACKLOG_ROW_GET(ty, 1) - ty->back;
+   for (start = 0;
+        (start + TERMPTY_SAVE_BLOCK_LINES <= ty->backsize)
+        && (_accounting_lines_get() > target);
+        start += TERMPTY_SAVE_BLOCK_LINES)
+     {
+        if (newest - start >= TERMPTY_SAVE_BLOCK_LINES)
+          _backlog_block_compress(ty, start);
+     }
+   _arena_compact(ty);
+}
+
+/* Drops the oldest lines of @ty. Its selection is cut to the lines left;
+ * its scroll position, reset beacon aside, is brought back within them by
+ * termpty_backscroll_adjust() */
+static void
+_budget_trim(Termpty *ty, int64_t target)
+{
+   size_t i;
+   ssize_t rows;
+
+   for (i = 0; (i < ty->backsize) && (_accounting_lines_get() > target); i++)
+     termpty_save_free(ty, &ty->back[(ty->backpos + i) % ty->backsize]);
+   if (!i)
+     return;
+   _arena_compact(ty);
+   ty->backlog_index.w = 0;
+   ty->backlog_beacon.screen_y = 0;
+   ty->backlog_beacon.backlog_y = 0;
+
+   rows = termpty_backlog_length(ty);
+   if (ty->selection.start.y < -rows)
+     {
+        ty->selection.start.x = 0;
+        ty->selection.start.y = -rows;
+     }
+   if (ty->selection.end.y < -rows)
+     {
+        ty->selection.end.x = 0;
+        ty->selection.end.y = -rows;
+     }
+   if (ty->selection.orig.y < -rows)
+     {
+        ty->selection.orig.x = 0;
+        ty->selection.orig.y = -rows;
+     }
+}
+
+/* Brings the memory used by the lines of all the backlogs back under
+ * Config.scrollback_budget: they get compressed, then spilled, then
+ * dropped, those of the terminals shown the least recently first. The
+ * terminals busy in another thread are left alone this time */
+static void
+_backlog_budget_enforce(const Config *config)
+{
+   int64_t budget = (int64_t)config->scrollback_budget * 1024 * 1024;
+   /* not to start again on the next line */
+   int64_t target = budget - budget / 8;
+   Termpty **tys, *ty;
+   Eina_List *l;
+   unsigned int i, n = 0;
+
+   if ((budget <= 0) || (_accounting_lines_get() <= budget))
+     return;
+   if (_backlog_locks_ready)
+     eina_lock_take(&_ptys_lock);
+   tys = malloc(eina_list_count(ptys) * sizeof(Termpty *));
+   if (!tys)
+     goto end;
+   EINA_LIST_FOREACH(ptys, l, ty)
+     {
+        if (_backlog_trylock(ty))
+          tys[n++] = ty;
+     }
+   qsort(tys, n, sizeof(Termpty *), _view_cmp);
+
+   for (i = 0; (i < n) && (_accounting_lines_get() > target); i++)
+     _budget_compress(tys[i], target);
+   for (i = 0; (i < n) && (_accounting_lines_get() > target); i++)
+     {
+        if (tys[i]->spill)
+          _backlog_spill(tys[i], 0);
+     }
+   for (i = 0; (i < n) && (_accounting_lines_get() > target); i++)
+     _budget_trim(tys[i], target);
+   for (i = 0; i < n; i++)
+     termpty_backlog_unlock(tys[i]);
+   free(tys);
+end:
+   if (_backlog_locks_ready)
+     eina_lock_release(&_ptys_lock);
+}
+
+/* To call when @ty is shown, its backlog is then the last to give memory
+ * back when over budget */
+void
+termpty_backlog_viewed(Termpty *ty)
+{
+   if (_backlog_locks_ready)
+     eina_lock_take(&_ptys_lock);
+   ty->backlog_view = ++_views;
+   if (_backlog_locks_ready)
+     eina_lock_release(&_ptys_lock);
+}
+
+/* }}} */
+
+/* Compresses the blocks of lines that went cold, from ty->compress_next
+ * on: those not compressed for lack of memory are tried again with the next
+ * line */
+static void
+_backlog_cold_compress(Termpty *ty)
+{
+   size_t blocks = ty->backsize / TERMPTY_SAVE_BLOCK_LINES;
+   /* backpos - 1 is the slot the next line goes to, the newest is before */
+   size_t newest = BACKLOG_ROW_GET(ty, 1) - ty->back;
+
+   if (ty->backsize < BACKLOG_HOT_LINES + 2 * TERMPTY_SAVE_BLOCK_LINES)
+     return;
+   if (ty->compress_next >= blocks * TERMPTY_SAVE_BLOCK_LINES)
+     ty->compress_next = 0;
+   while (blocks--)
+     {
+        size_t start = ty->compress_next;
+        size_t last = start + TERMPTY_SAVE_BLOCK_LINES - 1;
+
+        /* all its lines have to be older than the hot ones */
+        if ((newest >= start) && (newest <= last))
+          return;
+        if ((newest + ty->backsize - last) % ty->backsize <= BACKLOG_HOT_LINES)
+          return;
+        if (!_backlog_block_compress(ty, start))
+          return;
+        ty->compress_next = last + 1;
+        if (ty->compress_next + TERMPTY_SAVE_BLOCK_LINES > ty->backsize)
+          ty->compress_next = 0;
+     }
 }
 
-Termsave *
-termpty_save_extract(Termsave *ts)
+/* To call once a line is added to the backlog and backpos moved past it:
+ * counts it, compresses the blocks of lines that went cold, compacts the
+ * arena if lines left it too fragmented, and keeps all the backlogs within
+ * their budget */
+void
+termpty_backlog_line_added(Termpty *ty)
 {
-   if (!ts) return NULL;
-   return ts;
+   if (ty->backlog_index.lines + 1 < ty->backsize)
+     ty->backlog_index.lines++;
+   if (ty->arena_wait)
+     ty->arena_wait--;
+   else
+     _arena_compact(ty);
+   if (ty->config)
+     _backlog_budget_enforce(ty->config);
+   _backlog_cold_compress(ty);
 }
 
 Termsave *
@@ -60,11 +1382,14 @@ termpty_save_new(Termpty *ty, Termsave *ts, int w)
 {
    termpty_save_free(ty, ts);
 
-   Termcell *cells = calloc(1, w * sizeof(Termcell));
+   Termcell *cells = _cells_new(ty, w);
    if (!cells ) return NULL;
+   memset(cells, 0, w * sizeof(Termcell));
    ts->cells = cells;
    ts->w = w;
-   _accounting_change(w * sizeof(Termcell));
+   ts->flags = 0;
+   _ts_count(0, 1, 0);
+   _index_update(ty, ts);
    return ts;
 }
 
@@ -73,48 +1398,164 @@ termpty_save_expand(Termpty *ty, Termsave *ts, Termcell *cells, size_t delta)
 {
    Termcell *newcells;
 
-   newcells = realloc(ts->cells, (ts->w + delta) * sizeof(Termcell));
+   newcells = _cells_resize(ty, ts->cells, ts->w, ts->w + delta);
    if (!newcells)
      return NULL;
 
    memset(newcells + ts->w,
           0, delta * sizeof(Termcell));
-   TERMPTY_CELL_COPY(ty, cells, &newcells[ts->w], (int)delta);
+   /* without cells, the new ones are left blank for the caller to fill */
+   if (cells)
+     {
+        TERMPTY_CELL_COPY(ty, cells, &newcells[ts->w], (int)delta);
+        ts->flags |= termpty_rows_flags(ty, cells, delta);
+     }
 
-   _accounting_change((-1) * (int64_t)(ts->w * sizeof(Termcell)));
    ts->w += delta;
-   _accounting_change(ts->w * sizeof(Termcell));
    ts->cells = newcells;
+   _index_update(ty, ts);
    return ts;
 }
 
 void
 termpty_save_free(Termpty *ty, Termsave *ts)
 {
+   Termcell *cells;
    unsigned int i;
-   if (!ts) return;
-   if (ts->comp) ts_comp--;
-   else ts_uncomp--;
-   ts_freeops++;
-   for (i = 0; i < ts->w; i++)
+
+   if (!ts || !ts->cells) return;
+   if (ts->comp) _ts_count(-1, 0, 1);
+   else _ts_count(0, -1, 1);
+   if (ts->flags & TERMPTY_ROW_LINKS)
+     {
+        cells = termpty_save_cells_get(ty, ts);
+        for (i = 0; cells && i < ts->w; i++)
+          {
+             uint16_t link_id = TERMPTY_CELL_ATT(ty, &cells[i])->link_id;
+
+             if (EINA_UNLIKELY(link_id))
+               term_link_refcount_dec(ty, link_id, 1);
+          }
+     }
+   if (ts->comp)
      {
-        if (EINA_UNLIKELY(ts->cells[i].att.link_id))
-          term_link_refcount_dec(ty, ts->cells[i].att.link_id, 1);
+        if (--ts->block->lines == 0)
+          _block_free(ty, ts->block);
+        ts->comp = 0;
+        ts->line = 0;
      }
-   free(ts->cells);
+   else
+     _cells_free(ty, ts->cells, ts->w);
    ts->cells = NULL;
-   _accounting_change((-1) * (int64_t)(ts->w * sizeof(Termcell)));
    ts->w = 0;
+   ts->flags = 0;
+   _index_update(ty, ts);
+}
+
+void
+termpty_backlog_init(void)
+{
+   if (_backlog_locks_ready)
+     return;
+   if (!eina_lock_new(&_ptys_lock))
+     return;
+   if (!eina_lock_new(&_accounting_lock))
+     {
+        eina_lock_free(&_ptys_lock);
+        return;
+     }
+   _backlog_locks_ready = EINA_TRUE;
+}
+
+void
+termpty_backlog_shutdown(void)
+{
+   if (!_backlog_locks_ready)
+     return;
+   eina_lock_free(&_ptys_lock);
+   eina_lock_free(&_accounting_lock);
+   _backlog_locks_ready = EINA_FALSE;
+}
+
+/* The screens and the backlog of @ty are only used with its lock held,
+ * by the main loop and by its reader thread, see _reader_start() in
+ * termpty.c. The lock is recursive */
+Eina_Bool
+termpty_backlog_lock_new(Termpty *ty)
+{
+   ty->lock.ready = eina_lock_recursive_new(&ty->lock.lock);
+   return ty->lock.ready;
+}
+
+void
+termpty_backlog_lock_free(Termpty *ty)
+{
+   if (!ty->lock.ready)
+     return;
+   eina_lock_free(&ty->lock.lock);
+   ty->lock.ready = EINA_FALSE;
+}
+
+void
+termpty_backlog_lock(Termpty *ty)
+{
+   if (!ty->lock.ready)
+     return;
+   eina_lock_take(&ty->lock.lock);
+   ty->lock.depth++;
 }
 
 void
-termpty_backlog_lock(void)
+termpty_backlog_unlock(Termpty *ty)
+{
+   if (!ty->lock.ready)
+     return;
+   ty->lock.depth--;
+   eina_lock_release(&ty->lock.lock);
+}
+
+/* Release the lock of @ty, held by the caller, as many times as it was
+ * taken. Returns that count, for termpty_backlog_relock() */
+int
+termpty_backlog_unlock_all(Termpty *ty)
 {
+   int depth = ty->lock.depth;
+   int i;
+
+   for (i = 0; i < depth; i++)
+     termpty_backlog_unlock(ty);
+   return depth;
 }
 
 void
-termpty_backlog_unlock(void)
+termpty_backlog_relock(Termpty *ty, int depth)
+{
+   int i;
+
+   for (i = 0; i < depth; i++)
+     termpty_backlog_lock(ty);
+}
+
+/* Only the rings on the heap count, those mapped are the kernel's to keep
+ * in memory or not */
+static int64_t
+_ring_memory(const Termpty *ty)
 {
+   if (!ty->back || ty->back_mapped)
+     return 0;
+   return ty->backsize * sizeof(Termsave);
+}
+
+static void
+_ring_free(Termpty *ty)
+{
+   _accounting_fixed_change((-1) * _ring_memory(ty));
+   if (ty->back_mapped)
+     munmap(ty->back, ty->backsize * sizeof(Termsave));
+   else
+     free(ty->back);
+   ty->back = NULL;
+   ty->back_mapped = EINA_FALSE;
 }
 
 void
@@ -125,11 +1566,37 @@ termpty_backlog_free(Termpty *ty)
    if (!ty || !ty->back)
      return;
 
+   _index_free(ty);
    for (i = 0; i < ty->backsize; i++)
-     termpty_save_free(ty, &ty->back[i]);
-   _accounting_change((-1) * (int64_t)(sizeof(Termsave) * ty->backsize));
-   free(ty->back);
-   ty->back = NULL;
+     {
+        Termsave *ts = &ty->back[i];
+
+        /* the arena goes at once, with the cells of the lines there */
+        if (ts->comp || (ts->flags & TERMPTY_ROW_LINKS)
+            || _arena_class(ts->w) < 0)
+          termpty_save_free(ty, ts);
+        else if (ts->cells)
+          {
+             _ts_count(0, -1, 0);
+             memset(ts, 0, sizeof(Termsave));
+          }
+     }
+   _arena_release(ty);
+   if (ty->spill)
+     {
+        _spill_free(ty->spill);
+        ty->spill = NULL;
+     }
+   for (i = 0; i < TERMPTY_CACHE_SIZE; i++)
+     {
+        Termcache *entry = &ty->cache.entries[i];
+
+        _accounting_fixed_change((-1) * (int64_t)(entry->size
+                                                  * sizeof(Termcell)));
+        free(entry->cells);
+        memset(entry, 0, sizeof(*entry));
+     }
+   _ring_free(ty);
 }
 
 void
@@ -140,87 +1607,688 @@ termpty_clear_backlog(Termpty *ty)
    ty->backlog_beacon.screen_y = 0;
    ty->backlog_beacon.backlog_y = 0;
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(ty);
    termpty_backlog_free(ty);
    ty->backpos = 0;
    backsize = ty->backsize;
    ty->backsize = 0;
    termpty_backlog_size_set(ty, backsize);
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(ty);
 }
 
 ssize_t
 termpty_backlog_length(Termpty *ty)
 {
-   int backlog_y = ty->backlog_beacon.backlog_y;
-   int screen_y = ty->backlog_beacon.screen_y;
+   size_t lines;
 
    if (!ty->backsize)
      return 0;
 
-   for (backlog_y++; backlog_y < (int)ty->backsize; backlog_y++)
+   lines = termpty_backlog_lines_get(ty);
+   if (lines > (size_t)ty->backlog_beacon.backlog_y)
      {
-        int nb_lines;
-        const Termsave *ts;
+        ty->backlog_beacon.backlog_y = lines;
+        ty->backlog_beacon.screen_y = termpty_backlog_rows_get(ty, lines);
+     }
+   return ty->backlog_beacon.screen_y;
+}
 
-        ts = BACKLOG_ROW_GET(ty, backlog_y);
-        if (!ts->cells)
-          goto end;
+/* To call once the newest line is removed and backpos moved back on it */
+void
+termpty_backlog_line_removed(Termpty *ty)
+{
+   Backlog_Index *index = &ty->backlog_index;
+
+   if (index->lines == 0)
+     return;
+   /* the slot before the oldest line shows up, if a ring full of lines */
+   if ((index->lines + 1 < ty->backsize)
+       || !BACKLOG_ROW_GET(ty, ty->backsize - 1)->cells)
+     index->lines--;
+}
+
+/* Number of lines in the backlog, the ones from the newest one up to the
+ * first empty slot */
+size_t
+termpty_backlog_lines_get(Termpty *ty)
+{
+   if (!_index_ready(ty))
+     return 0;
+   return ty->backlog_index.lines;
+}
+
+/* Visual rows taken by the @y newest lines of the backlog */
+int
+termpty_backlog_rows_get(Termpty *ty, size_t y)
+{
+   const int *rows;
+   size_t n = ty->backsize;
+   ssize_t newest;
+   int sum;
+
+   if ((y == 0) || !_index_ready(ty))
+     return 0;
+   rows = ty->backlog_index.rows;
+   newest = (ty->backpos + n - 2) % n;
+   if (y <= (size_t)newest + 1)
+     return _index_prefix(rows, newest) - _index_prefix(rows, newest - y);
+   /* the ring wraps */
+   sum = _index_prefix(rows, newest) + _index_prefix(rows, n - 1);
+   return sum - _index_prefix(rows, n - 1 - (y - newest - 1));
+}
+
+/* Line of the backlog where the visual row @row, counted from 1 upward from
+ * the top of the screen, is; or 0 if none */
+size_t
+termpty_backlog_line_find(Termpty *ty, int row)
+{
+   const int *rows;
+   size_t n = ty->backsize, y, lines;
+   ssize_t newest;
+   int sum;
+
+   lines = termpty_backlog_lines_get(ty);
+   if ((row <= 0) || (lines == 0)
+       || (row > termpty_backlog_rows_get(ty, lines)))
+     return 0;
+   rows = ty->backlog_index.rows;
+   newest = (ty->backpos + n - 2) % n;
+   sum = _index_prefix(rows, newest);
+   /* the lines sit at decreasing slots, the last slot whose prefix is
+    * low enough is just below the one wanted */
+   if (row <= sum)
+     y = newest - (_index_lower_bound(rows, n, sum - row + 1) - 1);
+   else
+     {
+        int total = _index_prefix(rows, n - 1);
 
-        nb_lines = (ts->w == 0) ? 1 : DIV_ROUND_UP(ts->w, ty->w);
-        screen_y += nb_lines;
-        ty->backlog_beacon.screen_y = screen_y;
-        ty->backlog_beacon.backlog_y = backlog_y;
+        y = newest + 1 + n - 1
+           - (_index_lower_bound(rows, n, total - (row - sum) + 1) - 1);
      }
-end:
-     return ty->backlog_beacon.screen_y;
+   return y;
 }
 
 
 void
 termpty_backlog_size_set(Termpty *ty, size_t size)
 {
-   Termsave *new_back;
+   Termsave *new_back = NULL;
+   Eina_Bool mapped = EINA_FALSE;
    size_t i;
 
    if (ty->backsize == size)
      return;
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(ty);
 
+   _index_free(ty);
    if (size == 0)
      {
         termpty_backlog_free(ty);
         goto end;
      }
-   if (size > ty->backsize)
+   if (ty->config && (ty->config->scrollback_spill > 0))
+     new_back = _spill_ring_new(size);
+   if (new_back)
+     mapped = EINA_TRUE;
+   else if ((size > ty->backsize) && (!ty->back_mapped))
      {
         new_back = realloc(ty->back, sizeof(Termsave) * size);
         if (!new_back)
-          return;
+          {
+             termpty_backlog_unlock(ty);
+             return;
+          }
         memset(new_back + ty->backsize, 0,
                sizeof(Termsave) * (size - ty->backsize));
+        _accounting_fixed_change((size - ty->backsize)
+                                 * (int64_t)sizeof(Termsave));
         ty->back = new_back;
      }
    else
      {
         new_back = calloc(1, sizeof(Termsave) * size);
         if (!new_back)
-          return;
-        for (i = 0; i < size; i++)
+          {
+             termpty_backlog_unlock(ty);
+             return;
+          }
+     }
+   if (new_back != ty->back)
+     {
+        for (i = 0; (i < size) && (i < ty->backsize); i++)
           new_back[i] = ty->back[i];
         for (i = size; i < ty->backsize; i++)
           termpty_save_free(ty, &ty->back[i]);
-        free(ty->back);
+        _ring_free(ty);
         ty->back = new_back;
+        ty->back_mapped = mapped;
+        if (!mapped)
+          _accounting_fixed_change(size * (int64_t)sizeof(Termsave));
      }
-   _accounting_change((size - ty->backsize) * (int64_t)sizeof(Termsave));
 end:
    ty->backpos = 0;
    ty->backsize = size;
+   ty->compress_next = 0;
    /* Reset beacon */
    ty->backlog_beacon.screen_y = 0;
    ty->backlog_beacon.backlog_y = 0;
 
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(ty);
+}
+
+#if defined(BINARY_TYTEST)
+/* A terminal of one row of @w cells, with room for @backsize lines */
+static void
+_tytest_backlog_setup(Termpty *ty, Config *config, int w, int backsize)
+{
+   memset(ty, 0, sizeof(Termpty));
+   ty->config = config;
+   assert(termpty_atts_init(ty));
+   ty->w = w;
+   ty->h = 1;
+   ty->screen = calloc(ty->w * ty->h, sizeof(Termcell));
+   assert(ty->screen);
+   termpty_backlog_size_set(ty, backsize);
+   termpty_save_register(ty);
+}
+
+static void
+_tytest_backlog_teardown(Termpty *ty)
+{
+   termpty_save_unregister(ty);
+   termpty_backlog_free(ty);
+   assert(!ty->spill);
+   free(ty->screen);
+   termpty_atts_shutdown(ty);
+}
+
+/* Saves @n lines of 1 to 8 cells with different attributes */
+static void
+_tytest_backlog_fill(Termpty *ty, int n)
+{
+   Termatt att;
+   int i;
+
+   memset(&att, 0, sizeof(att));
+   for (i = 0; i < n; i++)
+     {
+        att.fg = i % 8;
+        termpty_cell_codepoint_att_fill(ty, 'a' + i % 26, att,
+                                        ty->screen, 1 + i % ty->w);
+        termpty_text_save_top(ty, ty->screen, ty->w);
+        termpty_cell_fill(ty, NULL, ty->screen, ty->w);
+     }
+}
+
+/* The lines saved by _tytest_backlog_fill() are all there, the slot the
+ * next line goes to excepted */
+static void
+_tytest_backlog_check(Termpty *ty, int n)
+{
+   Termcell *cells;
+   Termatt att;
+   ssize_t w;
+   int i, x;
+
+   for (i = 0; i < n - 1; i++)
+     {
+        int line = n - 1 - i;
+
+        cells = termpty_cellrow_get(ty, -1 - i, &w);
+        assert(cells && w == 1 + line % ty->w);
+        for (x = 0; x < w; x++)
+          {
+             termpty_cell_att_get(ty, &cells[x], &att);
+             assert(cells[x].codepoint == (Eina_Unicode)('a' + line % 26));
+             assert(att.fg == line % 8);
+          }
+     }
+}
+
+/* The newest lines stay hot, line after line, the ring going round */
+static void
+_tytest_backlog_compress_hot(Termpty *ty, Config *config EINA_UNUSED)
+{
+   size_t i, j, newest;
+
+   for (i = 0; i < 2 * ty->backsize; i++)
+     {
+        _tytest_backlog_fill(ty, 1);
+        newest = BACKLOG_ROW_GET(ty, 1) - ty->back;
+        for (j = 0; j < ty->backsize; j++)
+          {
+             if (ty->back[j].comp)
+               assert((newest + ty->backsize - j) % ty->backsize
+                      > BACKLOG_HOT_LINES);
+          }
+     }
+}
+
+/* Compressing for the budget leaves the block of the newest line alone,
+ * wherever the ring stands */
+static void
+_tytest_backlog_compress_budget(Termpty *ty, Config *config EINA_UNUSED)
+{
+   size_t i;
+
+   for (i = 0; i < 2 * ty->backsize; i++)
+     {
+        _tytest_backlog_fill(ty, 1);
+        _budget_compress(ty, 0);
+        assert(!BACKLOG_ROW_GET(ty, 1)->comp);
+     }
+}
+
+/* Saves @n lines of the width of @ty, hardly compressible */
+static void
+_tytest_backlog_noise_fill(Termpty *ty, int n, uint32_t *seed)
+{
+   int i, x;
+
+   for (i = 0; i < n; i++)
+     {
+        for (x = 0; x < ty->w; x++)
+          {
+             *seed = *seed * 1103515245 + 12345;
+             ty->screen[x].codepoint = 0x4e00 + (*seed >> 16) % 0x5000;
+          }
+        termpty_text_save_top(ty, ty->screen, ty->w);
+     }
+}
+
+static void
+_tytest_backlog_compress(Termpty *ty, Config *config EINA_UNUSED)
+{
+   Termsave *ts;
+   int n = ty->backsize;
+   int i, comp = 0;
+
+   _tytest_backlog_fill(ty, n);
+
+   /* only whole blocks of lines older than the hot ones */
+   for (i = 0; i < n; i++)
+     comp += ty->back[i].comp;
+   assert(comp == 2 * TERMPTY_SAVE_BLOCK_LINES);
+   assert(ty->back[0].comp && ty->back[0].block->natts == 8);
+   assert(ty->back[0].block->nclusters == 0);
+   assert(!ty->spill);
+
+   /* still the same lines, whichever block they went to */
+   _tytest_backlog_check(ty, n);
+
+   /* a line can get its own cells back */
+   ts = termpty_save_extract(ty, &ty->back[1]);
+   assert(ts && !ts->comp && ts->w == 1 + 2 % ty->w);
+   assert(ts->cells[0].codepoint == 'c');
+   assert(ty->back[0].block->lines == TERMPTY_SAVE_BLOCK_LINES - 1);
+}
+
+/* Blocks that went cold while no line was counted are compressed with the
+ * next one */
+static void
+_tytest_backlog_compress_late(Termpty *ty, Config *config EINA_UNUSED)
+{
+   size_t i;
+   int comp = 0;
+
+   for (i = 0; i < ty->backsize - 1; i++)
+     {
+        Termsave *ts = termpty_save_new(ty, &ty->back[i], 1);
+
+        assert(ts);
+        ts->cells[0].codepoint = 'a';
+     }
+   ty->backpos = ty->backsize - 1;
+   _tytest_backlog_fill(ty, 1);
+   for (i = 0; i < ty->backsize; i++)
+     comp += ty->back[i].comp;
+   assert(comp == 2 * TERMPTY_SAVE_BLOCK_LINES);
+   assert(ty->compress_next == 2 * TERMPTY_SAVE_BLOCK_LINES);
+}
+
+static void
+_tytest_backlog_spill(Termpty *ty, Config *config)
+{
+   char dir[] = "/tmp/tytest-spill-XXXXXX";
+   int i, n = ty->backsize;
+   int64_t fixed = _mem_fixed;
+   struct stat st;
+
+   assert(mkdtemp(dir));
+   assert(setenv("XDG_RUNTIME_DIR", dir, 1) == 0);
+   config->scrollback_spill = 1;
+
+   /* the ring goes to a file too, out of the memory counted, growing with
+    * its lines */
+   termpty_backlog_size_set(ty, 0);
+   termpty_backlog_size_set(ty, n / 2);
+   assert(ty->back_mapped);
+   _tytest_backlog_fill(ty, 1);
+   termpty_backlog_size_set(ty, n);
+   assert(ty->back_mapped && ty->back[n / 2 - 1].cells);
+   assert(_mem_fixed == fixed - (int64_t)(n * sizeof(Termsave)));
+
+   /* every block goes to the file, which is nowhere to be found */
+   _tytest_backlog_fill(ty, n);
+   assert(ty->spill && ty->spill->fd >= 0 && !ty->spill->failed);
+   assert(ty->spill->mem == 0 && !ty->spill->first);
+   assert(!ty->back[0].block->data);
+   assert(ty->spill->used == ty->spill->size);
+   assert(fstat(ty->spill->fd, &st) == 0 && st.st_nlink == 0);
+   assert(rmdir(dir) == 0);
+   _tytest_backlog_check(ty, n);
+
+   /* the oldest blocks leave the file with their lines */
+   _tytest_backlog_fill(ty, 2 * TERMPTY_SAVE_BLOCK_LINES);
+   assert(ty->spill->used < ty->spill->size);
+
+   /* and the new ones fill the holes they left */
+   for (i = 0; i < 20; i++)
+     {
+        _tytest_backlog_fill(ty, n);
+        assert(ty->spill->size < 2 * ty->spill->used);
+     }
+
+   unsetenv("XDG_RUNTIME_DIR");
+}
+
+static void
+_tytest_backlog_arena(Termpty *ty, Config *config EINA_UNUSED)
+{
+   Termarena *arena;
+   int cls = _arena_class(64), n = ty->backsize;
+   unsigned int slots = _arena_slots(cls), nchunks;
+   Termsave *ts;
+   int i, x;
+
+   /* not enough lines to compress any */
+   assert(n < BACKLOG_HOT_LINES + 2 * TERMPTY_SAVE_BLOCK_LINES);
+   arena = &ty->arena[cls];
+
+   for (i = 0; i < n; i++)
+     {
+        ts = termpty_save_new(ty, &ty->back[i], 64);
+        assert(ts);
+        for (x = 0; x < 64; x++)
+          ts->cells[x].codepoint = i;
+     }
+   nchunks = arena->nchunks;
+   assert(nchunks == DIV_ROUND_UP(n, slots));
+   assert(arena->used == (unsigned int)n);
+
+   /* lines growing change of class, lines freed give their slots back */
+   ts = termpty_save_expand(ty, &ty->back[0], ty->screen, 64);
+   assert(ts && ts->w == 128 && ts->cells[63].codepoint == 0);
+   assert(ty->arena[_arena_class(128)].used == 1);
+   for (i = 1; i < n; i += 2)
+     termpty_save_free(ty, &ty->back[i]);
+   assert(arena->nchunks == nchunks && arena->used == (unsigned int)n / 2 - 1);
+   ts = termpty_save_new(ty, &ty->back[1], 50);
+   assert(ts && arena->nchunks == nchunks);
+
+   /* half of the slots are free: the lines move together */
+   _arena_compact(ty);
+   assert(arena->nchunks == DIV_ROUND_UP(arena->used, slots));
+   assert(!_arena_fragmented(arena, cls));
+   for (i = 2; i < n; i += 2)
+     {
+        ts = &ty->back[i];
+        assert(ts->w == 64);
+        for (x = 0; x < 64; x++)
+          assert(ts->cells[x].codepoint == (Eina_Unicode)i);
+     }
+
+   /* then not before part of the backlog was saved again */
+   for (i = 2; i < n; i += 4)
+     termpty_save_free(ty, &ty->back[i]);
+   assert(_arena_fragmented(arena, cls));
+   nchunks = arena->nchunks;
+   for (i = 0; i < n / ARENA_COMPACT_WAIT; i++)
+     termpty_backlog_line_added(ty);
+   assert(arena->nchunks == nchunks);
+   termpty_backlog_line_added(ty);
+   assert(arena->nchunks < nchunks);
+
+   /* clearing the backlog releases the chunks at once */
+   termpty_clear_backlog(ty);
+   for (cls = 0; cls < TERMPTY_ARENA_CLASSES; cls++)
+     assert(!ty->arena[cls].first && !ty->arena[cls].nchunks);
+}
+
+static void
+_tytest_backlog_budget(Termpty *ty, Config *config)
+{
+   Termpty other;
+   int64_t budget;
+   uint32_t seed = 42;
+   int i, n = ty->backsize;
+
+   /* the rings of lines do not count */
+   budget = 2 * 1024 * 1024 + termpty_backlog_memory_get() - _mem_fixed;
+   _tytest_backlog_setup(&other, config, ty->w, n);
+
+   /* without a budget, the other terminal takes what it needs */
+   _tytest_backlog_noise_fill(&other, n, &seed);
+   assert(termpty_backlog_memory_get() - _mem_fixed > budget);
+   assert(termpty_backlog_memory_peak_get() >= termpty_backlog_memory_get());
+   other.selection.start.x = 3;
+   other.selection.start.y = -termpty_backlog_length(&other);
+   other.selection.end.y = -1;
+
+   /* this one, shown last, gets the memory of the other one */
+   termpty_backlog_viewed(&other);
+   termpty_backlog_viewed(ty);
+   config->scrollback_budget = 2;
+   for (i = 0; i < n; i++)
+     {
+        _tytest_backlog_noise_fill(ty, 1, &seed);
+        assert(termpty_backlog_memory_get() - _mem_fixed <= budget);
+     }
+   assert(termpty_backlog_length(&other) < n / 4);
+   /* its selection only goes over the lines left */
+   assert(other.selection.start.y == -termpty_backlog_length(&other));
+   assert(other.selection.start.x == 0 && other.selection.end.y == -1);
+   assert(termpty_backlog_length(ty) > n / 2);
+   /* its newest line included */
+   assert(ty->back[n - 2].cells);
+   assert(termpty_backlog_memory_peak_get() > budget);
+
+   _tytest_backlog_teardown(&other);
+}
+
+/* A budget smaller than what the rings of lines take alone does not get
+ * every line dropped */
+static void
+_tytest_backlog_budget_rings(Termpty *ty, Config *config)
+{
+   assert(_mem_fixed > 1024 * 1024);
+   config->scrollback_budget = 1;
+   _tytest_backlog_fill(ty, 2000);
+   _tytest_backlog_check(ty, 2000);
+}
+
+/* Row @row of the backlog, found line by line */
+static Termcell *
+_tytest_backlog_row_walk(Termpty *ty, int row, ssize_t *wret)
+{
+   int screen_y = 0;
+   size_t y;
+
+   for (y = 1; y < ty->backsize; y++)
+     {
+        Termsave *ts = BACKLOG_ROW_GET(ty, y);
+        int delta;
+
+        if (!ts->cells)
+          return NULL;
+        screen_y += (ts->w == 0) ? 1 : DIV_ROUND_UP(ts->w, ty->w);
+        if (row > screen_y)
+          continue;
+        delta = screen_y - row;
+        *wret = MIN(ts->w - delta * ty->w, ty->w);
+        return &ts->cells[delta * ty->w];
+     }
+   return NULL;
+}
+
+static void
+_tytest_backlog_index_check(Termpty *ty)
+{
+   Termcell *cells, *expected;
+   ssize_t w, w_expected;
+   int row, scroll, total = 0;
+
+   for (row = 1; ; row++)
+     {
+        expected = _tytest_backlog_row_walk(ty, row, &w_expected);
+        cells = termpty_cellrow_get(ty, -row, &w);
+        assert(cells == expected);
+        if (!cells)
+          break;
+        assert(w == w_expected);
+        total = row;
+     }
+   /* back down, from the beacon */
+   for (row = total; row > 0; row -= 3)
+     {
+        expected = _tytest_backlog_row_walk(ty, row, &w_expected);
+        assert(termpty_cellrow_get(ty, -row, &w) == expected);
+     }
+   assert(termpty_backlog_length(ty) == total);
+   scroll = total + 5;
+   termpty_backscroll_adjust(ty, &scroll);
+   assert(scroll == total);
+}
+
+static void
+_tytest_backlog_index(Termpty *ty, Config *config EINA_UNUSED)
+{
+   uint32_t seed = 7;
+   int i, x;
+
+   /* lines of any length, some spanning several rows */
+   for (i = 0; i < 150; i++)
+     {
+        int len;
+
+        seed = seed * 1103515245 + 12345;
+        len = (seed >> 16) % (ty->w + 1);
+        termpty_cell_fill(ty, NULL, ty->screen, ty->w);
+        for (x = 0; x < len; x++)
+          ty->screen[x].codepoint = 'a' + i % 26;
+        if ((len == ty->w) && ((seed >> 8) & 1))
+          ty->screen[ty->w - 1].autowrapped = 1;
+        termpty_text_save_top(ty, ty->screen, ty->w);
+     }
+   _tytest_backlog_index_check(ty);
+
+   /* the ring wraps */
+   for (; i < 600; i++)
+     {
+        seed = seed * 1103515245 + 12345;
+        termpty_cell_fill(ty, NULL, ty->screen, ty->w);
+        for (x = 0; x < ty->w; x++)
+          ty->screen[x].codepoint = 'a' + i % 26;
+        ty->screen[ty->w - 1].autowrapped = (seed >> 16) % 3 == 0;
+        termpty_text_save_top(ty, ty->screen, ty->w);
+        if (i % 97 == 0)
+          _tytest_backlog_index_check(ty);
+     }
+   _tytest_backlog_index_check(ty);
+
+   /* other width, other rows */
+   ty->w = 7;
+   _tytest_backlog_index_check(ty);
+   ty->w = 10;
+
+   /* the newest line goes */
+   ty->backpos = (ty->backpos + ty->backsize - 1) % ty->backsize;
+   termpty_save_free(ty, &ty->back[(ty->backsize - 1 + ty->backpos)
+                                   % ty->backsize]);
+   termpty_backlog_line_removed(ty);
+   ty->backlog_beacon.screen_y = 0;
+   ty->backlog_beacon.backlog_y = 0;
+   _tytest_backlog_index_check(ty);
+}
+
+static void
+_tytest_backlog_long_line(Termpty *ty, Config *config EINA_UNUSED)
+{
+   Termsave *ts = NULL;
+   Termcell *cells = NULL;
+   int i, moves = 0, rows = TERMPTY_SAVE_W_MAX / ty->w;
+
+   /* one row after the other, the line is seldom moved */
+   for (i = 0; i < rows; i++)
+     {
+        termpty_cell_fill(ty, NULL, ty->screen, ty->w);
+        ty->screen[0].codepoint = i;
+        ty->screen[ty->w - 1].codepoint = 'x';
+        ty->screen[ty->w - 1].autowrapped = 1;
+        termpty_text_save_top(ty, ty->screen, ty->w);
+        ts = &ty->back[(ty->backsize - 2 + ty->backpos) % ty->backsize];
+        if (ts->cells != cells)
+          moves++;
+        cells = ts->cells;
+     }
+   assert(ts->w == (unsigned int)rows * ty->w);
+   assert(moves < 32);
+   for (i = 0; i < rows; i++)
+     assert(cells[i * ty->w].codepoint == (Eina_Unicode)i);
+   assert(termpty_backlog_length(ty) == rows);
+
+   /* up to the longest line there can be */
+   termpty_text_save_top(ty, ty->screen, ty->w);
+   assert(ty->back[(ty->backsize - 2 + ty->backpos) % ty->backsize].w
+          == (unsigned int)ty->w);
+   assert(ty->back[(ty->backsize - 3 + ty->backpos) % ty->backsize].w
+          == (unsigned int)rows * ty->w);
+}
+
+static const struct {
+   int w, backsize;
+   void (*run)(Termpty *ty, Config *config);
+} _tytest_backlog_cases[] = {
+   { 8, BACKLOG_HOT_LINES + 3 * TERMPTY_SAVE_BLOCK_LINES,
+     _tytest_backlog_compress },
+   { 8, BACKLOG_HOT_LINES + 3 * TERMPTY_SAVE_BLOCK_LINES,
+     _tytest_backlog_compress_late },
+   { 8, BACKLOG_HOT_LINES + 3 * TERMPTY_SAVE_BLOCK_LINES,
+     _tytest_backlog_compress_hot },
+   { 8, 3 * TERMPTY_SAVE_BLOCK_LINES, _tytest_backlog_compress_budget },
+   { 8, BACKLOG_HOT_LINES + 5 * TERMPTY_SAVE_BLOCK_LINES,
+     _tytest_backlog_spill },
+   { 64, 1100, _tytest_backlog_arena },
+   { 128, 4000, _tytest_backlog_budget },
+   { 8, 100000, _tytest_backlog_budget_rings },
+   { 10, 200, _tytest_backlog_index },
+   { 1000, 10, _tytest_backlog_long_line },
+};
+
+/* Every case gets a terminal of its own, and has to give all the memory of
+ * the backlog back */
+int
+tytest_backlog(void)
+{
+   int64_t mem = termpty_backlog_memory_get();
+   unsigned int i, n;
+
+   n = sizeof(_tytest_backlog_cases) / sizeof(_tytest_backlog_cases[0]);
+   for (i = 0; i < n; i++)
+     {
+        Termpty ty;
+        Config config;
+
+        memset(&config, 0, sizeof(config));
+        _tytest_backlog_setup(&ty, &config, _tytest_backlog_cases[i].w,
+                              _tytest_backlog_cases[i].backsize);
+        _tytest_backlog_cases[i].run(&ty, &config);
+        _tytest_backlog_teardown(&ty);
+        /* along with the blocks decompressed last */
+        termpty_backlog_shutdown();
+        assert(termpty_backlog_memory_get() == mem);
+     }
+   return 0;
 }
+#endif
@@ -1,16 +1,26 @@
 #ifndef TERMINOLOGY_BACKLOG_H_ 
 #define TERMINOLOGY_BACKLOG_H_ 1
 
+/* Lines of the backlog kept uncompressed, the most recent ones */
+#define BACKLOG_HOT_LINES 1024
+
 void termpty_save_register(Termpty *ty);
 void termpty_save_unregister(Termpty *ty);
-Termsave *termpty_save_extract(Termsave *ts);
+Termsave *termpty_save_extract(Termpty *ty, Termsave *ts);
+Termcell *termpty_save_cells_get(Termpty *ty, Termsave *ts);
 Termsave *termpty_save_new(Termpty *ty, Termsave *ts, int w);
 void termpty_save_free(Termpty *ty, Termsave *ts);
 Termsave *termpty_save_expand(Termpty *ty, Termsave *ts,
                               Termcell *cells, size_t delta);
 
-void       termpty_backlog_lock(void);
-void       termpty_backlog_unlock(void);
+void       termpty_backlog_init(void);
+void       termpty_backlog_shutdown(void);
+Eina_Bool  termpty_backlog_lock_new(Termpty *ty);
+void       termpty_backlog_lock_free(Termpty *ty);
+void       termpty_backlog_lock(Termpty *ty);
+void       termpty_backlog_unlock(Termpty *ty);
+int        termpty_backlog_unlock_all(Termpty *ty);
+void       termpty_backlog_relock(Termpty *ty, int depth);
 
 void
 termpty_clear_backlog(Termpty *ty);
@@ -18,11 +28,26 @@ void
 termpty_backlog_free(Termpty *ty);
 void
 termpty_backlog_size_set(Termpty *ty, size_t size);
+void
+termpty_backlog_line_added(Termpty *ty);
+void
+termpty_backlog_line_removed(Termpty *ty);
 ssize_t
 termpty_backlog_length(Termpty *ty);
+size_t
+termpty_backlog_lines_get(Termpty *ty);
+int
+termpty_backlog_rows_get(Termpty *ty, size_t y);
+size_t
+termpty_backlog_line_find(Termpty *ty, int row);
+
+void
+termpty_backlog_viewed(Termpty *ty);
 
 int64_t
 termpty_backlog_memory_get(void);
+int64_t
+termpty_backlog_memory_peak_get(void);
 
 #define BACKLOG_ROW_GET(Ty, Y) \
    (&Ty->back[(Ty->backsize - 1 + ty->backpos - Y) % Ty->backsize])
@@ -3,6 +3,9 @@
 #include <Elementary.h>
 #include "config.h"
 #include "colors.h"
+#if defined(BINARY_TYTEST)
+#include "unit_tests.h"
+#endif
 
 #define COLORSCHEMES_FILENAME "colorschemes.eet"
 #define COLORSCHEMES_VERSION  1
@@ -602,6 +605,183 @@ colors_256_get(int col,
    *a = default_colors256[col].a;
 }
 
+/* Nearest color in a 256 colors palette
+ *
+ * The RGB cube is cut in LUT_CELLS^3 cells.  Each cell lists the palette
+ * entries that can be the nearest one to a color in that cell: an entry is
+ * kept when its smallest possible distance to the cell is not larger than
+ * the largest possible distance from the cell to the entry closest to it.
+ * Looking a color up is then a scan of the few entries of its cell,
+ * computed the first time that cell is needed.
+ */
+#define LUT_SHIFT 4
+#define LUT_CELLS (256 >> LUT_SHIFT)
+#define LUT_CELL_UNSET 0xffff
+
+struct tag_Color_Lut
+{
+   uint8_t palette[256][3];
+   uint32_t cell_start[LUT_CELLS * LUT_CELLS * LUT_CELLS];
+   uint16_t cell_len[LUT_CELLS * LUT_CELLS * LUT_CELLS];
+   uint8_t *candidates;
+   size_t len, size;
+};
+
+static int
+_color_distance(int r0, int g0, int b0, int r1, int g1, int b1)
+{
+   int delta_red_sq, delta_green_sq, delta_blue_sq, red_mean;
+
+   /* Compute the color distance
+    * XXX: this is inacurate but should give good enough results.
+    * See https://en.wikipedia.org/wiki/Color_difference
+    */
+   red_mean = (r0 + r1) / 2;
+   delta_red_sq = (r0 - r1) * (r0 - r1);
+   delta_green_sq = (g0 - g1) * (g0 - g1);
+   delta_blue_sq = (b0 - b1) * (b0 - b1);
+
+   return 2 * delta_red_sq
+      + 4 * delta_green_sq
+      + 3 * delta_blue_sq
+      + ((red_mean) * (delta_red_sq - delta_blue_sq) / 256);
+}
+
+/* Smallest and largest squared distances from @v to [lo, hi] */
+static void
+_lut_delta_sq(int v, int lo, int hi, int *min, int *max)
+{
+   int d;
+
+   if (v < lo)
+     d = lo - v;
+   else if (v > hi)
+     d = v - hi;
+   else
+     d = 0;
+   *min = d * d;
+   d = MAX(abs(v - lo), abs(v - hi));
+   *max = d * d;
+}
+
+static Eina_Bool
+_lut_cell_build(Color_Lut *lut, int cell, int r, int g, int b)
+{
+   int lower[256];
+   int upper = INT_MAX;
+   int c, n = 0;
+
+   /* The red mean weights red by 2 to 3 and blue by 3 to 2, and rounding
+    * moves the distance by less than 1 */
+   for (c = 0; c < 256; c++)
+     {
+        int rmin, rmax, gmin, gmax, bmin, bmax, u;
+
+        _lut_delta_sq(lut->palette[c][0], r, r + (1 << LUT_SHIFT) - 1,
+                      &rmin, &rmax);
+        _lut_delta_sq(lut->palette[c][1], g, g + (1 << LUT_SHIFT) - 1,
+                      &gmin, &gmax);
+        _lut_delta_sq(lut->palette[c][2], b, b + (1 << LUT_SHIFT) - 1,
+                      &bmin, &bmax);
+        lower[c] = 2 * rmin + 4 * gmin + 2 * bmin - 1;
+        u = 3 * rmax + 4 * gmax + 3 * bmax + 1;
+        if (u < upper)
+          upper = u;
+     }
+
+   if (lut->size - lut->len < 256)
+     {
+        size_t size = lut->size ? lut->size * 2 : 4096;
+        uint8_t *candidates = realloc(lut->candidates, size);
+
+        if (!candidates)
+          return EINA_FALSE;
+        lut->candidates = candidates;
+        lut->size = size;
+     }
+   /* in palette order so that ties resolve as a full scan would */
+   for (c = 0; c < 256; c++)
+     {
+        if (lower[c] <= upper)
+          lut->candidates[lut->len + n++] = c;
+     }
+   lut->cell_start[cell] = lut->len;
+   lut->cell_len[cell] = n;
+   lut->len += n;
+   return EINA_TRUE;
+}
+
+Color_Lut *
+colors_lut_new(const uint8_t palette[256][3])
+{
+   Color_Lut *lut = malloc(sizeof(*lut));
+
+   if (!lut)
+     return NULL;
+   memcpy(lut->palette, palette, sizeof(lut->palette));
+   memset(lut->cell_len, 0xff, sizeof(lut->cell_len));
+   lut->candidates = NULL;
+   lut->len = lut->size = 0;
+   return lut;
+}
+
+void
+colors_lut_free(Color_Lut *lut)
+{
+   if (!lut)
+     return;
+   free(lut->candidates);
+   free(lut);
+}
+
+uint8_t
+colors_lut_nearest(Color_Lut *lut, uint8_t r, uint8_t g, uint8_t b)
+{
+   const uint8_t *candidates;
+   int cell, i, n, distance_min = INT_MAX;
+   uint8_t chosen_color = 0;
+
+   cell = (((r >> LUT_SHIFT) * LUT_CELLS) + (g >> LUT_SHIFT)) * LUT_CELLS
+      + (b >> LUT_SHIFT);
+   if (lut->cell_len[cell] == LUT_CELL_UNSET)
+     {
+        const int mask = ~((1 << LUT_SHIFT) - 1);
+
+        if (!_lut_cell_build(lut, cell, r & mask, g & mask, b & mask))
+          {
+             /* out of memory: scan the whole palette */
+             for (i = 0; i < 256; i++)
+               {
+                  int distance = _color_distance(r, g, b,
+                                                 lut->palette[i][0],
+                                                 lut->palette[i][1],
+                                                 lut->palette[i][2]);
+                  if (distance < distance_min)
+                    {
+                       distance_min = distance;
+                       chosen_color = i;
+                    }
+               }
+             return chosen_color;
+          }
+     }
+
+   candidates = lut->candidates + lut->cell_start[cell];
+   n = lut->cell_len[cell];
+   for (i = 0; i < n; i++)
+     {
+        const uint8_t *p = lut->palette[candidates[i]];
+        int distance = _color_distance(r, g, b, p[0], p[1], p[2]);
+
+        if (distance < distance_min)
+          {
+             distance_min = distance;
+             chosen_color = candidates[i];
+          }
+     }
+   return chosen_color;
+}
+
 void
 color_scheme_apply(Evas_Object *edje,
                    const Color_Scheme *cs)
@@ -1012,3 +1192,86 @@ colors_shutdown(void)
    eet_data_descriptor_free(edd_color);
    edd_color = NULL;
 }
+
+#if defined(BINARY_TYTEST)
+static unsigned int _rand_state = 0x2545f491;
+
+static unsigned int
+_test_rand(void)
+{
+   _rand_state = _rand_state * 1103515245 + 12345;
+   return _rand_state >> 8;
+}
+
+static uint8_t
+_test_nearest(const uint8_t palette[256][3], int r, int g, int b)
+{
+   int c, distance_min = INT_MAX;
+   uint8_t chosen_color = 0;
+
+   for (c = 0; c < 256; c++)
+     {
+        int distance = _color_distance(r, g, b, palette[c][0],
+                                       palette[c][1], palette[c][2]);
+        if (distance < distance_min)
+          {
+             distance_min = distance;
+             chosen_color = c;
+          }
+     }
+   return chosen_color;
+}
+
+int
+tytest_colors_lut(void)
+{
+   uint8_t palette[256][3];
+   int round, c, i;
+
+   for (round = 0; round < 4; round++)
+     {
+        Color_Lut *lut;
+
+        for (c = 0; c < 256; c++)
+          {
+             if (round == 0)
+               {
+                  palette[c][0] = default_colors256[c].r;
+                  palette[c][1] = default_colors256[c].g;
+                  palette[c][2] = default_colors256[c].b;
+               }
+             else
+               {
+                  /* few distinct values make for many ties */
+                  int m = (round == 1) ? 256 : (round == 2) ? 8 : 2;
+
+                  palette[c][0] = (_test_rand() % m) * (255 / (m - 1));
+                  palette[c][1] = (_test_rand() % m) * (255 / (m - 1));
+                  palette[c][2] = (_test_rand() % m) * (255 / (m - 1));
+               }
+          }
+        lut = colors_lut_new(palette);
+        assert(lut);
+        for (i = 0; i < 100000; i++)
+          {
+             unsigned int v = _test_rand();
+             int r = v & 0xff, g = (v >> 8) & 0xff, b = (v >> 16) & 0xff;
+
+             assert(colors_lut_nearest(lut, r, g, b) ==
+                    _test_nearest(palette, r, g, b));
+          }
+        /* corners of the cells */
+        for (i = 0; i < 8 * LUT_CELLS * LUT_CELLS * LUT_CELLS; i++)
+          {
+             int r = ((i & 1) ? 15 : 0) + ((i >> 3) % LUT_CELLS) * 16;
+             int g = ((i & 2) ? 15 : 0) + ((i >> 7) % LUT_CELLS) * 16;
+             int b = ((i & 4) ? 15 : 0) + ((i >> 11) % LUT_CELLS) * 16;
+
+             assert(colors_lut_nearest(lut, r, g, b) ==
+                    _test_nearest(palette, r, g, b));
+          }
+        colors_lut_free(lut);
+     }
+   return 0;
+}
+#endif
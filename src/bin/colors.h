@@ -4,6 +4,7 @@
 #include <Evas.h>
 #include "config.h"
 
+typedef struct tag_Color_Lut Color_Lut;
 
 struct tag_Color_Block
 {
@@ -70,6 +71,12 @@ colors_256_get(int col,
                unsigned char *b,
                unsigned char *a);
 
+Color_Lut *
+colors_lut_new(const uint8_t palette[256][3]);
+void
+colors_lut_free(Color_Lut *lut);
+uint8_t
+colors_lut_nearest(Color_Lut *lut, uint8_t r, uint8_t g, uint8_t b);
 
 void
 color_scheme_apply_from_config(Evas_Object *edje,
@@ -7,7 +7,7 @@
 #include "colors.h"
 #include "theme.h"
 
-#define CONF_VER 27
+#define CONF_VER 33
 #define CONFIG_KEY "config"
 
 #define LIM(v, min, max) {if (v >= max) v = max; else if (v <= min) v = min;}
@@ -201,6 +201,20 @@ config_init(void)
      (edd_base, Config, "hide_cursor", hide_cursor, EET_T_DOUBLE);
    EET_DATA_DESCRIPTOR_ADD_BASIC
      (edd_base, Config, "group_all", group_all, EET_T_UCHAR);
+   EET_DATA_DESCRIPTOR_ADD_BASIC
+     (edd_base, Config, "threaded_pty", threaded_pty, EET_T_UCHAR);
+   EET_DATA_DESCRIPTOR_ADD_BASIC
+     (edd_base, Config, "pty_read_max", pty_read_max, EET_T_INT);
+   EET_DATA_DESCRIPTOR_ADD_BASIC
+     (edd_base, Config, "pty_read_budget", pty_read_budget, EET_T_DOUBLE);
+   EET_DATA_DESCRIPTOR_ADD_BASIC
+     (edd_base, Config, "esc_string_max", esc_string_max, EET_T_INT);
+   EET_DATA_DESCRIPTOR_ADD_BASIC
+     (edd_base, Config, "exact_truecolor", exact_truecolor, EET_T_UCHAR);
+   EET_DATA_DESCRIPTOR_ADD_BASIC
+     (edd_base, Config, "scrollback_spill", scrollback_spill, EET_T_INT);
+   EET_DATA_DESCRIPTOR_ADD_BASIC
+     (edd_base, Config, "scrollback_budget", scrollback_budget, EET_T_INT);
 }
 
 void
@@ -328,6 +342,13 @@ config_sync(const Config *config_src, Config *config)
    config->translucent = config_src->translucent;
    config->opacity = config_src->opacity;
    config->group_all = config_src->group_all;
+   config->threaded_pty = config_src->threaded_pty;
+   config->pty_read_max = config_src->pty_read_max;
+   config->pty_read_budget = config_src->pty_read_budget;
+   config->esc_string_max = config_src->esc_string_max;
+   config->exact_truecolor = config_src->exact_truecolor;
+   config->scrollback_spill = config_src->scrollback_spill;
+   config->scrollback_budget = config_src->scrollback_budget;
 }
 
 static void
@@ -607,6 +628,13 @@ config_new(void)
         _add_default_keys(config);
         config->hide_cursor = 5.0;
         config->group_all = EINA_FALSE;
+        config->threaded_pty = EINA_FALSE;
+        config->pty_read_max = CONFIG_PTY_READ_MAX_DEFAULT;
+        config->pty_read_budget = CONFIG_PTY_READ_BUDGET_DEFAULT;
+        config->esc_string_max = CONFIG_ESC_STRING_MAX_DEFAULT;
+        config->exact_truecolor = EINA_FALSE;
+        config->scrollback_spill = 0;
+        config->scrollback_budget = 0;
         config_compute_color_scheme(config);
      }
    return config;
@@ -784,7 +812,32 @@ config_load(void)
                   config->selection_escapes = EINA_TRUE;
                   EINA_FALLTHROUGH;
                   /*pass through*/
-                case CONF_VER: /* 27 */
+                case 27:
+                  config->threaded_pty = EINA_FALSE;
+                  EINA_FALLTHROUGH;
+                  /*pass through*/
+                case 28:
+                  config->pty_read_max = CONFIG_PTY_READ_MAX_DEFAULT;
+                  config->pty_read_budget = CONFIG_PTY_READ_BUDGET_DEFAULT;
+                  EINA_FALLTHROUGH;
+                  /*pass through*/
+                case 29:
+                  config->esc_string_max = CONFIG_ESC_STRING_MAX_DEFAULT;
+                  EINA_FALLTHROUGH;
+                  /*pass through*/
+                case 30:
+                  config->exact_truecolor = EINA_FALSE;
+                  EINA_FALLTHROUGH;
+                  /*pass through*/
+                case 31:
+                  config->scrollback_spill = 0;
+                  EINA_FALLTHROUGH;
+                  /*pass through*/
+                case 32:
+                  config->scrollback_budget = 0;
+                  EINA_FALLTHROUGH;
+                  /*pass through*/
+                case CONF_VER: /* 33 */
                   config->version = CONF_VER;
                   break;
                 default:
@@ -892,6 +945,13 @@ config_fork(const Config *config)
    CPY(changedir_to_current);
    CPY(emoji_dbl_width);
    CPY(group_all);
+   CPY(threaded_pty);
+   CPY(pty_read_max);
+   CPY(pty_read_budget);
+   CPY(esc_string_max);
+   CPY(exact_truecolor);
+   CPY(scrollback_spill);
+   CPY(scrollback_budget);
 
    EINA_LIST_FOREACH(config->keys, l, key)
      {
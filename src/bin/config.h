@@ -104,6 +104,13 @@ struct tag_Config
    Eina_Bool         changedir_to_current;
    Eina_Bool         emoji_dbl_width;
    Eina_Bool         group_all;
+   Eina_Bool         threaded_pty;
+   int               pty_read_max; /* bytes per read() on the tty */
+   double            pty_read_budget; /* seconds spent reading per wakeup */
+   int               esc_string_max; /* codepoints in an OSC or DCS string */
+   Eina_Bool         exact_truecolor;
+   int               scrollback_spill; /* compressed backlog bytes in memory */
+   int               scrollback_budget; /* MiB of backlog, all terminals */
    Color             colors[(4 * 12)];
    Eina_List        *keys;
 
@@ -126,5 +133,8 @@ const char *config_theme_path_get(const Config *config);
 const char *config_theme_path_default_get(const Config *config);
 
 #define CONFIG_CURSOR_IDLE_TIMEOUT_MAX 60.0
+#define CONFIG_PTY_READ_MAX_DEFAULT (64 * 1024)
+#define CONFIG_PTY_READ_BUDGET_DEFAULT 0.010
+#define CONFIG_ESC_STRING_MAX_DEFAULT (16 * 1024 * 1024)
 
 #endif
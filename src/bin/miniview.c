@@ -85,42 +85,51 @@ _draw_cell(const Termpty *ty, unsigned int *pixel, const Termcell *cell, unsigne
 {
    int fg, bg, fgext, bgext;
    int inv = ty->termstate.reverse;
+   const Termatt *att = TERMPTY_CELL_ATT(ty, cell);
    Eina_Unicode codepoint;
 
-   codepoint = cell->codepoint;
-   if ((codepoint == 0) || (cell->att.newline) || (cell->att.invisible))
+   codepoint = termpty_codepoint_glyph(ty, cell->codepoint);
+   if ((codepoint == 0) || (cell->newline) || (att->invisible))
      {
         *pixel = 0;
         return;
      }
    // colors
-   fg = cell->att.fg;
-   bg = cell->att.bg;
-   fgext = cell->att.fg256;
-   bgext = cell->att.bg256;
-
-   if ((fg == COL_DEF) && (cell->att.inverse ^ inv)) fg = COL_INVERSEBG;
-   if (bg == COL_DEF)
+   fg = att->fg;
+   bg = att->bg;
+   fgext = att->fg256;
+   bgext = att->bg256;
+   /* exact truecolors, as ids */
+   if (att->fgrgb)
      {
-        if (cell->att.inverse ^ inv) bg = COL_INVERSE;
-        else if (!bgext) bg = COL_INVIS;
+        fg = TERMATT_FG_ID(*att);
+        fgext = 2;
      }
-   if ((cell->att.fgintense) && (!fgext)) fg += 48;
-   if ((cell->att.bgintense) && (!bgext)) bg += 48;
-   if (cell->att.inverse ^ inv)
+   if (att->bgrgb)
+     {
+        bg = TERMATT_BG_ID(*att);
+        bgext = 2;
+     }
+
+   termpty_colors_default_resolve(&fg, &bg, fgext, bgext, att->inverse ^ inv);
+   if ((att->fgintense) && (!fgext)) fg += 48;
+   if ((att->bgintense) && (!bgext)) bg += 48;
+   if (att->inverse ^ inv)
      {
         int t;
         t = fgext; fgext = bgext; bgext = t;
         t = fg; fg = bg; bg = t;
      }
-   if ((cell->att.bold) && (!fgext)) fg += 12;
-   if ((cell->att.faint) && (!fgext)) fg += 24;
+   if ((att->bold) && (!fgext)) fg += 12;
+   if ((att->faint) && (!fgext)) fg += 24;
 
-   if (bgext) *pixel = colors[bg + 256];
+   if (bgext == 2) *pixel = 0xff000000 | ty->truecolor.colors[bg];
+   else if (bgext) *pixel = colors[bg + 256];
    else if (bg && ((bg % 12) != COL_INVIS)) *pixel = colors[bg];
    else if ((codepoint > 32) && (codepoint < 0x00110000))
      {
-        if (fgext) *pixel = colors[fg + 256];
+        if (fgext == 2) *pixel = 0xff000000 | ty->truecolor.colors[fg];
+        else if (fgext) *pixel = colors[fg + 256];
         else *pixel = colors[fg];
      }
    else
@@ -504,8 +513,7 @@ miniview_colors_get(Miniview *mv, unsigned int *colors)
      }
    for (c = 0; c < 256; c++)
      {
-        evas_object_textgrid_palette_get
-        (tg, EVAS_TEXTGRID_PALETTE_EXTENDED, c, &r, &g, &b, &a);
+        termio_palette_extended_get(mv->termio, c, &r, &g, &b, &a);
         colors[c + 256] = (a << 24) | (r << 16) | (g << 8) | b;
      }
 }
@@ -553,6 +561,8 @@ _deferred_renderer(void *data)
    if (mv->img_hist < -history_len)
      mv->img_hist = -history_len;
 
+   /* the attributes table may be reallocated while parsing */
+   termpty_backlog_lock(ty);
    for (y = 0; y < mv->img_h; y++)
      {
         Termcell *cells = termpty_cellrow_get(ty, mv->img_hist + y, &wret);
@@ -561,6 +571,7 @@ _deferred_renderer(void *data)
           break;
         _draw_line(ty, &pixels[y * mv->cols], cells, wret, colors);
      }
+   termpty_backlog_unlock(ty);
    evas_object_image_data_set(mv->img, pixels);
    evas_object_image_pixels_dirty_set(mv->img, EINA_FALSE);
    evas_object_image_data_update_add(mv->img, 0, 0, ow, oh);
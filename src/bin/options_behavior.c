@@ -42,14 +42,16 @@ OPTIONS_CB(Behavior_Ctx, selection_escapes, 0);
 OPTIONS_CB(Behavior_Ctx, changedir_to_current, 0);
 OPTIONS_CB(Behavior_Ctx, emoji_dbl_width, 0);
 OPTIONS_CB(Behavior_Ctx, group_all, 0);
+OPTIONS_CB(Behavior_Ctx, threaded_pty, 0);
+OPTIONS_CB(Behavior_Ctx, exact_truecolor, 0);
 
 static unsigned int
 sback_double_to_expo_int(double d)
 {
     if (d < 1.0)
         return 0;
-    if (d >= 17.0)
-        d = 17.0;
+    if (d >= 24.0)
+        d = 24.0;
     return 1 << (unsigned char) d;
 }
 
@@ -64,21 +66,31 @@ sback_units_format(double d)
     return (char*)eina_stringshare_printf(_("%'d lines"), sback_double_to_expo_int(d));
 }
 
-static void
-_update_backlog_title(Behavior_Ctx *ctx)
+static char
+_memory_scale(double *amount)
 {
    char *factor = " KMG";
-   double amount = termpty_backlog_memory_get();
 
-   while (amount > 1024.0 && factor[1] != '\0')
+   while (*amount > 1024.0 && factor[1] != '\0')
      {
-        amount /= 1024;
+        *amount /= 1024;
         factor++;
      }
+   return factor[0];
+}
+
+static void
+_update_backlog_title(Behavior_Ctx *ctx)
+{
+   double amount = termpty_backlog_memory_get();
+   double peak = termpty_backlog_memory_peak_get();
+   char amount_factor = _memory_scale(&amount);
+   char peak_factor = _memory_scale(&peak);
+
    eina_stringshare_del(ctx->backlog_msg);
    ctx->backlog_msg = (char*) eina_stringshare_printf(
-      _("Scrollback (current memory usage: %'.2f%cB):"),
-      amount, factor[0]);
+      _("Scrollback (current memory usage: %'.2f%cB, peak: %'.2f%cB):"),
+      amount, amount_factor, peak, peak_factor);
    elm_object_text_set(ctx->backlock_label, ctx->backlog_msg);
 }
 
@@ -96,6 +108,19 @@ _cb_op_behavior_sback_chg(void *data,
    config_save(config);
 }
 
+static void
+_cb_op_behavior_sback_budget_chg(void *data,
+                                 Evas_Object *obj,
+                                 void *_event EINA_UNUSED)
+{
+   Behavior_Ctx *ctx = data;
+   Config *config = ctx->config;
+
+   config->scrollback_budget = (int)round(elm_slider_value_get(obj));
+   termio_config_update(ctx->term);
+   config_save(config);
+}
+
 static void
 _cb_op_behavior_tab_zoom_slider_chg(void *data,
                                     Evas_Object *obj,
@@ -418,6 +443,8 @@ options_behavior(Evas_Object *opbox, Evas_Object *term)
    OPTIONS_CX(_("Enable escape codes manipulating selections"), selection_escapes, 0);
    OPTIONS_CX(_("Always treat Emojis as double-width characters"), emoji_dbl_width, 0);
    OPTIONS_CX(_("When grouping input, do it on all terminals and not just the visible ones"), group_all, 0);
+   OPTIONS_CX(_("Read and parse output of new terminals in a separate thread"), threaded_pty, 0);
+   OPTIONS_CX(_("Show 24-bit colors exactly instead of approximating them"), exact_truecolor, 0);
 
    OPTIONS_SEPARATOR;
 
@@ -512,7 +539,9 @@ options_behavior(Evas_Object *opbox, Evas_Object *term)
    } u;
    u.v = config->scrollback;
    u.c = (u.c >> 23) - 127;
-   elm_slider_min_max_set(o, 0.0, 17.0);
+   /* past that, only a backlog spilling to a file is worth it */
+   elm_slider_min_max_set(o, 0.0,
+                          (config->scrollback_spill > 0) ? 24.0 : 17.0);
    elm_slider_value_set(o, u.c);
    evas_object_size_hint_weight_set(o, EVAS_HINT_EXPAND, 0.0);
    evas_object_size_hint_align_set(o, EVAS_HINT_FILL, 0.0);
@@ -521,6 +550,32 @@ options_behavior(Evas_Object *opbox, Evas_Object *term)
    evas_object_smart_callback_add(o, "delay,changed",
                                   _cb_op_behavior_sback_chg, ctx);
 
+   o = elm_label_add(bx);
+   evas_object_size_hint_weight_set(o, 0.0, 0.0);
+   evas_object_size_hint_align_set(o, 0.0, 0.5);
+   tooltip = _("Memory the lines of the scrollbacks<br>"
+       "of all the terminals may take,<br>"
+       "those shown the least recently giving<br>"
+       "it back first. 0 for no limit");
+   elm_object_tooltip_text_set(o, tooltip);
+   elm_object_text_set(o, _("Scrollback memory budget:"));
+   elm_box_pack_end(bx, o);
+   evas_object_show(o);
+
+   o = elm_slider_add(bx);
+   evas_object_size_hint_weight_set(o, EVAS_HINT_EXPAND, 0.0);
+   evas_object_size_hint_align_set(o, EVAS_HINT_FILL, 0.0);
+   elm_slider_span_size_set(o, 40);
+   elm_slider_unit_format_set(o, _("%1.0f MiB"));
+   elm_slider_indicator_format_set(o, _("%1.0f MiB"));
+   elm_slider_step_set(o, 1.0 / 1024);
+   elm_slider_min_max_set(o, 0.0, 1024.0);
+   elm_slider_value_set(o, config->scrollback_budget);
+   elm_box_pack_end(bx, o);
+   evas_object_show(o);
+   evas_object_smart_callback_add(o, "delay,changed",
+                                  _cb_op_behavior_sback_budget_chg, ctx);
+
    OPTIONS_SEPARATOR;
 
    o = elm_label_add(bx);
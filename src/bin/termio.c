@@ -10,6 +10,7 @@
 #include "backlog.h"
 #include "extns.h"
 #include "termptyops.h"
+#include "termptyesc.h"
 #include "termcmd.h"
 #include "termptydbl.h"
 #include "utf8.h"
@@ -501,6 +502,28 @@ termio_textgrid_get(const Evas_Object *obj)
    return sd->grid.obj;
 }
 
+/* Color of the extended palette, even while its slot shows an exact
+ * truecolor */
+void
+termio_palette_extended_get(const Evas_Object *obj, int c,
+                            int *r, int *g, int *b, int *a)
+{
+   Termio *sd = evas_object_smart_data_get(obj);
+   EINA_SAFETY_ON_NULL_RETURN(sd);
+
+   if (sd->exact.last[c])
+     {
+        *r = sd->exact.saved[c].r;
+        *g = sd->exact.saved[c].g;
+        *b = sd->exact.saved[c].b;
+        *a = sd->exact.saved[c].a;
+     }
+   else
+     evas_object_textgrid_palette_get(sd->grid.obj,
+                                      EVAS_TEXTGRID_PALETTE_EXTENDED, c,
+                                      r, g, b, a);
+}
+
 Evas_Object *
 termio_win_get(const Evas_Object *obj)
 {
@@ -544,6 +567,8 @@ termio_config_update(Evas_Object *obj)
    sd->scroll = 0;
 
    colors_term_init(sd->grid.obj, sd->config->color_scheme);
+   memset(sd->exact.last, 0, sizeof(sd->exact.last));
+   termpty_palette_changed(sd->pty);
 
    evas_object_textgrid_font_set(sd->grid.obj, sd->font.name, sd->font.size);
    evas_object_textgrid_cell_size_get(sd->grid.obj, &w, &h);
@@ -1788,7 +1813,7 @@ _hyperlink_mouseover(Termio *sd,
 
    /* Scan the whole screen and display links as needed */
    termio_object_geometry_get(sd, &ox, &oy, &ow, &oh);
-   termpty_backlog_lock();
+   termpty_backlog_lock(sd->pty);
    termpty_backscroll_adjust(sd->pty, &sd->scroll);
    for (y = 0; y < sd->grid.h; y++)
      {
@@ -1806,7 +1831,8 @@ _hyperlink_mouseover(Termio *sd,
         for (x = 0; x < w; x++)
           {
              Termcell *c = cells + x;
-             if (term_link_eq(sd->pty, hl, c->att.link_id))
+             if (term_link_eq(sd->pty, hl,
+                              TERMPTY_CELL_ATT(sd->pty, c)->link_id))
                {
                   if (!o)
                     {
@@ -1858,7 +1884,7 @@ _hyperlink_mouseover(Termio *sd,
                }
           }
      }
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(sd->pty);
 }
 
 
@@ -2620,6 +2646,7 @@ _smart_mouseover_apply(Termio *sd)
    Eina_Bool same_geom = EINA_FALSE;
    Config *config;
    Termcell *cell = NULL;
+   uint16_t link_id = 0;
 
    EINA_SAFETY_ON_NULL_RETURN(sd);
    config = sd->config;
@@ -2630,17 +2657,22 @@ _smart_mouseover_apply(Termio *sd)
         termio_remove_links(sd);
         return;
      }
+   /* the attributes table may be reallocated while parsing */
+   termpty_backlog_lock(sd->pty);
    cell = termpty_cell_get(sd->pty, sd->mouse.cy - sd->scroll, sd->mouse.cx);
+   if (cell)
+     link_id = TERMPTY_CELL_ATT(sd->pty, cell)->link_id;
+   termpty_backlog_unlock(sd->pty);
    if (!cell)
      {
         termio_remove_links(sd);
         return;
      }
 
-   if (cell->att.link_id)
+   if (link_id)
      {
         if (config->active_links_escape)
-          _hyperlink_mouseover(sd, cell->att.link_id);
+          _hyperlink_mouseover(sd, link_id);
         return;
      }
 
@@ -3339,6 +3371,9 @@ _smart_cb_change(void *data)
    Termio *sd = evas_object_smart_data_get(obj);
 
    EINA_SAFETY_ON_NULL_RETURN_VAL(sd, EINA_FALSE);
+   /* render once the application is done with its update */
+   if (termpty_sync_output_held(sd->pty))
+     return EINA_TRUE;
    sd->anim = NULL;
    _smart_apply(obj);
    evas_object_smart_callback_call(obj, "changed", NULL);
@@ -3658,11 +3693,12 @@ _smart_pty_cancel_sel(void *data)
    Termio *sd = evas_object_smart_data_get(obj);
 
    EINA_SAFETY_ON_NULL_RETURN(sd);
-   if (sd->pty->selection.is_active)
+   if ((sd->pty->selection.is_active) && (termpty_main_loop_begin(sd->pty)))
      {
         termio_sel_set(sd, EINA_FALSE);
         sd->pty->selection.makesel = EINA_FALSE;
         termio_smart_update_queue(sd);
+        termpty_main_loop_end(sd->pty);
      }
 }
 
@@ -1,5 +1,4 @@
 #include "private.h"
-my
 #include <Elementary.h>
 
 #include "termio.h"
@@ -8,6 +7,7 @@ my
 #include "backlog.h"
 #include "termptydbl.h"
 #include "termptyops.h"
+#include "termptyesc.h"
 #include "termiointernals.h"
 #include "utf8.h"
 #if defined(BINARY_TYTEST) || defined(ENABLE_TEST_UI)
@@ -34,7 +34,7 @@ termio_selection_get(Termio *sd,
        ty_sb_spaces_rtrim(sb);        \
 } while (0)
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(sd->pty);
    for (y = c1y; y <= c2y; y++)
      {
         Termcell *cells;
@@ -59,7 +59,7 @@ termio_selection_get(Termio *sd,
              SB_ADD("\n", 1);
              continue;
           }
-        start_x = c1x;hmm
+        start_x = c1x;
         end_x = (c2x >= w) ? w - 1 : c2x;
         if (c1y != c2y)
           {
@@ -76,7 +76,7 @@ termio_selection_get(Termio *sd,
 
         for (x = start_x; x <= end_x; x++)
           {
-             if ((cells[x].codepoint == 0) && (cells[x].att.dblwidth))
+             if ((cells[x].codepoint == 0) && (cells[x].dblwidth))
                {
                   if (x < end_x)
                     x++;
@@ -85,7 +85,7 @@ termio_selection_get(Termio *sd,
                }
              if (x >= w)
                break;
-             if (cells[x].att.tab_inserted)
+             if (cells[x].tab_inserted)
                {
                   /* There was a tab inserted.
                    * Only output it if there were spaces/empty cells "below"
@@ -94,7 +94,7 @@ termio_selection_get(Termio *sd,
                   while ((is_tab) && (x < end_x))
                     {
                        if (((cells[x].codepoint == 0) ||
-                            (cells[x].att.invisible == 1) ||
+                            (TERMPTY_CELL_ATT(sd->pty, &cells[x])->invisible == 1) ||
                             (cells[x].codepoint == ' ')))
                          {
                               x++;
@@ -103,7 +103,7 @@ termio_selection_get(Termio *sd,
                          {
                             is_tab = EINA_FALSE;
                          }
-                       if (cells[x].att.tab_last)
+                       if (cells[x].tab_last)
                          {
                             SB_ADD("\t", 1);
                             if (is_tab)
@@ -115,7 +115,7 @@ termio_selection_get(Termio *sd,
                          }
                     }
                }
-             if (cells[x].att.newline)
+             if (cells[x].newline)
                {
                   last0 = -1;
                   if ((y != c2y) || (x != end_x))
@@ -134,7 +134,7 @@ termio_selection_get(Termio *sd,
                }
              else
                {
-                  char txt[8];
+                  char txt[TERMPTY_CLUSTER_UTF8_MAX];
                   int txtlen;
 
                   if (last0 >= 0)
@@ -147,13 +147,14 @@ termio_selection_get(Termio *sd,
                             v--;
                          }
                     }
-                  txtlen = codepoint_to_utf8(cells[x].codepoint, txt);
+                  txtlen = termpty_codepoint_to_utf8(sd->pty,
+                                                     cells[x].codepoint, txt);
                   if (txtlen > 0)
                     SB_ADD(txt, txtlen);
                   if ((x == (w - 1)) &&
                       ((x != c2x) || (y != c2y)))
                     {
-                       if (!cells[x].att.autowrapped)
+                       if (!cells[x].autowrapped)
                          {
                             RTRIM();
                             SB_ADD("\n", 1);
@@ -172,7 +173,7 @@ termio_selection_get(Termio *sd,
                   for (x = end_x + 1; x < w; x++)
                     {
                        if ((cells[x].codepoint == 0) &&
-                           (cells[x].att.dblwidth))
+                           (cells[x].dblwidth))
                          {
                             if (x < (w - 1))
                               x++;
@@ -181,7 +182,7 @@ termio_selection_get(Termio *sd,
                          }
                        if (((cells[x].codepoint != 0) &&
                             (cells[x].codepoint != ' ')) ||
-                           (cells[x].att.newline))
+                           (cells[x].newline))
                          {
                             have_more = EINA_TRUE;
                             break;
@@ -197,7 +198,7 @@ termio_selection_get(Termio *sd,
                        for (x = last0; x <= end_x; x++)
                          {
                             if ((cells[x].codepoint == 0) &&
-                                (cells[x].att.dblwidth))
+                                (cells[x].dblwidth))
                               {
                                  if (x < (w - 1))
                                    x++;
@@ -217,7 +218,7 @@ termio_selection_get(Termio *sd,
                }
           }
      }
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(sd->pty);
 
    RTRIM();
 
@@ -271,7 +272,7 @@ _sel_codepoints_get(const Termio *sd,
        }                               \
 } while (0)
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(sd->pty);
    for (y = c1y; y <= c2y; y++)
      {
         Termcell *cells;
@@ -322,7 +323,7 @@ _sel_codepoints_get(const Termio *sd,
           }
      }
 err:
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(sd->pty);
 }
 
 static void
@@ -464,7 +465,7 @@ _sel_line(Termio *sd, int cy)
    ssize_t w = 0;
    Termcell *cells;
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(sd->pty);
 
    termio_sel_set(sd, EINA_TRUE);
    sd->pty->selection.makesel = EINA_FALSE;
@@ -479,7 +480,7 @@ _sel_line(Termio *sd, int cy)
    for (;;)
      {
         cells = termpty_cellrow_get(sd->pty, y - 1, &w);
-        if (!cells || w <= 0 || !cells[w-1].att.autowrapped)
+        if (!cells || w <= 0 || !cells[w-1].autowrapped)
           break;
         y--;
      }
@@ -490,7 +491,7 @@ _sel_line(Termio *sd, int cy)
    for (;;)
      {
         cells = termpty_cellrow_get(sd->pty, y, &w);
-        if (!cells || !cells[w-1].att.autowrapped)
+        if (!cells || !cells[w-1].autowrapped)
           {
              sd->pty->selection.end.x = w - 1;
              break;
@@ -501,7 +502,7 @@ _sel_line(Termio *sd, int cy)
    x = sd->pty->selection.end.x;
    while ((x > 0) && (cells != NULL) && ((cells[x].codepoint == 0) ||
                                          (cells[x].codepoint == ' ') ||
-                                         (cells[x].att.newline)))
+                                         (cells[x].newline)))
      {
         x--;
      }
@@ -511,7 +512,7 @@ _sel_line(Termio *sd, int cy)
    sd->pty->selection.by_line = EINA_TRUE;
    sd->pty->selection.is_top_to_bottom = EINA_TRUE;
 
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(sd->pty);
 }
 
 static void
@@ -898,7 +899,7 @@ _sel_word(Termio *sd, int cx, int cy)
    ssize_t w = 0;
    Eina_Bool done = EINA_FALSE;
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(sd->pty);
 
    termio_sel_set(sd, EINA_TRUE);
    sd->pty->selection.makesel = EINA_TRUE;
@@ -936,7 +937,7 @@ _sel_word(Termio *sd, int cx, int cy)
      {
         for (; x >= 0; x--)
           {
-             if ((cells[x].codepoint == 0) && (cells[x].att.dblwidth) &&
+             if ((cells[x].codepoint == 0) && (cells[x].dblwidth) &&
                  (x > 0))
                {
                   x--;
@@ -955,7 +956,7 @@ _sel_word(Termio *sd, int cx, int cy)
              size_t old_w = w;
 
              cells = termpty_cellrow_get(sd->pty, y - 1, &w);
-             if ((!cells) || (w == 0) || (!cells[w-1].att.autowrapped))
+             if ((!cells) || (w == 0) || (!cells[w-1].autowrapped))
                {
                   x = cx;
                   cells = old_cells;
@@ -988,7 +989,7 @@ _sel_word(Termio *sd, int cx, int cy)
      {
         for (; x < w; x++)
           {
-             if ((cells[x].codepoint == 0) && (cells[x].att.dblwidth) &&
+             if ((cells[x].codepoint == 0) && (cells[x].dblwidth) &&
                  (x < (w - 1)))
                {
                   sd->pty->selection.end.x = x;
@@ -1004,7 +1005,7 @@ _sel_word(Termio *sd, int cx, int cy)
           }
         if (!done)
           {
-             if (!cells[w - 1].att.autowrapped)
+             if (!cells[w - 1].autowrapped)
                {
                   goto end;
                }
@@ -1026,7 +1027,7 @@ _sel_word(Termio *sd, int cx, int cy)
 
    _trim_sel_word(sd);
 
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(sd->pty);
 }
 
 static void
@@ -1308,7 +1309,7 @@ _selection_newline_extend_fix(Termio *sd)
    if ((sd->top_left) || (sd->bottom_right) || (sd->pty->selection.is_box))
      return;
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(sd->pty);
 
    start_x = sd->pty->selection.start.x;
    start_y = sd->pty->selection.start.y;
@@ -1353,7 +1354,7 @@ _selection_newline_extend_fix(Termio *sd)
    sd->pty->selection.end.x = end_x;
    sd->pty->selection.end.y = end_y;
 
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(sd->pty);
 }
 
 void
@@ -1376,7 +1377,7 @@ termio_selection_dbl_fix(Termio *sd)
         INT_SWAP(start_x, end_x);
      }
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(sd->pty);
    cells = termpty_cellrow_get(sd->pty, end_y - sd->scroll, &w);
    if (cells)
      {
@@ -1388,7 +1389,7 @@ termio_selection_dbl_fix(Termio *sd)
              if (end_x < (w - 1))
                {
                   if ((cells[end_x].codepoint != 0) &&
-                      (cells[end_x].att.dblwidth))
+                      (cells[end_x].dblwidth))
                     end_x++;
                }
           }
@@ -1398,7 +1399,7 @@ termio_selection_dbl_fix(Termio *sd)
              if (end_x > 0)
                {
                   if ((cells[end_x].codepoint == 0) &&
-                      (cells[end_x].att.dblwidth))
+                      (cells[end_x].dblwidth))
                     end_x--;
                }
           }
@@ -1414,7 +1415,7 @@ termio_selection_dbl_fix(Termio *sd)
              if ((start_x > 0) && (start_x < w))
                {
                   if ((cells[start_x].codepoint == 0) &&
-                      (cells[start_x].att.dblwidth))
+                      (cells[start_x].dblwidth))
                     start_x--;
                }
           }
@@ -1424,12 +1425,12 @@ termio_selection_dbl_fix(Termio *sd)
              if (start_x < (w - 1))
                {
                   if ((cells[start_x].codepoint != 0) &&
-                      (cells[start_x].att.dblwidth))
+                      (cells[start_x].dblwidth))
                     start_x++;
                }
           }
      }
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(sd->pty);
 
    if (!sd->pty->selection.is_top_to_bottom)
      {
@@ -2378,6 +2379,12 @@ termio_scroll(Evas_Object *obj, int direction,
 
    ty = sd->pty;
 
+   /* Nothing to adjust in the common case. This is only called from the
+    * main loop, see termpty_scroll() */
+   if (((sd->jump_on_change) || (sd->scroll <= 0)) &&
+       (!ty->selection.is_active))
+     return;
+
    if ((!sd->jump_on_change) && // if NOT scroll to bottom on updates
        (sd->scroll > 0))
      {
@@ -2393,6 +2400,161 @@ termio_scroll(Evas_Object *obj, int direction,
    _termio_scroll_selection(sd, ty, direction, start_y, end_y);
 }
 
+static void
+_exact_slot_restore(Termio *sd, int s)
+{
+   evas_object_textgrid_palette_set(sd->grid.obj,
+                                    EVAS_TEXTGRID_PALETTE_EXTENDED, s,
+                                    sd->exact.saved[s].r,
+                                    sd->exact.saved[s].g,
+                                    sd->exact.saved[s].b,
+                                    sd->exact.saved[s].a);
+   sd->exact.last[s] = 0;
+}
+
+static void
+_exact_slot_lend(Termio *sd, int s, uint32_t rgb)
+{
+   if (!sd->exact.last[s])
+     {
+        int r = 0, g = 0, b = 0, a = 0;
+
+        evas_object_textgrid_palette_get(sd->grid.obj,
+                                         EVAS_TEXTGRID_PALETTE_EXTENDED, s,
+                                         &r, &g, &b, &a);
+        sd->exact.saved[s].r = r;
+        sd->exact.saved[s].g = g;
+        sd->exact.saved[s].b = b;
+        sd->exact.saved[s].a = a;
+     }
+   evas_object_textgrid_palette_set(sd->grid.obj,
+                                    EVAS_TEXTGRID_PALETTE_EXTENDED, s,
+                                    rgb >> 16, (rgb >> 8) & 0xff, rgb & 0xff,
+                                    0xff);
+   sd->exact.rgb[s] = rgb;
+   sd->exact.last[s] = sd->exact.frame;
+}
+
+/* Adds truecolor @id to the @n colors @shown, once per frame */
+static inline int
+_exact_color_shown(Termio *sd, uint16_t *shown, int n, uint16_t id)
+{
+   if (sd->exact.slot[id] == -1)
+     {
+        sd->exact.slot[id] = -2;
+        shown[n++] = id;
+     }
+   return n;
+}
+
+/* Exact truecolors are drawn with slots of the extended palette that no
+ * visible cell uses, lent to them until they are the least recently shown
+ * colors: changing a slot redraws the whole textgrid.
+ * Fills sd->exact.slot with the slot to use for every visible truecolor,
+ * approximated in the palette if there are not enough slots */
+static void
+_exact_colors_prepare(Termio *sd)
+{
+   Termpty *ty = sd->pty;
+   uint8_t used[256];
+   uint16_t shown[TERMPTY_TRUECOLOR_MAX];
+   int n = 0, available = 0, i, s, x, y;
+
+   if (!ty->truecolor.colors)
+     return;
+
+   sd->exact.frame++;
+   if (!sd->exact.frame)
+     {
+        /* wrapped around: let them all be the least recent */
+        for (s = 0; s < 256; s++)
+          if (sd->exact.last[s])
+            sd->exact.last[s] = 1;
+        sd->exact.frame = 2;
+     }
+   memset(used, 0, sizeof(used));
+   memset(sd->exact.slot, 0xff, sizeof(sd->exact.slot));
+
+   for (y = 0; y < sd->grid.h; y++)
+     {
+        Termcell *cells;
+        ssize_t w = 0;
+
+        cells = termpty_cellrow_get(ty, y - sd->scroll, &w);
+        if (!cells)
+          continue;
+        if (w > sd->grid.w)
+          w = sd->grid.w;
+        for (x = 0; x < w; x++)
+          {
+             const Termatt *att = TERMPTY_CELL_ATT(ty, &cells[x]);
+
+             if (att->invisible)
+               continue;
+             if (att->fgrgb)
+               n = _exact_color_shown(sd, shown, n, TERMATT_FG_ID(*att));
+             else if (att->fg256)
+               used[att->fg] = 1;
+             if (att->bgrgb)
+               n = _exact_color_shown(sd, shown, n, TERMATT_BG_ID(*att));
+             else if (att->bg256)
+               used[att->bg] = 1;
+          }
+     }
+
+   for (s = 0; s < 256; s++)
+     {
+        if (!used[s])
+          available++;
+        else if (sd->exact.last[s])
+          _exact_slot_restore(sd, s);
+     }
+
+   if (n > available)
+     {
+        for (s = 0; s < 256; s++)
+          if (sd->exact.last[s])
+            _exact_slot_restore(sd, s);
+        for (i = 0; i < n; i++)
+          sd->exact.slot[shown[i]] =
+             termpty_truecolor_approximate(ty, ty->truecolor.colors[shown[i]]);
+        return;
+     }
+
+   /* keep the colors already having a slot */
+   for (s = 0; s < 256; s++)
+     {
+        int id;
+
+        if (!sd->exact.last[s])
+          continue;
+        id = termpty_truecolor_find(ty, sd->exact.rgb[s]);
+        if ((id >= 0) && (sd->exact.slot[id] == -2))
+          {
+             sd->exact.slot[id] = s;
+             sd->exact.last[s] = sd->exact.frame;
+          }
+     }
+   for (i = 0; i < n; i++)
+     {
+        int id = shown[i], lru = -1;
+
+        if (sd->exact.slot[id] >= 0)
+          continue;
+        /* slots with their palette color come first, from the end of the
+         * grayscale ramp */
+        for (s = 255; s >= 0; s--)
+          {
+             if ((used[s]) || (sd->exact.last[s] == sd->exact.frame))
+               continue;
+             if ((lru < 0) || (sd->exact.last[s] < sd->exact.last[lru]))
+               lru = s;
+          }
+        _exact_slot_lend(sd, lru, ty->truecolor.colors[id]);
+        sd->exact.slot[id] = lru;
+     }
+}
+
 void
 termio_internal_render(Termio *sd,
                        Evas_Coord ox, Evas_Coord oy,
@@ -2405,6 +2567,7 @@ termio_internal_render(Termio *sd,
    Termblock *blk;
    Eina_List *l;
 
+   termpty_backlog_lock(sd->pty);
    EINA_LIST_FOREACH(sd->pty->block.active, l, blk)
      {
         blk->was_active = blk->active;
@@ -2412,8 +2575,11 @@ termio_internal_render(Termio *sd,
      }
 
    inv = sd->pty->termstate.reverse;
-   termpty_backlog_lock();
+   /* what the reader thread scrolled since the last notification */
+   termpty_scroll_flush(sd->pty);
    termpty_backscroll_adjust(sd->pty, &sd->scroll);
+   termpty_backlog_viewed(sd->pty);
+   _exact_colors_prepare(sd);
 
    /* Make selection bottom to top */
    sel_start_x = sd->pty->selection.start.x;
@@ -2553,6 +2719,7 @@ termio_internal_render(Termio *sd,
                }
              else
                {
+                  const Termatt *att = TERMPTY_CELL_ATT(sd->pty, &cells[x]);
                   int bid, bx = 0, by = 0;
 
                   bid = termpty_block_id_get(&(cells[x]), &bx, &by);
@@ -2595,7 +2762,7 @@ termio_internal_render(Termio *sd,
                             l1 = l2 = -1;
                          }
                     }
-                  else if (cells[x].att.invisible)
+                  else if (att->invisible)
                     {
                        if ((tc[x].codepoint != 0) ||
                            (tc[x].bg != COL_INVIS) ||
@@ -2612,7 +2779,7 @@ termio_internal_render(Termio *sd,
                        tc[x].strikethrough = 0;
                        tc[x].bold = 0;
                        tc[x].italic = 0;
-                       tc[x].double_width = cells[x].att.dblwidth;
+                       tc[x].double_width = cells[x].dblwidth;
                        if ((tc[x].double_width) && (tc[x].codepoint == 0) &&
                            (ch2 == x - 1))
                          ch2 = x;
@@ -2633,34 +2800,33 @@ termio_internal_render(Termio *sd,
                        Eina_Unicode codepoint;
 
                        // colors
-                       fg = cells[x].att.fg;
-                       bg = cells[x].att.bg;
-                       fgext = cells[x].att.fg256;
-                       bgext = cells[x].att.bg256;
-                       codepoint = cells[x].codepoint;
-
-                       if ((fg == COL_DEF) && (cells[x].att.inverse ^ inv))
-                         fg = COL_INVERSEBG;
-                       if (bg == COL_DEF)
-                         {
-                            if (cells[x].att.inverse ^ inv)
-                              bg = COL_INVERSE;
-                            else if (!bgext)
-                              bg = COL_INVIS;
-                         }
-
-                       if ((cells[x].att.bgintense) && (!bgext))
+                       fg = att->fg;
+                       bg = att->bg;
+                       fgext = att->fg256;
+                       bgext = att->bg256;
+                       codepoint = termpty_codepoint_glyph(sd->pty,
+                                                           cells[x].codepoint);
+                       if (EINA_UNLIKELY(att->fgrgb))
+                         fg = sd->exact.slot[TERMATT_FG_ID(*att)];
+                       if (EINA_UNLIKELY(att->bgrgb))
+                         bg = sd->exact.slot[TERMATT_BG_ID(*att)];
+
+                       termpty_colors_default_resolve(&fg, &bg,
+                                                      fgext, bgext,
+                                                      att->inverse ^ inv);
+
+                       if ((att->bgintense) && (!bgext))
                          bg += 12;
 
                        if (!fgext)
                          {
-                            if ((cells[x].att.fgintense) || (cells[x].att.bold))
+                            if ((att->fgintense) || (att->bold))
                               fg += 12;
-                            if (cells[x].att.faint)
+                            if (att->faint)
                               fg += 2 * 12;
                          }
 
-                       if (cells[x].att.inverse ^ inv)
+                       if (att->inverse ^ inv)
                          {
                             int t;
                             t = fgext; fgext = bgext; bgext = t;
@@ -2672,8 +2838,8 @@ termio_internal_render(Termio *sd,
                         */
                        if (sd->config->font.bolditalic)
                          {
-                            bold = cells[x].att.bold;
-                            italic = cells[x].att.italic;
+                            bold = att->bold;
+                            italic = att->italic;
                          }
                        else
                          {
@@ -2688,8 +2854,8 @@ termio_internal_render(Termio *sd,
                            (tc[x].bg != bg) ||
                            (tc[x].fg_extended != fgext) ||
                            (tc[x].bg_extended != bgext) ||
-                           (tc[x].underline != cells[x].att.underline) ||
-                           (tc[x].strikethrough != cells[x].att.strike))
+                           (tc[x].underline != att->underline) ||
+                           (tc[x].strikethrough != att->strike))
                          {
                             if (ch1 < 0)
                               ch1 = x;
@@ -2697,19 +2863,19 @@ termio_internal_render(Termio *sd,
                          }
                        tc[x].fg_extended = fgext;
                        tc[x].bg_extended = bgext;
-                       tc[x].underline = cells[x].att.underline;
-                       tc[x].strikethrough = cells[x].att.strike;
+                       tc[x].underline = att->underline;
+                       tc[x].strikethrough = att->strike;
                        if (sd->config->font.bolditalic)
                          {
-                            tc[x].bold = cells[x].att.bold;
-                            tc[x].italic = cells[x].att.italic;
+                            tc[x].bold = att->bold;
+                            tc[x].italic = att->italic;
                          }
                        else
                          {
                             tc[x].bold = 0;
                             tc[x].italic = 0;
                          }
-                       tc[x].double_width = cells[x].att.dblwidth;
+                       tc[x].double_width = cells[x].dblwidth;
                        tc[x].fg = fg;
                        tc[x].bg = bg;
                        if (tc[x].codepoint != codepoint &&
@@ -2722,9 +2888,9 @@ termio_internal_render(Termio *sd,
                        if ((tc[x].double_width) && (tc[x].codepoint == 0) &&
                            (ch2 == x - 1))
                          ch2 = x;
-                       // cells[x].att.blink
-                       // cells[x].att.blink2
-                       if (u && (*u != codepoint) &&
+                       // att->blink
+                       // att->blink2
+                       if (u && (*u != cells[x].codepoint) &&
                            !(*u == 0x20 && codepoint == 0))
                          {
                             termio_sel_set(sd, EINA_FALSE);
@@ -2820,7 +2986,7 @@ termio_internal_render(Termio *sd,
         preedit_x = x - sd->cursor.x;
         preedit_y = y - sd->cursor.y;
      }
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(sd->pty);
    *preedit_xp = preedit_x;
    *preedit_yp = preedit_y;
 }
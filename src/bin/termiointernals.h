@@ -65,6 +65,15 @@ struct tag_Termio
         int b;
         int a;
    } saved_bg, saved_fg, saved_cursor;
+   /* extended palette slots lent to exact truecolors, see
+    * _exact_colors_prepare() */
+   struct {
+      uint32_t rgb[256];
+      Color saved[256]; /* palette color of the slot */
+      unsigned int last[256]; /* render it was last used in, 0 if not lent */
+      unsigned int frame;
+      int16_t slot[TERMPTY_TRUECOLOR_MAX]; /* by truecolor id */
+   } exact;
    Evas_Object *ctxpopup;
    int zoom_fontsize_start;
    int scroll;
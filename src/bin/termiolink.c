@@ -252,7 +252,7 @@ _txt_at(Termpty *ty, int *x, int *y, char *txt, int *txtlenp, int *codepointp)
    if ((*x >= w))
      goto empty;
    cell = cells[*x];
-   if ((cell.codepoint == 0) && (cell.att.dblwidth))
+   if ((cell.codepoint == 0) && (cell.dblwidth))
      {
         (*x)--;
         if (*x < 0)
@@ -260,18 +260,18 @@ _txt_at(Termpty *ty, int *x, int *y, char *txt, int *txtlenp, int *codepointp)
         cell = cells[*x];
      }
 
-   if (cell.att.tab_inserted)
+   if (cell.tab_inserted)
      {
         *txtlenp = 1;
         *codepointp = '\t';
         txt[0] = '\t';
         return 0;
      }
-   if ((cell.codepoint == 0) || (cell.att.link_id))
+   if ((cell.codepoint == 0) || (TERMPTY_CELL_ATT(ty, &cell)->link_id))
      goto empty;
 
-   *txtlenp = codepoint_to_utf8(cell.codepoint, txt);
-   *codepointp = cell.codepoint;
+   *codepointp = termpty_codepoint_base(ty, cell.codepoint);
+   *txtlenp = codepoint_to_utf8(*codepointp, txt);
 
    return 0;
 
@@ -309,7 +309,7 @@ _txt_prev_at(Termpty *ty, int *x, int *y, char *txt, int *txtlenp,
         /* Either the cell is in the normal screen and needs to have
          * autowrapped flag or is in the backlog and its length is larger than
          * the screen, spanning multiple lines */
-        if (((!cell.att.autowrapped) && (*y) >= 0)
+        if (((!cell.autowrapped) && (*y) >= 0)
             || (w < ty->w))
           goto empty;
      }
@@ -323,7 +323,7 @@ _txt_prev_at(Termpty *ty, int *x, int *y, char *txt, int *txtlenp,
 
         cell = cells[*x];
      }
-   if ((cell.codepoint == 0) && (cell.att.dblwidth))
+   if ((cell.codepoint == 0) && (cell.dblwidth))
      {
         (*x)--;
         if (*x < 0)
@@ -331,9 +331,9 @@ _txt_prev_at(Termpty *ty, int *x, int *y, char *txt, int *txtlenp,
         cell = cells[*x];
      }
 
-   if (cell.att.tab_last)
+   if (cell.tab_last)
      {
-        while (*x >= 0 && !cells[*x].att.tab_inserted)
+        while (*x >= 0 && !cells[*x].tab_inserted)
           (*x)--;
         if (*x < 0)
           goto bad;
@@ -342,11 +342,11 @@ _txt_prev_at(Termpty *ty, int *x, int *y, char *txt, int *txtlenp,
         txt[0] = '\t';
         return 0;
      }
-   if ((cell.codepoint == 0) || (cell.att.link_id))
+   if ((cell.codepoint == 0) || (TERMPTY_CELL_ATT(ty, &cell)->link_id))
      goto empty;
 
-   *txtlenp = codepoint_to_utf8(cell.codepoint, txt);
-   *codepointp = cell.codepoint;
+   *codepointp = termpty_codepoint_base(ty, cell.codepoint);
+   *txtlenp = codepoint_to_utf8(*codepointp, txt);
 
    return 0;
 
@@ -380,7 +380,7 @@ _txt_next_at(Termpty *ty, int *x, int *y, char *txt, int *txtlenp,
         if ((*x) <= ty->w)
           {
              cell = cells[w-1];
-             if (!cell.att.autowrapped)
+             if (!cell.autowrapped)
                goto empty;
           }
 
@@ -391,13 +391,13 @@ _txt_next_at(Termpty *ty, int *x, int *y, char *txt, int *txtlenp,
      }
 
    cell = cells[*x];
-   if ((cell.codepoint == 0) && (cell.att.dblwidth))
+   if ((cell.codepoint == 0) && (cell.dblwidth))
      {
         (*x)++;
         if (*x >= w)
           {
              cell = cells[w-1];
-             if (!cell.att.autowrapped && w == ty->w)
+             if (!cell.autowrapped && w == ty->w)
                goto empty;
              (*y)++;
              *x = 0;
@@ -409,9 +409,9 @@ _txt_next_at(Termpty *ty, int *x, int *y, char *txt, int *txtlenp,
      }
 
    cell = cells[*x];
-   if (cell.att.tab_inserted)
+   if (cell.tab_inserted)
      {
-        while (*x < w && !cells[*x].att.tab_last)
+        while (*x < w && !cells[*x].tab_last)
           (*x)++;
         if (*x >= w)
           goto bad;
@@ -420,11 +420,11 @@ _txt_next_at(Termpty *ty, int *x, int *y, char *txt, int *txtlenp,
         txt[0] = '\t';
         return 0;
      }
-   if ((cell.codepoint == 0) || (cell.att.link_id))
+   if ((cell.codepoint == 0) || (TERMPTY_CELL_ATT(ty, &cell)->link_id))
      goto empty;
 
-   *txtlenp = codepoint_to_utf8(cell.codepoint, txt);
-   *codepointp = cell.codepoint;
+   *codepointp = termpty_codepoint_base(ty, cell.codepoint);
+   *txtlenp = codepoint_to_utf8(*codepointp, txt);
 
    return 0;
 
@@ -468,7 +468,7 @@ termio_link_find(const Evas_Object *obj, int cx, int cy,
 
    sc = termio_scroll_get(obj);
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(ty);
 
    y1 -= sc;
    y2 -= sc;
@@ -677,7 +677,7 @@ out:
           }
      }
 end:
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(ty);
    ty_sb_free(&sb);
    return s;
 }
@@ -1424,7 +1424,7 @@ termio_color_find(const Evas_Object *obj, int cx, int cy,
 
    sc = termio_scroll_get(obj);
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(ty);
 
    y1 -= sc;
    y2 -= sc;
@@ -1519,7 +1519,7 @@ termio_color_find(const Evas_Object *obj, int cx, int cy,
    found = EINA_TRUE;
 
 end:
-   termpty_backlog_unlock();
+   termpty_backlog_unlock(ty);
    ty_sb_free(&sb);
    if (found)
      {
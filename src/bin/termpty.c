@@ -8,6 +8,7 @@
 #include "termptyops.h"
 #include "backlog.h"
 #include "keyin.h"
+#include "utf8.h"
 #if !defined(BINARY_TYFUZZ) && !defined(BINARY_TYTEST)
 # include "win.h"
 #endif
@@ -23,6 +24,7 @@
 #include <errno.h>
 #include <unistd.h>
 #include <termios.h>
+#include <poll.h>
 #if defined (__sun) || defined (__sun__)
 # include <stropts.h>
 #endif
@@ -51,16 +53,139 @@ termpty_init(void)
    _termpty_log_dom = eina_log_domain_register("termpty", NULL);
    if (_termpty_log_dom < 0)
      EINA_LOG_CRIT("Could not create logging domain '%s'", "termpty");
+   termpty_backlog_init();
 }
 
 void
 termpty_shutdown(void)
 {
    if (_termpty_log_dom < 0) return;
+   termpty_backlog_shutdown();
    eina_log_domain_unregister(_termpty_log_dom);
    _termpty_log_dom = -1;
 }
 
+/* When a terminal has a reader thread, the parser runs in it with the lock
+ * of the terminal held.  The few calls it makes to the user interface have
+ * to be enclosed in these, so that they happen while the main loop is
+ * paused:
+ *
+ *    if (termpty_main_loop_begin(ty))
+ *      {
+ *         ...
+ *         termpty_main_loop_end(ty);
+ *      }
+ *
+ * The lock is dropped while waiting for the main loop, as the main loop may
+ * be waiting on it, however many times the parser took it.  Once the
+ * terminal is being freed, the reader thread no longer waits for the main
+ * loop and this returns EINA_FALSE */
+Eina_Bool
+termpty_main_loop_begin(Termpty *ty)
+{
+   int depth;
+
+   if (eina_main_loop_is())
+     return EINA_TRUE;
+   if (ty->freeing)
+     return EINA_FALSE;
+   depth = termpty_backlog_unlock_all(ty);
+   ecore_thread_main_loop_begin();
+   termpty_backlog_relock(ty, depth);
+   if (ty->freeing)
+     {
+        termpty_main_loop_end(ty);
+        return EINA_FALSE;
+     }
+   return EINA_TRUE;
+}
+
+void
+termpty_main_loop_end(Termpty *ty)
+{
+   int depth;
+
+   if (eina_main_loop_is())
+     return;
+   depth = termpty_backlog_unlock_all(ty);
+   ecore_thread_main_loop_end();
+   termpty_backlog_relock(ty, depth);
+}
+
+static void
+_deferred_call(Termpty *ty, unsigned char what)
+{
+   if ((what & TERMPTY_DEFER_TITLE) && (ty->cb.set_title.func))
+     ty->cb.set_title.func(ty->cb.set_title.data);
+   if ((what & TERMPTY_DEFER_ICON) && (ty->cb.set_icon.func))
+     ty->cb.set_icon.func(ty->cb.set_icon.data);
+   if ((what & TERMPTY_DEFER_BELL) && (ty->cb.bell.func))
+     ty->cb.bell.func(ty->cb.bell.data);
+}
+
+/* Tells about the title, the icon or a bell, @what being made of
+ * TERMPTY_DEFER_*.  From the reader thread, it is left to the main loop, as
+ * termpty_scroll() does */
+void
+termpty_defer(Termpty *ty, unsigned char what)
+{
+   if (eina_main_loop_is())
+     _deferred_call(ty, what);
+   else
+     ty->deferred |= what;
+}
+
+/* From the main loop, with the lock held: the title and the icon may only
+ * change under it */
+static void
+_deferred_flush(Termpty *ty)
+{
+   unsigned char what = ty->deferred;
+
+   ty->deferred = 0;
+   _deferred_call(ty, what);
+}
+
+/* Lines from @start_y to @end_y scrolled by @direction.  The terminal
+ * object belongs to the main loop: from the reader thread, this is
+ * gathered for termpty_scroll_flush() */
+void
+termpty_scroll(Termpty *ty, int direction, int start_y, int end_y)
+{
+   if (eina_main_loop_is())
+     {
+        termpty_scroll_flush(ty);
+        termio_scroll(ty->obj, direction, start_y, end_y);
+        return;
+     }
+   if ((ty->scrolled.direction) &&
+       ((ty->scrolled.start_y != start_y) || (ty->scrolled.end_y != end_y) ||
+        ((ty->scrolled.direction < 0) != (direction < 0))))
+     {
+        if (termpty_main_loop_begin(ty))
+          {
+             termpty_scroll_flush(ty);
+             termpty_main_loop_end(ty);
+          }
+     }
+   ty->scrolled.direction += direction;
+   ty->scrolled.start_y = start_y;
+   ty->scrolled.end_y = end_y;
+}
+
+/* From the main loop, with the backlog lock held */
+void
+termpty_scroll_flush(Termpty *ty)
+{
+   int direction = ty->scrolled.direction;
+
+   if (!direction)
+     return;
+   ty->scrolled.direction = 0;
+   termio_scroll(ty->obj, direction, ty->scrolled.start_y,
+                 ty->scrolled.end_y);
+}
+
 
 Eina_Bool
 termpty_can_handle_key(const Termpty *ty,
@@ -81,134 +206,111 @@ termpty_can_handle_key(const Termpty *ty,
 
 
 
-void
-termpty_handle_buf(Termpty *ty, const Eina_Unicode *codepoints, int len)
+/* Bounds of config->pty_read_max */
+#define PTY_READ_MIN 4096
+#define PTY_READ_MAX (16 * 1024 * 1024)
+
+/* Once everything was parsed, give back what a burst of output or a long
+ * escape string made the buffers grow to */
+static void
+_handle_buf_trim(Termpty *ty)
 {
-   Eina_Unicode *c, *ce, *c2, *b, *d;
-   int n, bytes;
+   size_t keep = MAX(ty->readbuf.size, PTY_READ_MIN) + UTF8_SEQ_MAX + 1;
+
+   if (ty->bufsize > 2 * keep)
+     {
+        DBG("release %zu", ty->bufsize);
+        free(ty->buf);
+        ty->buf = NULL;
+        ty->bufsize = 0;
+     }
+   termpty_esc_strings_trim(ty);
+}
 
-   c = (Eina_Unicode *)codepoints;
-   ce = &(c[len]);
+/* Make room for len more codepoints (and a trailing nul) after the ones
+ * still waiting to be parsed. Returns where to write them */
+Eina_Unicode *
+termpty_handle_buf_reserve(Termpty *ty, int len)
+{
+   size_t need = ty->buflen + len + 1;
 
-   if (ty->buf)
+   if (need > ty->bufsize && ty->bufstart > 0)
+     {
+        ty->buflen -= ty->bufstart;
+        memmove(ty->buf, ty->buf + ty->bufstart,
+                ty->buflen * sizeof(Eina_Unicode));
+        ty->bufstart = 0;
+        need = ty->buflen + len + 1;
+     }
+   if (need > ty->bufsize)
      {
-        bytes = (ty->buflen + len + 1) * sizeof(int);
-        b = realloc(ty->buf, bytes);
+        size_t size = ty->bufsize * 2;
+        Eina_Unicode *b;
+
+        if (size < need)
+          size = need;
+        b = realloc(ty->buf, size * sizeof(Eina_Unicode));
         if (!b)
           {
              ERR(_("memerr: %s"), strerror(errno));
-             return;
-          }
-        DBG("realloc add %i + %i", (int)(ty->buflen * sizeof(int)), (int)(len * sizeof(int)));
-        if (!ty->buf_have_zero)
-          {
-             d = &(b[ty->buflen]);
-             ce = (Eina_Unicode *)codepoints + len;
-             for (c = (Eina_Unicode *)codepoints; c < ce; c++, d++)
-               {
-                  *d = *c;
-                  if (*c == 0x0)
-                    {
-                       ty->buf_have_zero = EINA_TRUE;
-                       break;
-                    }
-               }
-             for (; c < ce; c++, d++) *d = *c;
-          }
-        else
-          {
-             bytes = len * sizeof(Eina_Unicode);
-             memcpy(&(b[ty->buflen]), codepoints, bytes);
+             return NULL;
           }
+        DBG("realloc %zu -> %zu", ty->bufsize, size);
         ty->buf = b;
-        ty->buflen += len;
-        ty->buf[ty->buflen] = 0;
-        c = ty->buf;
-        ce = c + ty->buflen;
-        while (c < ce)
+        ty->bufsize = size;
+     }
+   return ty->buf + ty->buflen;
+}
+
+/* Parse the len codepoints written at the address given by
+ * termpty_handle_buf_reserve(). An incomplete sequence at the end is kept
+ * in place for the next call */
+void
+termpty_handle_buf(Termpty *ty, int len)
+{
+   Eina_Unicode *c, *ce;
+   const Eina_Unicode *checked;
+   int n;
+
+   ty->buflen += len;
+   ty->buf[ty->buflen] = 0;
+   c = ty->buf + ty->bufstart;
+   ce = ty->buf + ty->buflen;
+   if ((ty->parser.state != TERMPTY_PARSER_GROUND) &&
+       (!termpty_seq_ready(ty, c, &ce)))
+     {
+        ty->buflen = ce - ty->buf;
+        return;
+     }
+   ty->parser.state = TERMPTY_PARSER_GROUND;
+   checked = c;
+   /* the reader thread gives up on a terminal being freed */
+   while ((c < ce) && (!ty->freeing))
+     {
+        if ((c[0] == '\n') && (c >= checked))
           {
-             n = termpty_handle_seq(ty, c, ce);
-             if (n == 0)
+             n = termpty_text_flood(ty, c, ce, &checked);
+             if (n > 0)
                {
-                  Eina_Unicode *tmp = ty->buf;
-                  ty->buf = NULL;
-                  ty->buflen = 0;
-                  bytes = ((char *)ce - (char *)c) + sizeof(Eina_Unicode);
-                  DBG("malloc till %i", (int)(bytes - sizeof(Eina_Unicode)));
-                  ty->buf = malloc(bytes);
-                  if (!ty->buf)
-                    {
-                       ERR(_("memerr: %s"), strerror(errno));
-                       return;
-                    }
-                  ty->buf_have_zero = EINA_FALSE;
-                  for (d = ty->buf, c2 = c; c2 < ce; c2++, d++)
-                    {
-                       *d = *c2;
-                       if (*c2 == 0x0)
-                         {
-                            ty->buf_have_zero = EINA_TRUE;
-                            break;
-                         }
-                    }
-                  for (; c2 < ce; c2++, d++) *d = *c2;
-                  bytes = (char *)ce - (char *)c;
-                  ty->buflen = bytes / sizeof(Eina_Unicode);
-                  ty->buf[ty->buflen] = 0;
-                  free(tmp);
-                  break;
+                  c += n;
+                  continue;
                }
-             c += n;
           }
-        if (c == ce)
+        n = termpty_handle_seq(ty, c, ce);
+        if (n == 0)
           {
-             if (ty->buf)
-               {
-                  ty->buf_have_zero = EINA_FALSE;
-                  free(ty->buf);
-                  ty->buf = NULL;
-               }
-             ty->buflen = 0;
+             termpty_seq_pending(ty, c, ce);
+             break;
           }
+        c += n;
      }
-   else
+   if (c == ce)
      {
-        ty->buf_have_zero = EINA_TRUE;
-        while (c < ce)
-          {
-             n = termpty_handle_seq(ty, c, ce);
-             if (n == 0)
-               {
-                  bytes = ((char *)ce - (char *)c) + sizeof(Eina_Unicode);
-                  ty->buf_have_zero = EINA_FALSE;
-                  ty->buf = malloc(bytes);
-                  DBG("malloc %i", (int)(bytes - sizeof(Eina_Unicode)));
-                  if (!ty->buf)
-                    {
-                       ERR(_("memerr: %s"), strerror(errno));
-                    }
-                  else
-                    {
-                       ty->buf_have_zero = EINA_FALSE;
-                       for (d = ty->buf, c2 = c; c2 < ce; c2++, d++)
-                         {
-                            *d = *c2;
-                            if (*c2 == 0x0)
-                              {
-                                 ty->buf_have_zero = EINA_TRUE;
-                                 break;
-                              }
-                         }
-                       for (; c2 < ce; c2++, d++) *d = *c2;
-                       bytes = (char *)ce - (char *)c;
-                       ty->buflen = bytes / sizeof(Eina_Unicode);
-                       ty->buf[ty->buflen] = 0;
-                    }
-                  break;
-               }
-             c += n;
-          }
+        ty->bufstart = ty->buflen = 0;
+        _handle_buf_trim(ty);
      }
+   else
+     ty->bufstart = c - ty->buf;
 }
 
 static void
@@ -225,28 +327,57 @@ _pty_size(Termpty *ty)
        ERR(_("Size set ioctl failed: %s"), strerror(errno));
 }
 
+static Eina_Bool
+_readbuf_ensure(Termpty *ty)
+{
+   int size = ty->config ? ty->config->pty_read_max : 0;
+   char *bytes;
+
+   if (size <= 0)
+     size = CONFIG_PTY_READ_MAX_DEFAULT;
+   else if (size < PTY_READ_MIN)
+     size = PTY_READ_MIN;
+   else if (size > PTY_READ_MAX)
+     size = PTY_READ_MAX;
+   if (size == ty->readbuf.size)
+     return EINA_TRUE;
+
+   bytes = realloc(ty->readbuf.bytes, size);
+   if (!bytes)
+     goto err;
+   ty->readbuf.bytes = bytes;
+   ty->readbuf.size = size;
+   return EINA_TRUE;
+
+err:
+   ERR(_("memerr: %s"), strerror(errno));
+   /* keep using the previous buffers if any */
+   return ty->readbuf.size > 0;
+}
+
 static Eina_Bool
 _handle_read(Termpty *ty, Eina_Bool false_on_empty)
 {
-   int len, reads;
+   double t0, t, budget;
+   size_t total = 0;
+   int len = 0, reads;
+
+   if (!_readbuf_ensure(ty))
+     return ECORE_CALLBACK_RENEW;
+   budget = ty->config ? ty->config->pty_read_budget : 0.0;
+   if (budget <= 0.0)
+     budget = CONFIG_PTY_READ_BUDGET_DEFAULT;
 
-   // read up to 64 * 4096 bytes
-   for (reads = 0; reads < 64; reads++)
+   // read until there is nothing left or the time budget is exhausted
+   t0 = t = ecore_time_get();
+   for (reads = 0; (t - t0) < budget; reads++)
      {
-        Eina_Unicode codepoint[4097];
-        char buf[4097];
-        char *rbuf = buf;
-        int i, j;
-        len = sizeof(buf) - 1;
+        Eina_Unicode *codepoint;
+        char *buf = ty->readbuf.bytes;
+        int j;
 
-        for (i = 0; i < (int)sizeof(ty->oldbuf) && ty->oldbuf[i] & 0x80; i++)
-          {
-             *rbuf = ty->oldbuf[i];
-             rbuf++;
-             len--;
-          }
         errno = 0;
-        len = read(ty->fd, rbuf, len);
+        len = read(ty->fd, buf, ty->readbuf.size);
         if ((len < 0 && !(errno == EAGAIN || errno == EINTR)) ||
             (len == 0 && errno != 0))
           {
@@ -255,6 +386,9 @@ _handle_read(Termpty *ty, Eina_Bool false_on_empty)
                {
                   ERR("error while reading from tty slave fd: %s", strerror(errno));
                }
+             /* the reader thread leaves closing to the main loop */
+             if (!eina_main_loop_is())
+               return ECORE_CALLBACK_CANCEL;
              close(ty->fd);
              ty->fd = -1;
              if (ty->hand_fd)
@@ -263,11 +397,7 @@ _handle_read(Termpty *ty, Eina_Bool false_on_empty)
              return ECORE_CALLBACK_CANCEL;
           }
         if (len <= 0) break;
-
-        for (i = 0; i < (int)sizeof(ty->oldbuf); i++)
-          ty->oldbuf[i] = 0;
-
-        len += rbuf - buf;
+        total += len;
 
         /*
         printf(" I: ");
@@ -281,45 +411,22 @@ _handle_read(Termpty *ty, Eina_Bool false_on_empty)
           }
         printf("\n");
         */
-        buf[len] = 0;
-        // convert UTF8 to codepoint integers
-        j = 0;
-        for (i = 0; i < len;)
+        termpty_backlog_lock(ty);
+        // convert UTF8 to codepoint integers, straight into the parser buffer
+        codepoint = termpty_handle_buf_reserve(ty, len + UTF8_SEQ_MAX);
+        if (codepoint)
           {
-             Eina_Unicode g = 0, prev_i = i;
-
-             if (buf[i])
-               {
-                  g = eina_unicode_utf8_next_get(buf, &i);
-                  if ((0xdc80 <= g) && (g <= 0xdcff) &&
-                      (len - (int)prev_i) <= (int)sizeof(ty->oldbuf))
-                    {
-                       unsigned int k;
-
-                       for (k = 0;
-                            (k < (unsigned int)sizeof(ty->oldbuf)) &&
-                            (k < (unsigned int)(len - prev_i));
-                            k++)
-                         {
-                            ty->oldbuf[k] = buf[prev_i+k];
-                         }
-                       DBG("failure at %d/%d/%d", (int)prev_i, (int)i, len);
-                       break;
-                    }
-               }
-             else
-               {
-                  g = 0;
-                  i++;
-               }
-             codepoint[j] = g;
-             j++;
+             j = utf8_decode(&ty->utf8, buf, len, codepoint);
+//             DBG("---------------- handle buf %i", j);
+             termpty_handle_buf(ty, j);
           }
-        codepoint[j] = 0;
-//        DBG("---------------- handle buf %i", j);
-        termpty_handle_buf(ty, codepoint, j);
+        termpty_backlog_unlock(ty);
+        t = ecore_time_get();
      }
-   if (ty->cb.change.func)
+   if (total)
+     DBG("read %zu bytes in %i reads, %.3fms", total, reads, (t - t0) * 1000.0);
+   /* the reader thread notifies the main loop on its own */
+   if ((ty->cb.change.func) && (eina_main_loop_is()))
      ty->cb.change.func(ty->cb.change.data);
 #if defined(BINARY_TYFUZZ) || defined(BINARY_TYTEST)
    if (len <= 0)
@@ -346,28 +453,48 @@ _handle_read(Termpty *ty, Eina_Bool false_on_empty)
    return ECORE_CALLBACK_RENEW;
 }
 
+/* Only to be called from the main loop */
+static void
+_fd_handler_flags_update(Termpty *ty)
+{
+   Ecore_Fd_Handler_Flags flags = ECORE_FD_ERROR;
+
+   if (!ty->hand_fd)
+     return;
+   if (!ty->reader)
+     flags |= ECORE_FD_READ;
+   if (ty->write_buffer.len)
+     flags |= ECORE_FD_WRITE;
+   ecore_main_fd_handler_active_set(ty->hand_fd, flags);
+}
+
 static Eina_Bool
 _handle_write(Termpty *ty)
 {
    struct ty_sb *sb = &ty->write_buffer;
    ssize_t len;
 
+   termpty_backlog_lock(ty);
    if (!sb->len)
-     return ECORE_CALLBACK_RENEW;
+     {
+        termpty_backlog_unlock(ty);
+        return ECORE_CALLBACK_RENEW;
+     }
 
    len = write(ty->fd, sb->buf, sb->len);
    if (len < 0 && (errno != EINTR && errno != EAGAIN))
      {
         ERR(_("Could not write to file descriptor %d: %s"),
             ty->fd, strerror(errno));
+        termpty_backlog_unlock(ty);
         return ECORE_CALLBACK_CANCEL;
      }
-   ty_sb_lskip(sb, len);
+   if (len > 0)
+     ty_sb_lskip(sb, len);
 
-   if (!sb->len && ty->hand_fd)
-     ecore_main_fd_handler_active_set(ty->hand_fd,
-                                      ECORE_FD_ERROR |
-                                      ECORE_FD_READ);
+   if (!sb->len && eina_main_loop_is())
+     _fd_handler_flags_update(ty);
+   termpty_backlog_unlock(ty);
 
    return ECORE_CALLBACK_RENEW;
 }
@@ -407,9 +534,213 @@ _fd_do(Termpty *ty, Ecore_Fd_Handler *fd_handler, Eina_Bool false_on_empty)
    return ECORE_CALLBACK_PASS_ON;
 }
 
+/* Reader thread {{{ */
+
+static void _termpty_free(Termpty *ty);
+
+static void
+_reader_wake(Termpty *ty, char why)
+{
+   if (write(ty->reader_wake[1], &why, 1) < 0)
+     ERR("could not wake up reader thread: %s", strerror(errno));
+}
+
+static void
+_reader_run(void *data, Ecore_Thread *thread)
+{
+   Termpty *ty = data;
+   Eina_Bool drain = EINA_FALSE;
+
+   while (!ecore_thread_check(thread))
+     {
+        struct pollfd fds[2];
+        Eina_Bool keep, notify;
+
+        fds[0].fd = ty->fd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = ty->reader_wake[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        if ((!drain) && (poll(fds, 2, -1) < 0))
+          {
+             if (errno == EINTR)
+               continue;
+             ERR("poll() on tty failed: %s", strerror(errno));
+             break;
+          }
+        if (fds[1].revents & POLLIN)
+          {
+             char why;
+
+             /* 'q' is sent on cancel, 'd' once the child has exited */
+             while (read(ty->reader_wake[0], &why, 1) == 1)
+               {
+                  if (why == 'd')
+                    drain = EINA_TRUE;
+               }
+             if (ecore_thread_check(thread))
+               break;
+          }
+
+        keep = _handle_read(ty, drain);
+        _handle_write(ty);
+
+        termpty_backlog_lock(ty);
+        notify = !ty->reader_notified;
+        ty->reader_notified = EINA_TRUE;
+        termpty_backlog_unlock(ty);
+        if (notify)
+          ecore_thread_feedback(thread, NULL);
+
+        if (!keep)
+          break;
+     }
+}
+
+static void
+_reader_stopped(Termpty *ty)
+{
+   ty->reader = NULL;
+   close(ty->reader_wake[0]);
+   close(ty->reader_wake[1]);
+   ty->reader_wake[0] = -1;
+   ty->reader_wake[1] = -1;
+}
+
+static void
+_reader_notify(void *data,
+               Ecore_Thread *thread EINA_UNUSED,
+               void *msg EINA_UNUSED)
+{
+   Termpty *ty = data;
+
+   if (ty->freeing)
+     return;
+   termpty_backlog_lock(ty);
+   ty->reader_notified = EINA_FALSE;
+   termpty_scroll_flush(ty);
+   _deferred_flush(ty);
+   /* replies to the application may not have been fully written */
+   _fd_handler_flags_update(ty);
+   termpty_backlog_unlock(ty);
+
+   if (ty->cb.change.func)
+     ty->cb.change.func(ty->cb.change.data);
+}
+
+static void
+_reader_end(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Termpty *ty = data;
+
+   _reader_stopped(ty);
+   /* left to us by termpty_free() */
+   if (ty->freeing)
+     {
+        _termpty_free(ty);
+        return;
+     }
+
+   if (ty->hand_fd)
+     ecore_main_fd_handler_del(ty->hand_fd);
+   ty->hand_fd = NULL;
+   if (ty->fd >= 0)
+     close(ty->fd);
+   ty->fd = -1;
+
+   termpty_backlog_lock(ty);
+   termpty_scroll_flush(ty);
+   _deferred_flush(ty);
+   termpty_backlog_unlock(ty);
+   if (ty->cb.change.func)
+     ty->cb.change.func(ty->cb.change.data);
+
+   /* The child has exited and everything it wrote has been read */
+   if (ty->pid == -1)
+     {
+        if (ty->slavefd >= 0)
+          close(ty->slavefd);
+        ty->slavefd = -1;
+
+        if (ty->cb.exited.func)
+          ty->cb.exited.func(ty->cb.exited.data);
+     }
+}
+
+static void
+_reader_cancel(void *data, Ecore_Thread *thread EINA_UNUSED)
+{
+   Termpty *ty = data;
+
+   _reader_stopped(ty);
+   if (ty->freeing)
+     _termpty_free(ty);
+}
+
+static void
+_reader_start(Termpty *ty)
+{
+   int i;
+
+   if (pipe(ty->reader_wake) < 0)
+     {
+        ERR(_("Function %s failed: %s"), "pipe()", strerror(errno));
+        ty->threaded = EINA_FALSE;
+        return;
+     }
+   for (i = 0; i < 2; i++)
+     {
+        if ((fcntl(ty->reader_wake[i], F_SETFL, O_NONBLOCK) < 0) ||
+            (fcntl(ty->reader_wake[i], F_SETFD, FD_CLOEXEC) < 0))
+          ERR(_("Function %s failed: %s"), "fcntl()", strerror(errno));
+     }
+
+   ty->reader = ecore_thread_feedback_run(_reader_run, _reader_notify,
+                                          _reader_end, _reader_cancel,
+                                          ty, EINA_TRUE);
+   if (!ty->reader)
+     {
+        ERR("could not start reader thread, reading from the main loop");
+        _reader_stopped(ty);
+        ty->threaded = EINA_FALSE;
+        return;
+     }
+   _fd_handler_flags_update(ty);
+}
+
+/* Cancels the reader thread of @ty, for termpty_free().  It is not waited
+ * for, as it may be waiting for the main loop in termpty_main_loop_begin():
+ * once it is over, _reader_cancel() or _reader_end() frees @ty.  Returns
+ * whether it is over already */
+static Eina_Bool
+_reader_stop(Termpty *ty)
+{
+   ecore_thread_cancel(ty->reader);
+   /* it was cancelled before it even started */
+   if (!ty->reader)
+     return EINA_TRUE;
+   termpty_backlog_lock(ty);
+   ty->freeing = EINA_TRUE;
+   termpty_backlog_unlock(ty);
+   _reader_wake(ty, 'q');
+   return EINA_FALSE;
+}
+
+/* }}} */
+
 static Eina_Bool
 _cb_fd(void *data, Ecore_Fd_Handler *fd_handler)
 {
+   Termpty *ty = data;
+
+   /* Hand the tty over to a reader thread once the terminal is set up */
+   if ((ty->threaded) && (!ty->reader) && (ty->obj) && (ty->fd >= 0))
+     {
+        _reader_start(ty);
+        if (ty->reader)
+          return ECORE_CALLBACK_RENEW;
+     }
    return _fd_do(data, fd_handler, EINA_FALSE);
 }
 
@@ -433,6 +764,14 @@ _cb_exe_exit(void *data,
      ecore_event_handler_del(ty->hand_exe_exit);
    ty->hand_exe_exit = NULL;
 
+   /* The reader thread reads everything till the end then reports the
+    * exit */
+   if (ty->reader)
+     {
+        _reader_wake(ty, 'd');
+        return ECORE_CALLBACK_PASS_ON;
+     }
+
    /* Read everything till the end */
    res = ECORE_CALLBACK_PASS_ON;
    while (ty->hand_fd && res != ECORE_CALLBACK_CANCEL)
@@ -470,6 +809,14 @@ _limit_coord(Termpty *ty)
    TERMPTY_RESTRICT_FIELD(ty->cursor_save[0].cy, 0, ty->h);
    TERMPTY_RESTRICT_FIELD(ty->cursor_save[1].cx, 0, ty->w);
    TERMPTY_RESTRICT_FIELD(ty->cursor_save[1].cy, 0, ty->h);
+
+   /* the rows of a scrolling region must all be on the screen */
+   if ((ty->termstate.bottom_margin > ty->h) ||
+       (ty->termstate.top_margin >= ty->h))
+     {
+        ty->termstate.top_margin = 0;
+        ty->termstate.bottom_margin = 0;
+     }
 }
 
 void
@@ -549,6 +896,14 @@ termpty_new(const char *cmd, Eina_Bool login_shell, const char *cd,
    ty = calloc(1, sizeof(Termpty));
    if (!ty) return NULL;
    ty->config = config;
+   ty->threaded = config->threaded_pty;
+   ty->reader_wake[0] = -1;
+   ty->reader_wake[1] = -1;
+   if (!termpty_backlog_lock_new(ty))
+     {
+        free(ty);
+        return NULL;
+     }
    ty->w = w;
    ty->h = h;
    ty->backsize = config->scrollback;
@@ -568,6 +923,13 @@ termpty_new(const char *cmd, Eina_Bool login_shell, const char *cd,
         goto err;
      }
 
+   if (!termpty_rows_init(ty))
+     {
+        ERR("Allocation of term %s failed: %s",
+            "rows", strerror(errno));
+        goto err;
+     }
+
    ty->hl.bitmap = calloc(1, HL_LINKS_MAX / 8); /* bit map for 1 << 16 elements */
    if (!ty->hl.bitmap)
      {
@@ -578,6 +940,25 @@ termpty_new(const char *cmd, Eina_Bool login_shell, const char *cd,
    /* Mark id 0 as set */
    ty->hl.bitmap[0] = 1;
 
+   if (!termpty_atts_init(ty))
+     {
+        ERR("Allocation of term %s failed: %s",
+            "attributes", strerror(errno));
+        goto err;
+     }
+   if (!termpty_clusters_init(ty))
+     {
+        ERR("Allocation of term %s failed: %s",
+            "clusters", strerror(errno));
+        goto err;
+     }
+   if (!termpty_row_flags_reset(ty))
+     {
+        ERR("Allocation of term %s failed: %s",
+            "row flags", strerror(errno));
+        goto err;
+     }
+
    termpty_resize_tabs(ty, 0, w);
 
    termpty_reset_state(ty);
@@ -822,29 +1203,46 @@ termpty_new(const char *cmd, Eina_Bool login_shell, const char *cd,
 err:
    free(ty->screen);
    free(ty->screen2);
+   free(ty->rows);
+   free(ty->rows2);
    free(ty->hl.bitmap);
+   termpty_atts_shutdown(ty);
+   termpty_clusters_shutdown(ty);
+   free(ty->row_flags);
+   free(ty->row_flags2);
    if (ty->fd >= 0) close(ty->fd);
    if (ty->slavefd >= 0) close(ty->slavefd);
+   termpty_backlog_lock_free(ty);
    free(ty);
    return NULL;
 }
 
+/* What the reader thread of @ty does not use, freed at once */
 void
 termpty_free(Termpty *ty)
 {
    Termexp *ex;
-
+   Termpty_Cache_Stats stats;
+
+   termpty_sgr_cache_stats_get(ty, &stats);
+   DBG("SGR cache: %lu hits, %lu misses", stats.hits, stats.misses);
+   termpty_tcc_stats_get(ty, &stats);
+   DBG("truecolor cache: %lu hits, %lu misses, %lu evictions",
+       stats.hits, stats.misses, stats.evictions);
+   DBG("exact truecolors: %d in use, %lu collections",
+       ty->truecolor.count, ty->truecolor.collections);
+   DBG("attributes: %u ids, %lu collections",
+       ty->atts.used, ty->atts.collections);
    termpty_save_unregister(ty);
+   termpty_backlog_lock(ty);
    EINA_LIST_FREE(ty->block.expecting, ex) free(ex);
    if (ty->block.blocks) eina_hash_free(ty->block.blocks);
+   ty->block.blocks = NULL;
    if (ty->block.chid_map) eina_hash_free(ty->block.chid_map);
+   ty->block.chid_map = NULL;
    if (ty->block.active) eina_list_free(ty->block.active);
-   if (ty->fd >= 0)
-     {
-        close(ty->fd);
-        ty->fd = -1;
-     }
-   if (ty->slavefd >= 0) close(ty->slavefd);
+   ty->block.active = NULL;
+   termpty_backlog_unlock(ty);
    if (ty->pid >= 0)
      {
         int i;
@@ -882,14 +1280,42 @@ termpty_free(Termpty *ty)
      }
    if (ty->hand_exe_exit)
      ecore_event_handler_del(ty->hand_exe_exit);
+   ty->hand_exe_exit = NULL;
    if (ty->hand_fd)
      ecore_main_fd_handler_del(ty->hand_fd);
+   ty->hand_fd = NULL;
+   /* the rest once the reader thread is over */
+   if ((ty->reader) && (!_reader_stop(ty)))
+     return;
+   _termpty_free(ty);
+}
+
+static void
+_termpty_free(Termpty *ty)
+{
+   if (ty->fd >= 0)
+     {
+        close(ty->fd);
+        ty->fd = -1;
+     }
+   if (ty->slavefd >= 0) close(ty->slavefd);
    eina_stringshare_del(ty->prop.title);
    eina_stringshare_del(ty->prop.user_title);
    eina_stringshare_del(ty->prop.icon);
    termpty_backlog_free(ty);
+   free(ty->readbuf.bytes);
+   free(ty->esc_str.buf);
+   colors_lut_free(ty->color_lut);
+   free(ty->truecolor.colors);
+   free(ty->truecolor.hash);
+   if (ty->osc52.data)
+     eina_binbuf_free(ty->osc52.data);
    free(ty->screen);
    free(ty->screen2);
+   free(ty->rows);
+   free(ty->rows2);
+   free(ty->row_flags);
+   free(ty->row_flags2);
    if (ty->hl.links)
      {
         uint16_t i;
@@ -903,9 +1329,12 @@ termpty_free(Termpty *ty)
        free(ty->hl.links);
      }
    free(ty->hl.bitmap);
+   termpty_atts_shutdown(ty);
+   termpty_clusters_shutdown(ty);
    free(ty->buf);
    free(ty->tabs);
    ty_sb_free(&ty->write_buffer);
+   termpty_backlog_lock_free(ty);
    free(ty);
 }
 
@@ -916,17 +1345,38 @@ termpty_config_update(Termpty *ty, Config *config)
    termpty_backlog_size_set(ty, config->scrollback);
 }
 
+Eina_Bool
+termpty_sync_output_held(Termpty *ty)
+{
+   Eina_Bool held;
+
+   termpty_backlog_lock(ty);
+   if ((ty->sync_output.active) &&
+       (ecore_time_get() - ty->sync_output.start >
+        TERMPTY_SYNC_OUTPUT_TIMEOUT))
+     {
+        DBG("synchronized output timed out");
+        ty->sync_output.active = EINA_FALSE;
+     }
+   held = ty->sync_output.active;
+   termpty_backlog_unlock(ty);
+   return held;
+}
+
 static Eina_Bool
-_termpty_cell_is_empty(const Termcell *cell)
+_termpty_cell_is_empty(const Termpty *ty, const Termcell *cell)
 {
+   const Termatt *att = TERMPTY_CELL_ATT(ty, cell);
+
    return ((cell->codepoint == 0) ||
-           (cell->att.invisible) ||
-           ((cell->att.fg256 == 0) && (cell->att.fg == COL_INVIS))) &&
-      (((cell->att.bg256 == 0) && (cell->att.bg == COL_INVIS)) || (cell->att.bg == COL_DEF));
+           (att->invisible) ||
+           ((att->fg256 == 0) && (att->fg == COL_INVIS))) &&
+      (((att->bg256 == 0) && (att->bg == COL_INVIS)) || (att->bg == COL_DEF));
 }
 
 static Eina_Bool
-_termpty_line_is_empty(const Termcell *cells, ssize_t nb_cells)
+_termpty_line_is_empty(const Termpty *ty, const Termcell *cells,
+                       ssize_t nb_cells)
 {
    ssize_t len;
 
@@ -934,7 +1384,7 @@ _termpty_line_is_empty(const Termcell *cells, ssize_t nb_cells)
      {
         const Termcell *cell = cells + len;
 
-        if (!_termpty_cell_is_empty(cell))
+        if (!_termpty_cell_is_empty(ty, cell))
           return EINA_FALSE;
      }
 
@@ -943,7 +1393,8 @@ _termpty_line_is_empty(const Termcell *cells, ssize_t nb_cells)
 
 
 ssize_t
-termpty_line_length(const Termcell *cells, ssize_t nb_cells)
+termpty_line_length(const Termpty *ty, const Termcell *cells,
+                    ssize_t nb_cells)
 {
    ssize_t len;
 
@@ -954,7 +1405,7 @@ termpty_line_length(const Termcell *cells, ssize_t nb_cells)
      {
         const Termcell *cell = cells + len;
 
-        if (!_termpty_cell_is_empty(cell))
+        if (!_termpty_cell_is_empty(ty, cell))
           return len + 1;
      }
 
@@ -962,6 +1413,45 @@ termpty_line_length(const Termcell *cells, ssize_t nb_cells)
 }
 
 
+/* Account for the line just saved at ty->backpos, then unlocks the backlog */
+static void
+_text_save_added(Termpty *ty)
+{
+   ty->backpos++;
+   if (ty->backpos >= ty->backsize)
+     ty->backpos = 0;
+   termpty_backlog_line_added(ty);
+   termpty_backlog_unlock(ty);
+
+   ty->backlog_beacon.screen_y++;
+   ty->backlog_beacon.backlog_y++;
+   if (ty->backlog_beacon.backlog_y >= (int)ty->backsize)
+     {
+        ty->backlog_beacon.screen_y = 0;
+        ty->backlog_beacon.backlog_y = 0;
+     }
+}
+
+/* The @w first cells of a row holding @n codepoints written as @text over
+ * @blank ones, all but the last marked autowrapped as they are once saved */
+static void
+_text_line_compose(Termcell *cells, const Termcell *blank,
+                   const Termcell *text, const Eina_Unicode *codepoints,
+                   int n, ssize_t w)
+{
+   ssize_t i;
+
+   for (i = 0; (i < w) && (i < n); i++)
+     {
+        cells[i] = *text;
+        cells[i].codepoint = codepoints[i];
+     }
+   for (; i < w; i++)
+     cells[i] = *blank;
+   for (i = 0; i < w - 1; i++)
+     cells[i].autowrapped = 1;
+}
+
 void
 termpty_text_save_top(Termpty *ty, Termcell *cells, ssize_t w_max)
 {
@@ -972,25 +1462,28 @@ termpty_text_save_top(Termpty *ty, Termcell *cells, ssize_t w_max)
      return;
    assert(ty->back);
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(ty);
 
-   w = termpty_line_length(cells, w_max);
+   w = termpty_line_length(ty, cells, w_max);
    for (i = 0; i < w - 1; i++)
      {
-        cells[i].att.autowrapped = 1;
+        cells[i].autowrapped = 1;
      }
    if (ty->backsize > 0)
      {
         ts = BACKLOG_ROW_GET(ty, 1);
         if (!ts->cells)
           goto add_new_ts;
-        /* TODO: RESIZE uncompress ? */
-        if (ts->w && ts->cells[ts->w - 1].att.autowrapped)
+        ts = termpty_save_extract(ty, ts);
+        /* a line too long goes on in a new one */
+        if (ts && ts->w && ts->cells[ts->w - 1].autowrapped
+            && (ts->w + w <= TERMPTY_SAVE_W_MAX))
           {
              int old_len = ts->w;
              termpty_save_expand(ty, ts, cells, w);
              ty->backlog_beacon.screen_y += DIV_ROUND_UP(ts->w, ty->w)
                                           - DIV_ROUND_UP(old_len, ty->w);
+             termpty_backlog_unlock(ty);
              return;
           }
      }
@@ -999,20 +1492,78 @@ add_new_ts:
    ts = BACKLOG_ROW_GET(ty, 0);
    ts = termpty_save_new(ty, ts, w);
    if (!ts)
-     return;
+     {
+        termpty_backlog_unlock(ty);
+        return;
+     }
    TERMPTY_CELL_COPY(ty, cells, ts->cells, w);
-   ty->backpos++;
-   if (ty->backpos >= ty->backsize)
-     ty->backpos = 0;
-   termpty_backlog_unlock();
+   ts->flags = termpty_rows_flags(ty, cells, w);
+   _text_save_added(ty);
+}
 
-   ty->backlog_beacon.screen_y++;
-   ty->backlog_beacon.backlog_y++;
-   if (ty->backlog_beacon.backlog_y >= (int)ty->backsize)
+/* Save @n plain single width codepoints as termpty_text_save_top() would
+ * once written with the current attributes on a cleared row, composing the
+ * line in the backlog without going through the screen */
+void
+termpty_text_save_codepoints(Termpty *ty, const Eina_Unicode *codepoints,
+                             int n)
+{
+   Termatt att = ty->termstate.att;
+   Termcell blank, text;
+   Termsave *ts;
+   ssize_t w;
+
+   if (ty->backsize == 0)
+     return;
+   assert(ty->back);
+
+   /* what termpty_cells_clear() and then termpty_text_append() put there */
+   memset(&blank, 0, sizeof(blank));
+   att.link_id = 0;
+   termpty_cell_att_set(ty, &blank, &att);
+   memset(&text, 0, sizeof(text));
+   text.codepoint = ' ';
+   att.dblwidth = 0;
+   termpty_cell_att_set(ty, &text, &att);
+   if (!_termpty_cell_is_empty(ty, &blank))
+     w = ty->w;
+   else if ((n > 0) && (!_termpty_cell_is_empty(ty, &text)))
+     w = n;
+   else
+     w = 0;
+
+   termpty_backlog_lock(ty);
+
+   ts = BACKLOG_ROW_GET(ty, 1);
+   if (ts->cells)
+     ts = termpty_save_extract(ty, ts);
+   else
+     ts = NULL;
+   if (ts && ts->w && ts->cells[ts->w - 1].autowrapped
+       && (ts->w + w <= TERMPTY_SAVE_W_MAX))
      {
-        ty->backlog_beacon.screen_y = 0;
-        ty->backlog_beacon.backlog_y = 0;
+        int old_len = ts->w;
+
+        if (termpty_save_expand(ty, ts, NULL, w))
+          {
+             _text_line_compose(ts->cells + old_len, &blank, &text,
+                                codepoints, n, w);
+             ty->backlog_beacon.screen_y += DIV_ROUND_UP(ts->w, ty->w)
+                                          - DIV_ROUND_UP(old_len, ty->w);
+             termpty_backlog_unlock(ty);
+             return;
+          }
+        /* the line could not grow, the text goes in a new one */
      }
+
+   ts = termpty_save_new(ty, BACKLOG_ROW_GET(ty, 0), w);
+   if (!ts)
+     {
+        termpty_backlog_unlock(ty);
+        return;
+     }
+   _text_line_compose(ts->cells, &blank, &text, codepoints, n, w);
+   _text_save_added(ty);
 }
 
 
@@ -1025,127 +1576,80 @@ termpty_row_length(Termpty *ty, int y)
    if (!cells)
      return 0;
    if (y >= 0)
-     return termpty_line_length(cells, ty->w);
+     return termpty_line_length(ty, cells, ty->w);
    return wret;
 }
 
 void
 termpty_backscroll_adjust(Termpty *ty, int *scroll)
 {
-   int backlog_y = ty->backlog_beacon.backlog_y;
-   int screen_y = ty->backlog_beacon.screen_y;
+   Backlog_Beacon *beacon = &ty->backlog_beacon;
+   size_t lines, y;
 
    if ((ty->backsize == 0) || (*scroll <= 0))
      {
         *scroll = 0;
         return;
      }
-   if (*scroll < screen_y)
+   if (*scroll < beacon->screen_y)
      {
         return;
      }
 
-   backlog_y++;
-   while (42)
+   lines = termpty_backlog_lines_get(ty);
+   if ((size_t)beacon->backlog_y >= lines)
      {
-        int nb_lines;
-        Termsave *ts;
-
-        ts = BACKLOG_ROW_GET(ty, backlog_y);
-        if (!ts->cells || backlog_y >= (int)ty->backsize)
-          {
-             *scroll = ty->backlog_beacon.screen_y;
-             return;
-          }
-        nb_lines = (ts->w == 0) ? 1 : DIV_ROUND_UP(ts->w, ty->w);
-        screen_y += nb_lines;
-        ty->backlog_beacon.screen_y = screen_y;
-        ty->backlog_beacon.backlog_y = backlog_y;
-        backlog_y++;
-        if (*scroll <= screen_y)
-          {
-             return;
-          }
+        *scroll = beacon->screen_y;
+        return;
      }
+   /* the beacon goes up to the line at @scroll, or to the oldest one */
+   y = termpty_backlog_line_find(ty, *scroll);
+   if (y == 0)
+     y = lines;
+   else if (y <= (size_t)beacon->backlog_y)
+     y = beacon->backlog_y + 1;
+   beacon->backlog_y = y;
+   beacon->screen_y = termpty_backlog_rows_get(ty, y);
+   if (*scroll > beacon->screen_y)
+     *scroll = beacon->screen_y;
 }
 
 /* @requested_y unit is in visual lines on the screen */
 static Termcell*
-_termpty_cellrow_from_beacon_get(Termpty *ty, int requested_y, ssize_t *wret)
+_termpty_cellrow_from_backlog_get(Termpty *ty, int requested_y, ssize_t *wret)
 {
-   int backlog_y = ty->backlog_beacon.backlog_y;
-   int screen_y = ty->backlog_beacon.screen_y;
+   Backlog_Beacon *beacon = &ty->backlog_beacon;
    Termsave *ts;
-   int nb_lines;
-   int first_loop = EINA_TRUE;
+   Termcell *cells;
+   size_t y;
+   int delta;
 
    requested_y = -requested_y;
 
-   /* check if going from 0,0 is faster than using the beacon */
-   if (screen_y - requested_y > requested_y)
-     {
-        ty->backlog_beacon.backlog_y = 0;
-        ty->backlog_beacon.screen_y = 0;
-     }
-
-   /* going upward */
-   while (requested_y >= screen_y)
-     {
-        ts = BACKLOG_ROW_GET(ty, backlog_y);
-        if (!ts->cells || backlog_y >= (int)ty->backsize)
-          {
-             return NULL;
-          }
-        nb_lines = (ts->w == 0) ? 1 : DIV_ROUND_UP(ts->w, ty->w);
-
-        /* Only update the beacon if working on different line than the one
-         * from the beacon */
-        if (!first_loop)
-          {
-             screen_y += nb_lines;
-             ty->backlog_beacon.screen_y = screen_y;
-             ty->backlog_beacon.backlog_y = backlog_y;
-          }
-
-        if ((screen_y - nb_lines < requested_y) && (requested_y <= screen_y))
-          {
-             /* found the line */
-             int delta = screen_y - requested_y;
-             *wret = ts->w - delta * ty->w;
-             if (*wret > ty->w)
-               *wret = ty->w;
-             return &ts->cells[delta * ty->w];
-          }
-        backlog_y++;
-        first_loop = EINA_FALSE;
-     }
-   /* else, going downward */
-   while (requested_y <= screen_y)
+   y = termpty_backlog_line_find(ty, requested_y);
+   if (y == 0)
      {
-        ts = BACKLOG_ROW_GET(ty, backlog_y);
-        if (!ts->cells)
+        /* above the oldest line, where the beacon stops */
+        y = termpty_backlog_lines_get(ty);
+        if (y > (size_t)beacon->backlog_y)
           {
-             return NULL;
+             beacon->backlog_y = y;
+             beacon->screen_y = termpty_backlog_rows_get(ty, y);
           }
-        nb_lines = (ts->w == 0) ? 1 : DIV_ROUND_UP(ts->w, ty->w);
-
-        ty->backlog_beacon.screen_y = screen_y;
-        ty->backlog_beacon.backlog_y = backlog_y;
-
-        if ((screen_y - nb_lines < requested_y) && (requested_y <= screen_y))
-          {
-             /* found the line */
-             int delta = screen_y - requested_y;
-             *wret = ts->w - delta * ty->w;
-             if (*wret > ty->w)
-               *wret = ty->w;
-             return &ts->cells[delta * ty->w];
-          }
-        screen_y -= nb_lines;
-        backlog_y--;
+        return NULL;
      }
+   beacon->backlog_y = y;
+   beacon->screen_y = termpty_backlog_rows_get(ty, y);
 
-   return NULL;
+   ts = BACKLOG_ROW_GET(ty, y);
+   delta = beacon->screen_y - requested_y;
+   cells = termpty_save_cells_get(ty, ts);
+   if (!cells)
+     return NULL;
+   *wret = ts->w - delta * ty->w;
+   if (*wret > ty->w)
+     *wret = ty->w;
+   return &cells[delta * ty->w];
 }
 
 /* @requested_y unit is in visual lines on the screen */
@@ -1154,17 +1658,19 @@ termpty_cellrow_get(Termpty *ty, int y_requested, ssize_t *wret)
 {
    if (y_requested >= 0)
      {
-        Termcell *cells = &(TERMPTY_SCREEN(ty, 0, y_requested));
+        Termcell *cells;
+
         if (y_requested >= ty->h)
           return NULL;
+        cells = &(TERMPTY_SCREEN(ty, 0, y_requested));
 
-        *wret = termpty_line_length(cells, ty->w);
+        *wret = termpty_line_length(ty, cells, ty->w);
         return cells;
      }
    if (!ty->back)
      return NULL;
 
-   return _termpty_cellrow_from_beacon_get(ty, y_requested, wret);
+   return _termpty_cellrow_from_backlog_get(ty, y_requested, wret);
 }
 
 /* @requested_y unit is in visual lines on the screen */
@@ -1185,7 +1691,7 @@ termpty_cell_get(Termpty *ty, int y_requested, int x_requested)
    if (!ty->back)
      return NULL;
 
-   cells = _termpty_cellrow_from_beacon_get(ty, y_requested, &wret);
+   cells = _termpty_cellrow_from_backlog_get(ty, y_requested, &wret);
    if (!cells || x_requested >= wret)
      return NULL;
    return cells + x_requested;
@@ -1197,21 +1703,47 @@ termpty_write(Termpty *ty, const char *input, int len)
 #if defined(BINARY_TYFUZZ)
    return;
 #endif
-   int res = ty_sb_add(&ty->write_buffer, input, len);
+   int res;
 
+   termpty_backlog_lock(ty);
+   res = ty_sb_add(&ty->write_buffer, input, len);
    if (res < 0)
      {
         ERR("failure to add %d characters to write buffer", len);
      }
-   else if (ty->hand_fd)
+   /* the reader thread flushes the buffer once done parsing */
+   else if (eina_main_loop_is())
+     {
+        _fd_handler_flags_update(ty);
+     }
+   termpty_backlog_unlock(ty);
+}
+
+/* Lines in storage order, see TERMPTY_SCREEN() */
+static void
+_rows_fill(Termcell **rows, Termcell *screen, int w, int h)
+{
+   int y;
+
+   for (y = 0; y < h; y++)
      {
-        ecore_main_fd_handler_active_set(ty->hand_fd,
-                                         ECORE_FD_ERROR |
-                                         ECORE_FD_READ |
-                                         ECORE_FD_WRITE);
+        rows[y] = &screen[y * w];
+        rows[y + h] = rows[y];
      }
 }
 
+Eina_Bool
+termpty_rows_init(Termpty *ty)
+{
+   ty->rows = malloc(sizeof(Termcell *) * 2 * ty->h);
+   ty->rows2 = malloc(sizeof(Termcell *) * 2 * ty->h);
+   if (!ty->rows || !ty->rows2)
+     return EINA_FALSE;
+   _rows_fill(ty->rows, ty->screen, ty->w, ty->h);
+   _rows_fill(ty->rows2, ty->screen2, ty->w, ty->h);
+   return EINA_TRUE;
+}
+
 struct screen_info
 {
    Termcell *screen;
@@ -1266,7 +1798,7 @@ _termpty_line_rewrap(Termpty *ty, Termcell *src_cells, int len,
         return;
      }
 
-   autowrapped = src_cells[len-1].att.autowrapped;
+   autowrapped = src_cells[len-1].autowrapped;
 
    while (len > 0)
      {
@@ -1297,7 +1829,7 @@ _termpty_line_rewrap(Termpty *ty, Termcell *src_cells, int len,
              if ((len > 0) || (len == 0 && autowrapped))
                {
                   dst_cells = &SCREEN_INFO_GET_CELLS(si, 0, si->y);
-                  dst_cells[si->w - 1].att.autowrapped = 1;
+                  dst_cells[si->w - 1].autowrapped = 1;
                }
              si->y++;
              si->x = 0;
@@ -1330,12 +1862,14 @@ _backlog_remove_latest_nolock(Termpty *ty)
    ty->backlog_beacon.backlog_y = 0;
 
    termpty_save_free(ty, ts);
+   termpty_backlog_line_removed(ty);
 }
 
 void
 termpty_resize(Termpty *ty, int new_w, int new_h)
 {
-   Termcell *new_screen = NULL;
+   Termcell *new_screen = NULL, *new_screen2 = NULL;
+   Termcell **new_rows = NULL, **new_rows2 = NULL;
    int old_y = 0,
        old_w = ty->w,
        old_h = ty->h,
@@ -1344,20 +1878,28 @@ termpty_resize(Termpty *ty, int new_w, int new_h)
    struct screen_info new_si = {.screen = NULL};
    if ((ty->w == new_w) && (ty->h == new_h)) return;
 
-   termpty_backlog_lock();
+   termpty_backlog_lock(ty);
+   /* lines are rewrapped through buffers that collections do not see */
+   ty->atts.held = EINA_TRUE;
 
    if (ty->altbuf)
      {
         termpty_screen_swap(ty);
         altbuf = 1;
      }
+   /* every cell is checked while the screens are replaced */
+   free(ty->row_flags);
+   free(ty->row_flags2);
+   ty->row_flags = NULL;
+   ty->row_flags2 = NULL;
 
+   /* the screens and their rows are only replaced once all is allocated,
+    * so that they still match on failure */
    new_screen = calloc(1, sizeof(Termcell) * new_w * new_h);
-   if (!new_screen)
-     goto bad;
-   free(ty->screen2);
-   ty->screen2 = calloc(1, sizeof(Termcell) * new_w * new_h);
-   if (!ty->screen2)
+   new_screen2 = calloc(1, sizeof(Termcell) * new_w * new_h);
+   new_rows = malloc(sizeof(Termcell *) * 2 * new_h);
+   new_rows2 = malloc(sizeof(Termcell *) * 2 * new_h);
+   if (!new_screen || !new_screen2 || !new_rows || !new_rows2)
      goto bad;
 
    new_si.screen = new_screen;
@@ -1369,15 +1911,13 @@ termpty_resize(Termpty *ty, int new_w, int new_h)
    for (old_y = old_h -1; old_y >= 0; old_y--)
      {
         Termcell *cells = &(TERMPTY_SCREEN(ty, 0, old_y));
-        if (!_termpty_line_is_empty(cells, old_w))
+        if (!_termpty_line_is_empty(ty, cells, old_w))
           {
              effective_old_h = old_y + 1;
              break;
           }
      }
 
-   termpty_resize_tabs(ty, old_w, new_w);
-
    if (effective_old_h <= ty->cursor_state.cy)
      effective_old_h = ty->cursor_state.cy + 1;
 
@@ -1387,14 +1927,14 @@ termpty_resize(Termpty *ty, int new_w, int new_h)
      {
         Termsave *ts;
         ts = BACKLOG_ROW_GET(ty, 1);
-        ts = termpty_save_extract(ts);
-        if (ts->cells && ts->w && ts->cells[ts->w - 1].att.autowrapped)
+        ts = termpty_save_extract(ty, ts);
+        if (ts && ts->cells && ts->w && ts->cells[ts->w - 1].autowrapped)
           {
              Termcell *cells = &(TERMPTY_SCREEN(ty, 0, old_y)),
                       *new_cells;
              int len;
 
-             len = termpty_line_length(cells, old_w);
+             len = termpty_line_length(ty, cells, old_w);
 
              new_cells = malloc((ts->w + len) * sizeof(Termcell));
              if (!new_cells)
@@ -1420,13 +1960,23 @@ termpty_resize(Termpty *ty, int new_w, int new_h)
         Termcell *cells = &(TERMPTY_SCREEN(ty, 0, old_y));
         int len;
 
-        len = termpty_line_length(cells, old_w);
+        len = termpty_line_length(ty, cells, old_w);
         _termpty_line_rewrap(ty, cells, len, &new_si,
                              old_y == ty->cursor_state.cy);
      }
 
+   termpty_resize_tabs(ty, old_w, new_w);
+
    free(ty->screen);
    ty->screen = new_screen;
+   free(ty->screen2);
+   ty->screen2 = new_screen2;
+   free(ty->rows);
+   free(ty->rows2);
+   ty->rows = new_rows;
+   ty->rows2 = new_rows2;
+   _rows_fill(ty->rows, ty->screen, new_w, new_h);
+   _rows_fill(ty->rows2, ty->screen2, new_w, new_h);
 
    ty->cursor_state.cy = MAX(new_si.cy, 0);
    ty->cursor_state.cx = MAX(new_si.cx, 0);
@@ -1437,6 +1987,8 @@ termpty_resize(Termpty *ty, int new_w, int new_h)
    ty->h = new_h;
    ty->cursor_state.wrapnext = 0;
 
+   termpty_row_flags_reset(ty);
+
    if (altbuf)
      termpty_screen_swap(ty);
 
@@ -1444,7 +1996,8 @@ termpty_resize(Termpty *ty, int new_w, int new_h)
 
    _pty_size(ty);
 
-   termpty_backlog_unlock();
+   ty->atts.held = EINA_FALSE;
+   termpty_backlog_unlock(ty);
 
    ty->backlog_beacon.backlog_y = 0;
    ty->backlog_beacon.screen_y = 0;
@@ -1452,8 +2005,15 @@ termpty_resize(Termpty *ty, int new_w, int new_h)
    return;
 
 bad:
-   termpty_backlog_unlock();
+   termpty_row_flags_reset(ty);
+   if (altbuf)
+     termpty_screen_swap(ty);
+   ty->atts.held = EINA_FALSE;
+   termpty_backlog_unlock(ty);
    free(new_screen);
+   free(new_screen2);
+   free(new_rows);
+   free(new_rows2);
 }
 
 pid_t
@@ -1473,8 +2033,11 @@ termpty_block_free(Termblock *tb)
    eina_stringshare_del(tb->path);
    eina_stringshare_del(tb->link);
    eina_stringshare_del(tb->chid);
-   if (tb->obj)
-     evas_object_del(tb->obj);
+   if ((tb->obj) && (termpty_main_loop_begin(tb->pty)))
+     {
+        evas_object_del(tb->obj);
+        termpty_main_loop_end(tb->pty);
+     }
    EINA_LIST_FREE(tb->cmds, s)
       free(s);
    free(tb);
@@ -1606,13 +2169,22 @@ termpty_handle_block_codepoint_overwrite_heavy(Termpty *ty, int oldc, int newc)
 void
 termpty_screen_swap(Termpty *ty)
 {
-   Termcell *tmp_screen;
+   Termcell *tmp_screen, **tmp_rows;
+   uint8_t *tmp_row_flags;
    int tmp_circular_offset;
 
    tmp_screen = ty->screen;
    ty->screen = ty->screen2;
    ty->screen2 = tmp_screen;
 
+   tmp_rows = ty->rows;
+   ty->rows = ty->rows2;
+   ty->rows2 = tmp_rows;
+
+   tmp_row_flags = ty->row_flags;
+   ty->row_flags = ty->row_flags2;
+   ty->row_flags2 = tmp_row_flags;
+
    tmp_circular_offset = ty->circular_offset;
    ty->circular_offset = ty->circular_offset2;
    ty->circular_offset2 = tmp_circular_offset;
@@ -1623,16 +2195,76 @@ termpty_screen_swap(Termpty *ty)
      ty->cb.cancel_sel.func(ty->cb.cancel_sel.data);
 }
 
+static uint8_t
+_cells_flags(const Termpty *ty, const Termcell *cells, int n)
+{
+   uint8_t flags = 0;
+   int i;
+
+   for (i = 0; i < n; i++)
+     {
+        if (cells[i].codepoint & 0x80000000)
+          flags |= TERMPTY_ROW_BLOCKS;
+        if (TERMPTY_CELL_ATT(ty, &cells[i])->link_id)
+          flags |= TERMPTY_ROW_LINKS;
+     }
+   return flags;
+}
+
+/* Computes again the flags of the rows of both screens, after they were
+ * resized */
+Eina_Bool
+termpty_row_flags_reset(Termpty *ty)
+{
+   uint8_t *row_flags, *row_flags2;
+   int y;
+
+   row_flags = realloc(ty->row_flags, ty->h);
+   if (row_flags)
+     ty->row_flags = row_flags;
+   row_flags2 = realloc(ty->row_flags2, ty->h);
+   if (row_flags2)
+     ty->row_flags2 = row_flags2;
+   if (!row_flags || !row_flags2)
+     {
+        /* every row is then checked cell by cell */
+        free(ty->row_flags);
+        free(ty->row_flags2);
+        ty->row_flags = NULL;
+        ty->row_flags2 = NULL;
+        return EINA_FALSE;
+     }
+   for (y = 0; y < ty->h; y++)
+     {
+        row_flags[y] = _cells_flags(ty, &ty->screen[y * ty->w], ty->w);
+        row_flags2[y] = _cells_flags(ty, &ty->screen2[y * ty->w], ty->w);
+     }
+   return EINA_TRUE;
+}
+
 void
 termpty_cells_set_content(Termpty *ty, Termcell *cells,
                           Eina_Unicode codepoint, int count)
 {
+   uint8_t *row_flags;
+   size_t offset, y;
    int i;
+
    for (i = 0; i < count; i++)
      {
         HANDLE_BLOCK_CODEPOINT_OVERWRITE(ty, cells[i].codepoint, codepoint);
         cells[i].codepoint = codepoint;
      }
+   /* the attributes are kept, so are the flags */
+   if ((count > 0) && (codepoint & 0x80000000))
+     {
+        row_flags = termpty_row_flags_find(ty, cells, &offset);
+        if (row_flags)
+          {
+             for (y = offset / ty->w; y <= (offset + count - 1) / ty->w; y++)
+               row_flags[y] |= TERMPTY_ROW_BLOCKS;
+          }
+     }
 }
 
 void
@@ -1640,30 +2272,44 @@ termpty_cells_att_fill_preserve_colors(Termpty *ty, Termcell *cells,
                                        Eina_Unicode codepoint, int count)
 {
    int i;
-   Termcell local = { .codepoint = codepoint, .att = ty->termstate.att};
+   Termatt att = ty->termstate.att;
+   Eina_Bool preserve = (att.fg == 0 && att.bg == 0 &&
+                         !att.fgrgb && !att.bgrgb);
+   uint8_t flags = 0;
 
-   if (EINA_UNLIKELY(local.att.link_id))
-     term_link_refcount_inc(ty, local.att.link_id, count);
+   if (EINA_UNLIKELY(att.link_id))
+     {
+        term_link_refcount_inc(ty, att.link_id, count);
+        flags |= TERMPTY_ROW_LINKS;
+     }
+   if (codepoint & 0x80000000)
+     flags |= TERMPTY_ROW_BLOCKS;
 
    for (i = 0; i < count; i++)
      {
-        Termatt att = cells[i].att;
+        Termatt old = *TERMPTY_CELL_ATT(ty, &cells[i]);
         HANDLE_BLOCK_CODEPOINT_OVERWRITE(ty, cells[i].codepoint, codepoint);
-        if (EINA_UNLIKELY(cells[i].att.link_id))
-          term_link_refcount_dec(ty, cells[i].att.link_id, 1);
+        if (EINA_UNLIKELY(old.link_id))
+          term_link_refcount_dec(ty, old.link_id, 1);
 
-        cells[i] = local;
-        if (ty->termstate.att.fg == 0 && ty->termstate.att.bg == 0)
+        cells[i].codepoint = codepoint;
+        if (preserve)
           {
-             cells[i].att.fg = att.fg;
-             cells[i].att.fg256 = att.fg256;
-             cells[i].att.fgintense = att.fgintense;
-
-             cells[i].att.bg = att.bg;
-             cells[i].att.bg256 = att.bg256;
-             cells[i].att.bgintense = att.bgintense;
+             att.fg = old.fg;
+             att.fg256 = old.fg256;
+             att.fgintense = old.fgintense;
+             att.fgrgb = old.fgrgb;
+             att.fg_hi = old.fg_hi;
+
+             att.bg = old.bg;
+             att.bg256 = old.bg256;
+             att.bgintense = old.bgintense;
+             att.bgrgb = old.bgrgb;
+             att.bg_hi = old.bg_hi;
           }
+        termpty_cell_att_set(ty, &cells[i], &att);
      }
+   termpty_rows_flags_set(ty, cells, count, flags);
 }
 
 
@@ -1671,20 +2317,86 @@ void
 termpty_cell_codepoint_att_fill(Termpty *ty, Eina_Unicode codepoint,
                                 Termatt att, Termcell *dst, int n)
 {
-   Termcell local = { .codepoint = codepoint, .att = att };
+   Termcell local = { .codepoint = codepoint };
+   uint8_t flags = 0;
    int i;
 
-   if (EINA_UNLIKELY(local.att.link_id))
-     term_link_refcount_inc(ty, local.att.link_id, n);
+   termpty_cell_att_set(ty, &local, &att);
+   if (EINA_UNLIKELY(att.link_id))
+     {
+        term_link_refcount_inc(ty, att.link_id, n);
+        flags |= TERMPTY_ROW_LINKS;
+     }
+   if (codepoint & 0x80000000)
+     flags |= TERMPTY_ROW_BLOCKS;
 
-   for (i = 0; i < n; i++)
+   if (EINA_LIKELY(!(flags | termpty_rows_flags(ty, dst, n))))
      {
-        HANDLE_BLOCK_CODEPOINT_OVERWRITE(ty, dst[i].codepoint, codepoint);
-        if (EINA_UNLIKELY(dst[i].att.link_id))
-          term_link_refcount_dec(ty, dst[i].att.link_id, 1);
+        for (i = 0; i < n; i++)
+          dst[i] = local;
+     }
+   else
+     {
+        for (i = 0; i < n; i++)
+          {
+             HANDLE_BLOCK_CODEPOINT_OVERWRITE(ty, dst[i].codepoint, codepoint);
+             if (EINA_UNLIKELY(TERMPTY_CELL_ATT(ty, &dst[i])->link_id))
+               term_link_refcount_dec(ty, TERMPTY_CELL_ATT(ty, &dst[i])->link_id, 1);
 
-        dst[i] = local;
+             dst[i] = local;
+          }
      }
+   termpty_rows_flags_set(ty, dst, n, flags);
+}
+
+/* Same as termpty_cell_codepoint_att_fill() with a codepoint per cell */
+void
+termpty_cell_codepoints_att_fill(Termpty *ty, const Eina_Unicode *codepoints,
+                                 Termatt att, Termcell *dst, int n)
+{
+   Termcell local = { .codepoint = 0 };
+   Eina_Unicode all = 0;
+   uint8_t flags = 0;
+   int i;
+
+   termpty_cell_att_set(ty, &local, &att);
+   if (EINA_UNLIKELY(att.link_id))
+     {
+        term_link_refcount_inc(ty, att.link_id, n);
+        flags |= TERMPTY_ROW_LINKS;
+     }
+
+   if (EINA_LIKELY(!(flags | termpty_rows_flags(ty, dst, n))))
+     {
+        /* only new blocks to look for */
+        for (i = 0; i < n; i++)
+          {
+             dst[i] = local;
+             dst[i].codepoint = codepoints[i];
+             all |= codepoints[i];
+          }
+        if (EINA_UNLIKELY(all & 0x80000000))
+          {
+             for (i = 0; i < n; i++)
+               HANDLE_BLOCK_CODEPOINT_OVERWRITE(ty, 0, codepoints[i]);
+          }
+     }
+   else
+     {
+        for (i = 0; i < n; i++)
+          {
+             HANDLE_BLOCK_CODEPOINT_OVERWRITE(ty, dst[i].codepoint, codepoints[i]);
+             if (EINA_UNLIKELY(TERMPTY_CELL_ATT(ty, &dst[i])->link_id))
+               term_link_refcount_dec(ty, TERMPTY_CELL_ATT(ty, &dst[i])->link_id, 1);
+
+             dst[i] = local;
+             dst[i].codepoint = codepoints[i];
+             all |= codepoints[i];
+          }
+     }
+   if (all & 0x80000000)
+     flags |= TERMPTY_ROW_BLOCKS;
+   termpty_rows_flags_set(ty, dst, n, flags);
 }
 
 /* 0 means error here */
@@ -1800,3 +2512,1135 @@ term_link_free(Termpty *ty, Term_Link *link)
    /* Remove from bitmap */
    hl_bitmap_clear_bit(ty, id);
 }
+
+/* Cells refer to their attributes by an id in a per-terminal table, as few
+ * distinct attributes are in use at a time. There is no reference counting:
+ * once the table is full, the ids no longer found in the screens or in the
+ * backlog are collected, and the table grows when that frees little.
+ */
+#define ATTS_SIZE_MIN 64
+#define ATTS_COLLECT_MIN 4096 /* smaller tables just grow */
+
+static inline void
+_att_key(Termatt *key, const Termatt *att)
+{
+   *key = *att;
+   key->dblwidth = 0;
+   key->autowrapped = 0;
+   key->newline = 0;
+   key->tab_inserted = 0;
+   key->tab_last = 0;
+   key->bit_padding = 0;
+}
+
+static inline uint32_t
+_att_hash(const Termatt *key, uint32_t size)
+{
+   uint64_t v = termpty_att_pack(key);
+
+   v *= 0x9e3779b97f4a7c15ULL;
+   /* the hash has twice as many buckets as the table */
+   return (uint32_t)(v >> 32) & (size * 2 - 1);
+}
+
+static void
+_atts_hash_add(Termpty *ty, uint32_t id)
+{
+   uint32_t h = _att_hash(&ty->atts.table[id], ty->atts.size);
+
+   while (ty->atts.hash[h])
+     h = (h + 1) & (ty->atts.size * 2 - 1);
+   ty->atts.hash[h] = id + 1;
+}
+
+static void
+_atts_hash_rebuild(Termpty *ty, const uint8_t *live)
+{
+   uint32_t id;
+
+   memset(ty->atts.hash, 0, ty->atts.size * 2 * sizeof(uint32_t));
+   for (id = 1; id < ty->atts.used; id++)
+     {
+        if (live[id])
+          _atts_hash_add(ty, id);
+     }
+}
+
+Eina_Bool
+termpty_atts_init(Termpty *ty)
+{
+   ty->atts.table = calloc(ATTS_SIZE_MIN, sizeof(Termatt));
+   ty->atts.hash = calloc(ATTS_SIZE_MIN * 2, sizeof(uint32_t));
+   ty->atts.free = malloc(ATTS_SIZE_MIN * sizeof(uint32_t));
+   if (!ty->atts.table || !ty->atts.hash || !ty->atts.free)
+     {
+        termpty_atts_shutdown(ty);
+        return EINA_FALSE;
+     }
+   ty->atts.size = ATTS_SIZE_MIN;
+   ty->atts.used = 1;
+   ty->atts.nfree = 0;
+   memset(&ty->atts.last, 0, sizeof(ty->atts.last));
+   ty->atts.last_id = 0;
+   return EINA_TRUE;
+}
+
+void
+termpty_atts_shutdown(Termpty *ty)
+{
+   free(ty->atts.table);
+   free(ty->atts.hash);
+   free(ty->atts.free);
+   ty->atts.table = NULL;
+   ty->atts.hash = NULL;
+   ty->atts.free = NULL;
+   ty->atts.size = 0;
+   ty->atts.used = 0;
+   ty->atts.nfree = 0;
+}
+
+static void
+_atts_mark(const Termcell *cells, ssize_t n, uint8_t *live)
+{
+   ssize_t i;
+
+   for (i = 0; i < n; i++)
+     live[cells[i].att_id] = 1;
+}
+
+/* Returns which ids are in use, as an array of ty->atts.used bytes, or
+ * NULL when they cannot be collected */
+static uint8_t *
+_atts_live_get(Termpty *ty)
+{
+   uint8_t *live;
+   size_t i;
+
+   if (ty->atts.held)
+     return NULL;
+   live = calloc(ty->atts.used, 1);
+   if (!live)
+     return NULL;
+   live[0] = 1;
+   live[ty->atts.last_id] = 1;
+   if (ty->screen)
+     _atts_mark(ty->screen, ty->w * ty->h, live);
+   if (ty->screen2)
+     _atts_mark(ty->screen2, ty->w * ty->h, live);
+   for (i = 0; ty->back && i < ty->backsize; i++)
+     {
+        const Termsave *ts = &ty->back[i];
+
+        if (ts->comp)
+          {
+             uint32_t j;
+
+             for (j = 0; j < ts->block->natts; j++)
+               live[ts->block->ids[j]] = 1;
+          }
+        else if (ts->cells)
+          _atts_mark(ts->cells, ts->w, live);
+     }
+   return live;
+}
+
+static void
+_atts_sweep(Termpty *ty, const uint8_t *live)
+{
+   uint32_t id;
+
+   ty->atts.nfree = 0;
+   for (id = ty->atts.used - 1; id > 0; id--)
+     {
+        if (!live[id])
+          ty->atts.free[ty->atts.nfree++] = id;
+     }
+   _atts_hash_rebuild(ty, live);
+   ty->atts.collections++;
+   DBG("attributes: %u of %u still in use after collection",
+       ty->atts.used - ty->atts.nfree, ty->atts.used);
+}
+
+static Eina_Bool
+_atts_grow(Termpty *ty)
+{
+   uint32_t size = ty->atts.size * 2;
+   Termatt *table;
+   uint32_t *hash, *free_ids;
+   uint8_t *live;
+   uint32_t i;
+
+   if (size > TERMPTY_ATTS_MAX)
+     return EINA_FALSE;
+   live = malloc(ty->atts.used);
+   table = realloc(ty->atts.table, size * sizeof(Termatt));
+   if (table)
+     ty->atts.table = table;
+   hash = calloc(size * 2, sizeof(uint32_t));
+   free_ids = realloc(ty->atts.free, size * sizeof(uint32_t));
+   if (free_ids)
+     ty->atts.free = free_ids;
+   if (!live || !table || !hash || !free_ids)
+     {
+        free(live);
+        free(hash);
+        return EINA_FALSE;
+     }
+   free(ty->atts.hash);
+   ty->atts.hash = hash;
+   ty->atts.size = size;
+   /* the free ids, if any, have no bucket already */
+   memset(live, 1, ty->atts.used);
+   for (i = 0; i < ty->atts.nfree; i++)
+     live[ty->atts.free[i]] = 0;
+   _atts_hash_rebuild(ty, live);
+   free(live);
+   return EINA_TRUE;
+}
+
+static uint32_t
+_atts_id_new(Termpty *ty)
+{
+   if (ty->atts.nfree)
+     return ty->atts.free[--ty->atts.nfree];
+   if (ty->atts.used == ty->atts.size)
+     {
+        if (ty->atts.size >= ATTS_COLLECT_MIN)
+          {
+             uint8_t *live = _atts_live_get(ty);
+
+             if (live)
+               {
+                  _atts_sweep(ty, live);
+                  free(live);
+               }
+          }
+        if ((ty->atts.nfree < ty->atts.size / 4) && (!_atts_grow(ty)) &&
+            (!ty->atts.nfree))
+          {
+             ERR("attributes: table is full");
+             return 0;
+          }
+        if (ty->atts.nfree)
+          return ty->atts.free[--ty->atts.nfree];
+     }
+   return ty->atts.used++;
+}
+
+/* Returns the id of the attributes @att, without the flags kept per cell.
+ * It stays valid until the next lookup even if not yet set in a cell */
+uint32_t
+termpty_att_id_get(Termpty *ty, const Termatt *att)
+{
+   Termatt key;
+   uint64_t packed;
+   uint32_t h, id;
+
+   _att_key(&key, att);
+   packed = termpty_att_pack(&key);
+   if (EINA_LIKELY(packed == termpty_att_pack(&ty->atts.last)))
+     return ty->atts.last_id;
+   if (packed == termpty_att_pack(&ty->atts.table[0]))
+     {
+        id = 0;
+        goto end;
+     }
+
+   h = _att_hash(&key, ty->atts.size);
+   while (ty->atts.hash[h])
+     {
+        id = ty->atts.hash[h] - 1;
+        if (packed == termpty_att_pack(&ty->atts.table[id]))
+          goto end;
+        h = (h + 1) & (ty->atts.size * 2 - 1);
+     }
+
+   id = _atts_id_new(ty);
+   if (!id)
+     return 0;
+   ty->atts.table[id] = key;
+   _atts_hash_add(ty, id);
+end:
+   ty->atts.last = key;
+   ty->atts.last_id = id;
+   return id;
+}
+
+/* Clusters are interned the same way as attributes: once the table is full,
+ * the ids no longer found in the screens or in the backlog are collected,
+ * and the table grows when that frees little. Id 0 is never used.
+ */
+#define CLUSTERS_SIZE_MIN 64
+#define CLUSTERS_COLLECT_MIN 1024 /* smaller tables just grow */
+
+static inline uint32_t
+_cluster_hash(const Termcluster *key, uint32_t size)
+{
+   uint64_t v = 0;
+   int i;
+
+   for (i = 0; (i < TERMPTY_CLUSTER_LEN) && (key->codepoints[i]); i++)
+     v = (v ^ key->codepoints[i]) * 0x9e3779b97f4a7c15ULL;
+   /* the hash has twice as many buckets as the table */
+   return (uint32_t)(v >> 32) & (size * 2 - 1);
+}
+
+static void
+_clusters_hash_add(Termpty *ty, uint32_t id)
+{
+   uint32_t h = _cluster_hash(&ty->clusters.table[id], ty->clusters.size);
+
+   while (ty->clusters.hash[h])
+     h = (h + 1) & (ty->clusters.size * 2 - 1);
+   ty->clusters.hash[h] = id + 1;
+}
+
+static void
+_clusters_hash_rebuild(Termpty *ty, const uint8_t *live)
+{
+   uint32_t id;
+
+   memset(ty->clusters.hash, 0, ty->clusters.size * 2 * sizeof(uint32_t));
+   for (id = 1; id < ty->clusters.used; id++)
+     {
+        if (live[id])
+          _clusters_hash_add(ty, id);
+     }
+}
+
+Eina_Bool
+termpty_clusters_init(Termpty *ty)
+{
+   ty->clusters.table = calloc(CLUSTERS_SIZE_MIN, sizeof(Termcluster));
+   ty->clusters.hash = calloc(CLUSTERS_SIZE_MIN * 2, sizeof(uint32_t));
+   ty->clusters.free = malloc(CLUSTERS_SIZE_MIN * sizeof(uint32_t));
+   if (!ty->clusters.table || !ty->clusters.hash || !ty->clusters.free)
+     {
+        termpty_clusters_shutdown(ty);
+        return EINA_FALSE;
+     }
+   ty->clusters.size = CLUSTERS_SIZE_MIN;
+   ty->clusters.used = 1;
+   ty->clusters.nfree = 0;
+   return EINA_TRUE;
+}
+
+void
+termpty_clusters_shutdown(Termpty *ty)
+{
+   free(ty->clusters.table);
+   free(ty->clusters.hash);
+   free(ty->clusters.free);
+   ty->clusters.table = NULL;
+   ty->clusters.hash = NULL;
+   ty->clusters.free = NULL;
+   ty->clusters.size = 0;
+   ty->clusters.used = 0;
+   ty->clusters.nfree = 0;
+}
+
+static void
+_clusters_mark(const Termcell *cells, ssize_t n, uint8_t *live)
+{
+   ssize_t i;
+
+   for (i = 0; i < n; i++)
+     {
+        if (EINA_UNLIKELY(TERMPTY_CODEPOINT_IS_CLUSTER(cells[i].codepoint)))
+          live[cells[i].codepoint & ~TERMPTY_CLUSTER_FLAG] = 1;
+     }
+}
+
+/* Returns which ids are in use, as an array of ty->clusters.used bytes */
+static uint8_t *
+_clusters_live_get(Termpty *ty)
+{
+   uint8_t *live;
+   size_t i;
+
+   live = calloc(ty->clusters.used, 1);
+   if (!live)
+     return NULL;
+   live[0] = 1;
+   if (ty->screen)
+     _clusters_mark(ty->screen, ty->w * ty->h, live);
+   if (ty->screen2)
+     _clusters_mark(ty->screen2, ty->w * ty->h, live);
+   for (i = 0; ty->back && i < ty->backsize; i++)
+     {
+        const Termsave *ts = &ty->back[i];
+
+        if (ts->comp)
+          {
+             const uint32_t *ids = ts->block->ids + ts->block->natts;
+             uint32_t j;
+
+             for (j = 0; j < ts->block->nclusters; j++)
+               live[ids[j]] = 1;
+          }
+        else if (ts->cells)
+          _clusters_mark(ts->cells, ts->w, live);
+     }
+   return live;
+}
+
+static void
+_clusters_sweep(Termpty *ty, const uint8_t *live)
+{
+   uint32_t id;
+
+   ty->clusters.nfree = 0;
+   for (id = ty->clusters.used - 1; id > 0; id--)
+     {
+        if (!live[id])
+          ty->clusters.free[ty->clusters.nfree++] = id;
+     }
+   _clusters_hash_rebuild(ty, live);
+   ty->clusters.collections++;
+   DBG("clusters: %u of %u still in use after collection",
+       ty->clusters.used - ty->clusters.nfree, ty->clusters.used);
+}
+
+static Eina_Bool
+_clusters_grow(Termpty *ty)
+{
+   uint32_t size = ty->clusters.size * 2;
+   Termcluster *table;
+   uint32_t *hash, *free_ids;
+   uint8_t *live;
+   uint32_t i;
+
+   if (size > TERMPTY_CLUSTERS_MAX)
+     return EINA_FALSE;
+   live = malloc(ty->clusters.used);
+   table = realloc(ty->clusters.table, size * sizeof(Termcluster));
+   if (table)
+     ty->clusters.table = table;
+   hash = calloc(size * 2, sizeof(uint32_t));
+   free_ids = realloc(ty->clusters.free, size * sizeof(uint32_t));
+   if (free_ids)
+     ty->clusters.free = free_ids;
+   if (!live || !table || !hash || !free_ids)
+     {
+        free(live);
+        free(hash);
+        return EINA_FALSE;
+     }
+   free(ty->clusters.hash);
+   ty->clusters.hash = hash;
+   ty->clusters.size = size;
+   /* the free ids, if any, have no bucket already */
+   memset(live, 1, ty->clusters.used);
+   for (i = 0; i < ty->clusters.nfree; i++)
+     live[ty->clusters.free[i]] = 0;
+   _clusters_hash_rebuild(ty, live);
+   free(live);
+   return EINA_TRUE;
+}
+
+static uint32_t
+_clusters_id_new(Termpty *ty)
+{
+   if (ty->clusters.nfree)
+     return ty->clusters.free[--ty->clusters.nfree];
+   if (ty->clusters.used == ty->clusters.size)
+     {
+        if (ty->clusters.size >= CLUSTERS_COLLECT_MIN)
+          {
+             uint8_t *live = _clusters_live_get(ty);
+
+             if (live)
+               {
+                  _clusters_sweep(ty, live);
+                  free(live);
+               }
+          }
+        if ((ty->clusters.nfree < ty->clusters.size / 4) &&
+            (!_clusters_grow(ty)) && (!ty->clusters.nfree))
+          {
+             ERR("clusters: table is full");
+             return 0;
+          }
+        if (ty->clusters.nfree)
+          return ty->clusters.free[--ty->clusters.nfree];
+     }
+   return ty->clusters.used++;
+}
+
+/* Returns the codepoint of a cell holding @codepoint followed by @g, that is
+ * @codepoint itself when its cluster is full or the table is */
+Eina_Unicode
+termpty_cluster_append(Termpty *ty, Eina_Unicode codepoint, Eina_Unicode g)
+{
+   Termcluster key;
+   uint32_t h, id;
+   int len;
+
+   memset(&key, 0, sizeof(key));
+   len = termpty_cluster_codepoints_get(ty, codepoint, key.codepoints);
+   if (len >= TERMPTY_CLUSTER_LEN)
+     return codepoint;
+   key.codepoints[len] = g;
+
+   h = _cluster_hash(&key, ty->clusters.size);
+   while (ty->clusters.hash[h])
+     {
+        id = ty->clusters.hash[h] - 1;
+        if (!memcmp(&key, &ty->clusters.table[id], sizeof(key)))
+          return TERMPTY_CLUSTER_FLAG | id;
+        h = (h + 1) & (ty->clusters.size * 2 - 1);
+     }
+
+   id = _clusters_id_new(ty);
+   if (!id)
+     return codepoint;
+   ty->clusters.table[id] = key;
+   _clusters_hash_add(ty, id);
+   return TERMPTY_CLUSTER_FLAG | id;
+}
+
+/* Fills @codepoints, of TERMPTY_CLUSTER_LEN, with what a cell holding
+ * @codepoint shows. Returns their number */
+int
+termpty_cluster_codepoints_get(const Termpty *ty, Eina_Unicode codepoint,
+                               Eina_Unicode *codepoints)
+{
+   const Termcluster *cluster;
+   int len;
+
+   if (!TERMPTY_CODEPOINT_IS_CLUSTER(codepoint))
+     {
+        codepoints[0] = codepoint;
+        return 1;
+     }
+   cluster = &ty->clusters.table[codepoint & ~TERMPTY_CLUSTER_FLAG];
+   for (len = 0;
+        (len < TERMPTY_CLUSTER_LEN) && (cluster->codepoints[len]);
+        len++)
+     codepoints[len] = cluster->codepoints[len];
+   return len;
+}
+
+/* Like codepoint_to_utf8(), with the whole cluster if any. @txt has room
+ * for TERMPTY_CLUSTER_UTF8_MAX bytes */
+int
+termpty_codepoint_to_utf8(const Termpty *ty, Eina_Unicode codepoint,
+                          char *txt)
+{
+   Eina_Unicode codepoints[TERMPTY_CLUSTER_LEN];
+   int len, i, n = 0;
+
+   len = termpty_cluster_codepoints_get(ty, codepoint, codepoints);
+   txt[0] = '\0';
+   for (i = 0; i < len; i++)
+     n += codepoint_to_utf8(codepoints[i], txt + n);
+   return n;
+}
+
+/* Latin letters with a mark, as base and combining mark, sorted */
+static const struct {
+   uint16_t base, mark, glyph;
+} _precomposed[] = {
+   { 'A', 0x300, 0x0c0 }, { 'A', 0x301, 0x0c1 }, { 'A', 0x302, 0x0c2 },
+   { 'A', 0x303, 0x0c3 }, { 'A', 0x304, 0x100 }, { 'A', 0x306, 0x102 },
+   { 'A', 0x308, 0x0c4 }, { 'A', 0x30a, 0x0c5 }, { 'A', 0x328, 0x104 },
+   { 'C', 0x301, 0x106 }, { 'C', 0x302, 0x108 }, { 'C', 0x307, 0x10a },
+   { 'C', 0x30c, 0x10c }, { 'C', 0x327, 0x0c7 }, { 'D', 0x30c, 0x10e },
+   { 'E', 0x300, 0x0c8 }, { 'E', 0x301, 0x0c9 }, { 'E', 0x302, 0x0ca },
+   { 'E', 0x304, 0x112 }, { 'E', 0x306, 0x114 }, { 'E', 0x307, 0x116 },
+   { 'E', 0x308, 0x0cb }, { 'E', 0x30c, 0x11a }, { 'E', 0x328, 0x118 },
+   { 'G', 0x302, 0x11c }, { 'G', 0x306, 0x11e }, { 'G', 0x307, 0x120 },
+   { 'G', 0x327, 0x122 }, { 'H', 0x302, 0x124 }, { 'I', 0x300, 0x0cc },
+   { 'I', 0x301, 0x0cd }, { 'I', 0x302, 0x0ce }, { 'I', 0x303, 0x128 },
+   { 'I', 0x304, 0x12a }, { 'I', 0x306, 0x12c }, { 'I', 0x307, 0x130 },
+   { 'I', 0x308, 0x0cf }, { 'I', 0x328, 0x12e }, { 'J', 0x302, 0x134 },
+   { 'K', 0x327, 0x136 }, { 'L', 0x301, 0x139 }, { 'L', 0x30c, 0x13d },
+   { 'L', 0x327, 0x13b }, { 'N', 0x301, 0x143 }, { 'N', 0x303, 0x0d1 },
+   { 'N', 0x30c, 0x147 }, { 'N', 0x327, 0x145 }, { 'O', 0x300, 0x0d2 },
+   { 'O', 0x301, 0x0d3 }, { 'O', 0x302, 0x0d4 }, { 'O', 0x303, 0x0d5 },
+   { 'O', 0x304, 0x14c }, { 'O', 0x306, 0x14e }, { 'O', 0x308, 0x0d6 },
+   { 'O', 0x30b, 0x150 }, { 'R', 0x301, 0x154 }, { 'R', 0x30c, 0x158 },
+   { 'R', 0x327, 0x156 }, { 'S', 0x301, 0x15a }, { 'S', 0x302, 0x15c },
+   { 'S', 0x30c, 0x160 }, { 'S', 0x327, 0x15e }, { 'T', 0x30c, 0x164 },
+   { 'T', 0x327, 0x162 }, { 'U', 0x300, 0x0d9 }, { 'U', 0x301, 0x0da },
+   { 'U', 0x302, 0x0db }, { 'U', 0x303, 0x168 }, { 'U', 0x304, 0x16a },
+   { 'U', 0x306, 0x16c }, { 'U', 0x308, 0x0dc }, { 'U', 0x30a, 0x16e },
+   { 'U', 0x30b, 0x170 }, { 'U', 0x328, 0x172 }, { 'W', 0x302, 0x174 },
+   { 'Y', 0x301, 0x0dd }, { 'Y', 0x302, 0x176 }, { 'Y', 0x308, 0x178 },
+   { 'Z', 0x301, 0x179 }, { 'Z', 0x307, 0x17b }, { 'Z', 0x30c, 0x17d },
+   { 'a', 0x300, 0x0e0 }, { 'a', 0x301, 0x0e1 }, { 'a', 0x302, 0x0e2 },
+   { 'a', 0x303, 0x0e3 }, { 'a', 0x304, 0x101 }, { 'a', 0x306, 0x103 },
+   { 'a', 0x308, 0x0e4 }, { 'a', 0x30a, 0x0e5 }, { 'a', 0x328, 0x105 },
+   { 'c', 0x301, 0x107 }, { 'c', 0x302, 0x109 }, { 'c', 0x307, 0x10b },
+   { 'c', 0x30c, 0x10d }, { 'c', 0x327, 0x0e7 }, { 'd', 0x30c, 0x10f },
+   { 'e', 0x300, 0x0e8 }, { 'e', 0x301, 0x0e9 }, { 'e', 0x302, 0x0ea },
+   { 'e', 0x304, 0x113 }, { 'e', 0x306, 0x115 }, { 'e', 0x307, 0x117 },
+   { 'e', 0x308, 0x0eb }, { 'e', 0x30c, 0x11b }, { 'e', 0x328, 0x119 },
+   { 'g', 0x302, 0x11d }, { 'g', 0x306, 0x11f }, { 'g', 0x307, 0x121 },
+   { 'g', 0x327, 0x123 }, { 'h', 0x302, 0x125 }, { 'i', 0x300, 0x0ec },
+   { 'i', 0x301, 0x0ed }, { 'i', 0x302, 0x0ee }, { 'i', 0x303, 0x129 },
+   { 'i', 0x304, 0x12b }, { 'i', 0x306, 0x12d }, { 'i', 0x308, 0x0ef },
+   { 'i', 0x328, 0x12f }, { 'j', 0x302, 0x135 }, { 'k', 0x327, 0x137 },
+   { 'l', 0x301, 0x13a }, { 'l', 0x30c, 0x13e }, { 'l', 0x327, 0x13c },
+   { 'n', 0x301, 0x144 }, { 'n', 0x303, 0x0f1 }, { 'n', 0x30c, 0x148 },
+   { 'n', 0x327, 0x146 }, { 'o', 0x300, 0x0f2 }, { 'o', 0x301, 0x0f3 },
+   { 'o', 0x302, 0x0f4 }, { 'o', 0x303, 0x0f5 }, { 'o', 0x304, 0x14d },
+   { 'o', 0x306, 0x14f }, { 'o', 0x308, 0x0f6 }, { 'o', 0x30b, 0x151 },
+   { 'r', 0x301, 0x155 }, { 'r', 0x30c, 0x159 }, { 'r', 0x327, 0x157 },
+   { 's', 0x301, 0x15b }, { 's', 0x302, 0x15d }, { 's', 0x30c, 0x161 },
+   { 's', 0x327, 0x15f }, { 't', 0x30c, 0x165 }, { 't', 0x327, 0x163 },
+   { 'u', 0x300, 0x0f9 }, { 'u', 0x301, 0x0fa }, { 'u', 0x302, 0x0fb },
+   { 'u', 0x303, 0x169 }, { 'u', 0x304, 0x16b }, { 'u', 0x306, 0x16d },
+   { 'u', 0x308, 0x0fc }, { 'u', 0x30a, 0x16f }, { 'u', 0x30b, 0x171 },
+   { 'u', 0x328, 0x173 }, { 'w', 0x302, 0x175 }, { 'y', 0x301, 0x0fd },
+   { 'y', 0x302, 0x177 }, { 'y', 0x308, 0x0ff }, { 'z', 0x301, 0x17a },
+   { 'z', 0x307, 0x17c }, { 'z', 0x30c, 0x17e },
+};
+
+/* The codepoint to draw for the cluster @codepoint: the grid has one glyph
+ * per cell, so a base and a mark with a precomposed form are shown as that
+ * form, else as the base alone */
+Eina_Unicode
+termpty_cluster_glyph(const Termpty *ty, Eina_Unicode codepoint)
+{
+   const Termcluster *cluster;
+   Eina_Unicode base, mark;
+   int lo = 0, hi = sizeof(_precomposed) / sizeof(_precomposed[0]) - 1;
+
+   cluster = &ty->clusters.table[codepoint & ~TERMPTY_CLUSTER_FLAG];
+   base = cluster->codepoints[0];
+   mark = cluster->codepoints[1];
+   while (lo <= hi)
+     {
+        int mid = (lo + hi) / 2;
+
+        if ((_precomposed[mid].base == base)
+            && (_precomposed[mid].mark == mark))
+          return _precomposed[mid].glyph;
+        if ((_precomposed[mid].base < base)
+            || ((_precomposed[mid].base == base)
+                && (_precomposed[mid].mark < mark)))
+          lo = mid + 1;
+        else
+          hi = mid - 1;
+     }
+   return base;
+}
+
+/* Exact truecolors are kept in a table indexed by the ids stored in the
+ * cells using them. There is no reference counting: once the table is full,
+ * the colors no longer found in the screens or in the backlog are collected.
+ * When that frees little, new colors are refused for a while instead of
+ * walking the backlog for each of them.
+ */
+#define TRUECOLOR_HASH_BITS 12
+#define TRUECOLOR_HASH_LEN (1 << TRUECOLOR_HASH_BITS)
+
+static inline unsigned int
+_truecolor_hash(uint32_t rgb)
+{
+   return (rgb * 2654435761u) >> (32 - TRUECOLOR_HASH_BITS);
+}
+
+static void
+_truecolor_hash_add(Termpty *ty, uint32_t rgb, int id)
+{
+   unsigned int h = _truecolor_hash(rgb);
+
+   while (ty->truecolor.hash[h])
+     h = (h + 1) & (TRUECOLOR_HASH_LEN - 1);
+   ty->truecolor.hash[h] = id + 1;
+}
+
+int
+termpty_truecolor_find(const Termpty *ty, uint32_t rgb)
+{
+   unsigned int h = _truecolor_hash(rgb);
+
+   if (!ty->truecolor.hash)
+     return -1;
+   /* the table is at most half full, there is always an empty bucket */
+   while (ty->truecolor.hash[h])
+     {
+        int id = ty->truecolor.hash[h] - 1;
+
+        if (ty->truecolor.colors[id] == rgb)
+          return id;
+        h = (h + 1) & (TRUECOLOR_HASH_LEN - 1);
+     }
+   return -1;
+}
+
+static void
+_truecolor_mark(const Termatt *att, uint8_t *live)
+{
+   if (att->fgrgb)
+     live[TERMATT_FG_ID(*att)] = 1;
+   if (att->bgrgb)
+     live[TERMATT_BG_ID(*att)] = 1;
+}
+
+static void
+_truecolor_collect(Termpty *ty)
+{
+   uint8_t live[TERMPTY_TRUECOLOR_MAX];
+   uint8_t *atts_live;
+   uint32_t i;
+   int id;
+
+   /* the colors in use are the ones of the attributes in use */
+   atts_live = _atts_live_get(ty);
+   if (!atts_live)
+     return;
+   _atts_sweep(ty, atts_live);
+   memset(live, 0, sizeof(live));
+   _truecolor_mark(&ty->termstate.att, live);
+   for (i = 0; i < ty->atts.used; i++)
+     {
+        if (atts_live[i])
+          _truecolor_mark(&ty->atts.table[i], live);
+     }
+   free(atts_live);
+   /* the SGR cache holds ids too */
+   memset(ty->sgr_cache.entries, 0, sizeof(ty->sgr_cache.entries));
+
+   memset(ty->truecolor.hash, 0, TRUECOLOR_HASH_LEN * sizeof(uint16_t));
+   ty->truecolor.count = 0;
+   for (id = 0; id < TERMPTY_TRUECOLOR_MAX; id++)
+     {
+        if (!live[id])
+          ty->truecolor.colors[id] = TERMPTY_TRUECOLOR_FREE;
+        else
+          {
+             _truecolor_hash_add(ty, ty->truecolor.colors[id], id);
+             ty->truecolor.count++;
+          }
+     }
+   ty->truecolor.collections++;
+   DBG("exact truecolors: %d still in use after collection",
+       ty->truecolor.count);
+}
+
+/* Returns the id of the color @rgb (as 0xRRGGBB), or -1 if the table is full
+ * of colors in use */
+int
+termpty_truecolor_id_get(Termpty *ty, uint32_t rgb)
+{
+   int id;
+
+   id = termpty_truecolor_find(ty, rgb);
+   if (id >= 0)
+     return id;
+
+   if (!ty->truecolor.colors)
+     {
+        ty->truecolor.colors = malloc(TERMPTY_TRUECOLOR_MAX *
+                                      sizeof(uint32_t));
+        ty->truecolor.hash = calloc(TRUECOLOR_HASH_LEN, sizeof(uint16_t));
+        if (!ty->truecolor.colors || !ty->truecolor.hash)
+          {
+             free(ty->truecolor.colors);
+             free(ty->truecolor.hash);
+             ty->truecolor.colors = NULL;
+             ty->truecolor.hash = NULL;
+             return -1;
+          }
+        memset(ty->truecolor.colors, 0xff,
+               TERMPTY_TRUECOLOR_MAX * sizeof(uint32_t));
+     }
+   if (ty->truecolor.count == TERMPTY_TRUECOLOR_MAX)
+     {
+        if (ty->truecolor.backoff > 0)
+          {
+             ty->truecolor.backoff--;
+             return -1;
+          }
+        _truecolor_collect(ty);
+        if (ty->truecolor.count > TERMPTY_TRUECOLOR_MAX * 3 / 4)
+          ty->truecolor.backoff = TERMPTY_TRUECOLOR_MAX / 4;
+        if (ty->truecolor.count == TERMPTY_TRUECOLOR_MAX)
+          return -1;
+     }
+   for (id = 0; id < TERMPTY_TRUECOLOR_MAX; id++)
+     {
+        if (ty->truecolor.colors[id] == TERMPTY_TRUECOLOR_FREE)
+          break;
+     }
+   ty->truecolor.colors[id] = rgb;
+   _truecolor_hash_add(ty, rgb, id);
+   ty->truecolor.count++;
+   return id;
+}
+
+#if defined(BINARY_TYTEST)
+int
+tytest_truecolor_ids(void)
+{
+   Termpty ty;
+   Termcell *cells;
+   Termatt att;
+   uint32_t rgb;
+   int id, i;
+
+   memset(&ty, 0, sizeof(ty));
+   assert(termpty_atts_init(&ty));
+   cells = calloc(TERMPTY_TRUECOLOR_MAX, sizeof(Termcell));
+   assert(cells);
+   ty.screen = cells;
+   ty.w = TERMPTY_TRUECOLOR_MAX;
+   ty.h = 1;
+
+   assert(termpty_truecolor_find(&ty, 0x123456) == -1);
+   for (rgb = 0; rgb < TERMPTY_TRUECOLOR_MAX; rgb++)
+     {
+        id = termpty_truecolor_id_get(&ty, rgb * 0x010101);
+        assert(id == (int)rgb);
+     }
+   assert(termpty_truecolor_id_get(&ty, 0x050505) == 5);
+   assert(termpty_truecolor_find(&ty, 0x0a0a0a) == 10);
+   assert(termpty_truecolor_find(&ty, 0x123456) == -1);
+
+   /* full: only the colors used by the state or the screen survive */
+   ty.termstate.att.fgrgb = 1;
+   ty.termstate.att.fg_hi = 1000 >> 8;
+   ty.termstate.att.fg = 1000 & 0xff;
+   memset(&att, 0, sizeof(att));
+   att.bgrgb = 1;
+   att.bg_hi = 2047 >> 8;
+   att.bg = 2047 & 0xff;
+   termpty_cell_att_set(&ty, &cells[1], &att);
+   memset(&att, 0, sizeof(att));
+   att.fg = 3;
+   termpty_cell_att_set(&ty, &cells[0], &att);
+   assert(termpty_truecolor_id_get(&ty, 0x123456) == 0);
+   assert(ty.truecolor.count == 3);
+   assert(ty.truecolor.collections == 1);
+   assert(termpty_truecolor_find(&ty, 1000 * 0x010101) == 1000);
+   assert(termpty_truecolor_find(&ty, 2047 * 0x010101) == 2047);
+   assert(termpty_truecolor_find(&ty, 3 * 0x010101) == -1);
+   assert(termpty_truecolor_find(&ty, 0x123456) == 0);
+   assert(termpty_truecolor_id_get(&ty, 0x654321) == 1);
+
+   /* full of colors in use */
+   for (i = 0; i < TERMPTY_TRUECOLOR_MAX; i++)
+     {
+        id = termpty_truecolor_id_get(&ty, 0x800000 | i);
+        if (id < 0)
+          break;
+        termpty_cell_att_get(&ty, &cells[i], &att);
+        att.fgrgb = 1;
+        att.fg_hi = id >> 8;
+        att.fg = id & 0xff;
+        termpty_cell_att_set(&ty, &cells[i], &att);
+     }
+   assert(id == -1);
+   /* ids 0 and 1 were unused, 1000 and 2047 still are */
+   assert(i == TERMPTY_TRUECOLOR_MAX - 2);
+   assert(ty.truecolor.count == TERMPTY_TRUECOLOR_MAX);
+   assert(ty.truecolor.collections == 2);
+   assert(termpty_truecolor_find(&ty, 0x123456) == -1);
+   assert(termpty_truecolor_find(&ty, 0x800000) >= 0);
+
+   /* that collection freed little: the next one waits, the color refused
+    * above counts */
+   for (i = 1; i < TERMPTY_TRUECOLOR_MAX / 4; i++)
+     assert(termpty_truecolor_id_get(&ty, 0x400000 | i) == -1);
+   assert(ty.truecolor.collections == 2);
+   termpty_cell_att_get(&ty, &cells[5], &att);
+   att.fgrgb = 0;
+   termpty_cell_att_set(&ty, &cells[5], &att);
+   assert(termpty_truecolor_id_get(&ty, 0x400000) >= 0);
+   assert(ty.truecolor.collections == 3);
+
+   free(ty.truecolor.colors);
+   free(ty.truecolor.hash);
+   termpty_atts_shutdown(&ty);
+   free(cells);
+   return 0;
+}
+
+int
+tytest_colors_default(void)
+{
+   int fg, bg;
+
+   fg = bg = COL_DEF;
+   termpty_colors_default_resolve(&fg, &bg, 0, 0, EINA_FALSE);
+   assert((fg == COL_DEF) && (bg == COL_INVIS));
+   fg = bg = COL_DEF;
+   termpty_colors_default_resolve(&fg, &bg, 0, 0, EINA_TRUE);
+   assert((fg == COL_INVERSEBG) && (bg == COL_INVERSE));
+
+   /* color 0 of the extended palette, with or without reverse video */
+   fg = bg = 0;
+   termpty_colors_default_resolve(&fg, &bg, 1, 1, EINA_FALSE);
+   assert((fg == 0) && (bg == 0));
+   termpty_colors_default_resolve(&fg, &bg, 1, 1, EINA_TRUE);
+   assert((fg == 0) && (bg == 0));
+   fg = bg = 0;
+   termpty_colors_default_resolve(&fg, &bg, 1, 0, EINA_TRUE);
+   assert((fg == 0) && (bg == COL_INVERSE));
+   fg = bg = 0;
+   termpty_colors_default_resolve(&fg, &bg, 0, 1, EINA_TRUE);
+   assert((fg == COL_INVERSEBG) && (bg == 0));
+
+   /* other colors are left alone */
+   fg = COL_RED;
+   bg = COL_BLUE;
+   termpty_colors_default_resolve(&fg, &bg, 0, 0, EINA_TRUE);
+   assert((fg == COL_RED) && (bg == COL_BLUE));
+   return 0;
+}
+
+int
+tytest_atts(void)
+{
+   Termpty ty;
+   Termcell *cells;
+   Termatt att, att2;
+   uint32_t id, id2, i;
+
+   memset(&ty, 0, sizeof(ty));
+   assert(termpty_atts_init(&ty));
+   cells = calloc(4096, sizeof(Termcell));
+   assert(cells);
+   ty.screen = cells;
+   ty.w = 4096;
+   ty.h = 1;
+
+   /* the flags of the cells are not part of the attributes */
+   memset(&att, 0, sizeof(att));
+   assert(termpty_att_id_get(&ty, &att) == 0);
+   att.dblwidth = 1;
+   att.newline = 1;
+   att.tab_last = 1;
+   assert(termpty_att_id_get(&ty, &att) == 0);
+   att.bold = 1;
+   att.fg = 3;
+   id = termpty_att_id_get(&ty, &att);
+   assert(id == 1);
+   termpty_cell_att_set(&ty, &cells[0], &att);
+   assert(cells[0].att_id == 1);
+   assert(cells[0].dblwidth && cells[0].newline && cells[0].tab_last);
+   assert(!cells[0].autowrapped && !cells[0].tab_inserted);
+   termpty_cell_att_get(&ty, &cells[0], &att2);
+   assert(!memcmp(&att, &att2, sizeof(att)));
+   assert(!TERMPTY_CELL_ATT(&ty, &cells[0])->dblwidth);
+   att.underline = 1;
+   id2 = termpty_att_id_get(&ty, &att);
+   assert(id2 == 2);
+   att.underline = 0;
+   assert(termpty_att_id_get(&ty, &att) == 1);
+
+   /* the table grows while small */
+   memset(&att, 0, sizeof(att));
+   for (i = 3; i < 4096; i++)
+     {
+        att.link_id = i;
+        assert(termpty_att_id_get(&ty, &att) == i);
+     }
+   assert(ty.atts.size == 4096);
+   assert(ty.atts.used == 4096);
+   assert(ty.atts.collections == 0);
+   att.link_id = 42;
+   termpty_cell_att_set(&ty, &cells[1], &att);
+   att.link_id = 4000;
+   termpty_cell_att_set(&ty, &cells[2], &att);
+
+   /* then the ids no longer in use are collected, lowest ones first */
+   att.link_id = 5000;
+   id = termpty_att_id_get(&ty, &att);
+   assert(ty.atts.collections == 1);
+   assert(ty.atts.size == 4096);
+   assert(ty.atts.nfree == 4096 - 4 - 1);
+   assert(id == 2);
+   assert(TERMPTY_CELL_ATT(&ty, &cells[0])->fg == 3);
+   assert(TERMPTY_CELL_ATT(&ty, &cells[1])->link_id == 42);
+   assert(TERMPTY_CELL_ATT(&ty, &cells[2])->link_id == 4000);
+   att.link_id = 4000;
+   assert(termpty_att_id_get(&ty, &att) == 4000);
+   att.link_id = 4095;
+   assert(termpty_att_id_get(&ty, &att) == 3);
+
+   /* and grows when most ids are in use */
+   memset(&att, 0, sizeof(att));
+   att.italic = 1;
+   for (i = 3; i < 4096; i++)
+     {
+        att.fg = i & 0xff;
+        att.bg = i >> 8;
+        termpty_cell_att_set(&ty, &cells[i], &att);
+     }
+   assert(ty.atts.collections == 2);
+   assert(ty.atts.size == 8192);
+   for (i = 3; i < 4096; i++)
+     {
+        assert(TERMPTY_CELL_ATT(&ty, &cells[i])->fg == (i & 0xff));
+        assert(TERMPTY_CELL_ATT(&ty, &cells[i])->bg == (i >> 8));
+     }
+   assert(TERMPTY_CELL_ATT(&ty, &cells[1])->link_id == 42);
+
+   /* but not while cells are held out of sight */
+   ty.atts.held = EINA_TRUE;
+   att.italic = 0;
+   att.underline = 1;
+   for (i = 0; i < 8192; i++)
+     {
+        att.fg = i & 0xff;
+        att.bg = i >> 8;
+        assert(termpty_att_id_get(&ty, &att));
+     }
+   assert(ty.atts.collections == 2);
+   assert(ty.atts.size == 16384);
+   ty.atts.held = EINA_FALSE;
+
+   termpty_atts_shutdown(&ty);
+   free(cells);
+   return 0;
+}
+
+int
+tytest_row_flags(void)
+{
+   Termpty ty;
+   Termcell *cells;
+   Termatt att;
+
+   memset(&ty, 0, sizeof(ty));
+   assert(termpty_atts_init(&ty));
+   ty.w = 4;
+   ty.h = 3;
+   ty.screen = calloc(ty.w * ty.h, sizeof(Termcell));
+   ty.screen2 = calloc(ty.w * ty.h, sizeof(Termcell));
+   assert(ty.screen && ty.screen2);
+   ty.hl.size = 4;
+   ty.hl.links = calloc(ty.hl.size, sizeof(Term_Link));
+   ty.hl.bitmap = calloc(1, HL_LINKS_MAX / 8);
+   assert(ty.hl.links && ty.hl.bitmap);
+   ty.hl.bitmap[0] = 1 | (1 << 1);
+   assert(termpty_row_flags_reset(&ty));
+   cells = ty.screen;
+
+   memset(&att, 0, sizeof(att));
+   att.link_id = 1;
+   termpty_cell_codepoint_att_fill(&ty, 'a', att, &cells[6], 1);
+   assert(ty.hl.links[1].refcount == 1);
+   assert(ty.row_flags[0] == 0);
+   assert(ty.row_flags[1] == TERMPTY_ROW_LINKS);
+   assert(ty.row_flags2[1] == 0);
+   assert(termpty_rows_flags(&ty, &cells[3], 2) == TERMPTY_ROW_LINKS);
+   assert(termpty_rows_flags(&ty, &cells[0], 4) == 0);
+   /* outside of the screens, anything may be there */
+   assert(termpty_rows_flags(&ty, &att, 1) == TERMPTY_ROW_ANY);
+
+   /* a copy brings the flags along */
+   TERMPTY_CELL_COPY(&ty, &cells[4], &cells[8], 4);
+   assert(ty.hl.links[1].refcount == 2);
+   assert(ty.row_flags[2] == TERMPTY_ROW_LINKS);
+
+   /* partly clearing a row keeps its flags, clearing it all resets them */
+   termpty_cell_fill(&ty, NULL, &cells[4], 3);
+   assert(ty.hl.links[1].refcount == 1);
+   assert(ty.row_flags[1] == TERMPTY_ROW_LINKS);
+   termpty_cell_fill(&ty, NULL, &cells[2], 10);
+   assert(ty.hl.links[1].refcount == 0);
+   assert(ty.row_flags[0] == 0);
+   assert(ty.row_flags[1] == 0);
+   assert(ty.row_flags[2] == 0);
+
+   /* the flags follow the screens */
+   termpty_cells_set_content(&ty, &ty.screen2[0], 0x80000000, 1);
+   termpty_screen_swap(&ty);
+   assert(ty.row_flags[0] == TERMPTY_ROW_BLOCKS);
+   assert(ty.row_flags2[0] == 0);
+
+   free(ty.screen);
+   free(ty.screen2);
+   free(ty.row_flags);
+   free(ty.row_flags2);
+   free(ty.hl.links);
+   free(ty.hl.bitmap);
+   termpty_atts_shutdown(&ty);
+   return 0;
+}
+
+int
+tytest_clusters(void)
+{
+   Termpty ty;
+   Termcell *cells;
+   Eina_Unicode cp, cp2, codepoints[TERMPTY_CLUSTER_LEN];
+   char txt[TERMPTY_CLUSTER_UTF8_MAX];
+   uint32_t i;
+   int n;
+
+   memset(&ty, 0, sizeof(ty));
+   assert(termpty_clusters_init(&ty));
+   cells = calloc(CLUSTERS_COLLECT_MIN, sizeof(Termcell));
+   assert(cells);
+   ty.screen = cells;
+   ty.w = CLUSTERS_COLLECT_MIN;
+   ty.h = 1;
+
+   /* clusters are interned */
+   cp = termpty_cluster_append(&ty, 'e', 0x301);
+   assert(TERMPTY_CODEPOINT_IS_CLUSTER(cp));
+   assert(cp == (TERMPTY_CLUSTER_FLAG | 1));
+   assert(termpty_cluster_append(&ty, 'e', 0x301) == cp);
+   assert(termpty_codepoint_base(&ty, cp) == 'e');
+   assert(termpty_codepoint_base(&ty, 'e') == 'e');
+   cp2 = termpty_cluster_append(&ty, cp, 0x327);
+   assert(cp2 != cp);
+   n = termpty_cluster_codepoints_get(&ty, cp2, codepoints);
+   assert(n == 3);
+   assert(codepoints[0] == 'e' && codepoints[1] == 0x301 &&
+          codepoints[2] == 0x327);
+   assert(termpty_codepoint_to_utf8(&ty, cp2, txt) == 5);
+   assert(!strcmp(txt, "e\xcc\x81\xcc\xa7"));
+   assert(termpty_codepoint_to_utf8(&ty, 'e', txt) == 1);
+
+   /* drawn as the precomposed form of the base and the first mark */
+   assert(termpty_codepoint_glyph(&ty, cp) == 0xe9);
+   assert(termpty_codepoint_glyph(&ty, cp2) == 0xe9);
+   assert(termpty_codepoint_glyph(&ty, 'e') == 'e');
+   assert(termpty_codepoint_glyph(&ty,
+            termpty_cluster_append(&ty, 'a', 0x300)) == 0xe0);
+   assert(termpty_codepoint_glyph(&ty,
+            termpty_cluster_append(&ty, 'c', 0x327)) == 0xe7);
+   assert(termpty_codepoint_glyph(&ty,
+            termpty_cluster_append(&ty, 'A', 0x300)) == 0xc0);
+   assert(termpty_codepoint_glyph(&ty,
+            termpty_cluster_append(&ty, 'z', 0x30c)) == 0x17e);
+   /* else as the base alone */
+   assert(termpty_codepoint_glyph(&ty,
+            termpty_cluster_append(&ty, 'q', 0x301)) == 'q');
+   assert(termpty_codepoint_glyph(&ty,
+            termpty_cluster_append(&ty, 0x4e00, 0x301)) == 0x4e00);
+
+   /* full clusters stay as they are */
+   cp = 'o';
+   for (n = 1; n < TERMPTY_CLUSTER_LEN; n++)
+     cp = termpty_cluster_append(&ty, cp, 0x300 + n);
+   assert(termpty_cluster_codepoints_get(&ty, cp, codepoints) ==
+          TERMPTY_CLUSTER_LEN);
+   assert(termpty_cluster_append(&ty, cp, 0x30a) == cp);
+
+   /* only the clusters still in a cell are kept once the table is full */
+   cells[0].codepoint = cp2;
+   for (i = 0; ty.clusters.used < CLUSTERS_COLLECT_MIN; i++)
+     termpty_cluster_append(&ty, 0x4e00 + i, 0x301);
+   assert(ty.clusters.collections == 0);
+   cp = termpty_cluster_append(&ty, 'a', 0x301);
+   assert(ty.clusters.collections == 1);
+   assert(ty.clusters.size == CLUSTERS_COLLECT_MIN);
+   assert((cp & ~TERMPTY_CLUSTER_FLAG) != (cp2 & ~TERMPTY_CLUSTER_FLAG));
+   n = termpty_cluster_codepoints_get(&ty, cp2, codepoints);
+   assert(n == 3 && codepoints[2] == 0x327);
+   /* a collected cluster is made again */
+   assert(termpty_cluster_append(&ty, 'e', 0x301) != cp);
+
+   free(cells);
+   termpty_clusters_shutdown(&ty);
+   return 0;
+}
+#endif
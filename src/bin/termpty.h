@@ -2,13 +2,18 @@
 #define TERMINOLOGY_TERMPTY_H_ 1
 
 #include "config.h"
+#include "colors.h"
 #include "media.h"
 #include "sb.h"
+#include "utf8.h"
+#include "utils.h"
 
 typedef struct tag_Termcell      Termcell;
 typedef struct tag_Termatt       Termatt;
 typedef struct tag_Termsave      Termsave;
 typedef struct tag_Termsavecomp  Termsavecomp;
+typedef struct tag_Termspill     Termspill;
+typedef struct tag_Termchunk     Termchunk;
 typedef struct tag_Termblock     Termblock;
 typedef struct tag_Termexp       Termexp;
 typedef struct tag_Termpty       Termpty;
@@ -49,6 +54,18 @@ typedef struct tag_TitleIconElem TitleIconElem;
 
 #define HL_LINKS_MAX  (1 << 16)
 
+/* What an incomplete sequence is waiting for */
+#define TERMPTY_PARSER_GROUND          0
+#define TERMPTY_PARSER_ESCAPE          1
+#define TERMPTY_PARSER_CSI_PARAM       2
+#define TERMPTY_PARSER_OSC_STRING      3
+#define TERMPTY_PARSER_DCS_PASSTHROUGH 4
+#define TERMPTY_PARSER_TERMINOLOGY     5
+
+/* Synchronized output (DEC private mode 2026) ends by itself after this
+ * many seconds, should the application never end it */
+#define TERMPTY_SYNC_OUTPUT_TIMEOUT 0.15
+
 struct tag_Termlink
 {
     const char *key;
@@ -65,7 +82,7 @@ struct tag_Termatt
    unsigned short bold : 1;
    unsigned short faint : 1;
    unsigned short italic : 1;
-   unsigned short dblwidth : 1;
+   unsigned short dblwidth : 1; // per cell, see Termcell
    unsigned short underline : 1;
    unsigned short blink : 1; // don't intend to support this currently
    unsigned short blink2 : 1; // don't intend to support this currently
@@ -76,20 +93,25 @@ struct tag_Termatt
    unsigned short bg256 : 1;
    unsigned short fgintense : 1;
    unsigned short bgintense : 1;
-   // below used for working out text from selections
+   // below used for working out text from selections, per cell
    unsigned short autowrapped : 1;
    unsigned short newline : 1;
    unsigned short fraktur : 1;
    unsigned short framed : 1;
    unsigned short encircled : 1;
    unsigned short overlined : 1; // TODO: support it
-   unsigned short tab_inserted : 1;
-   unsigned short tab_last : 1;
+   unsigned short tab_inserted : 1; // per cell
+   unsigned short tab_last : 1; // per cell
+   // fg/bg and fg_hi/bg_hi are an index in Termpty.truecolor instead
+   unsigned short fgrgb : 1;
+   unsigned short bgrgb : 1;
+   unsigned short fg_hi : 3;
+   unsigned short bg_hi : 3;
 #if defined(SUPPORT_80_132_COLUMNS)
    unsigned short is_80_132_mode_allowed : 1;
-   unsigned short bit_padding :  9;
+   unsigned short bit_padding :  1;
 #else
-   unsigned short bit_padding : 10;
+   unsigned short bit_padding :  2;
 #endif
    uint16_t       link_id;
 };
@@ -99,6 +121,15 @@ typedef struct tag_Backlog_Beacon{
     int backlog_y;
 } Backlog_Beacon;
 
+/* Fenwick tree of the visual rows each slot of the backlog takes, so that
+ * lines are found from screen coordinates in logarithmic time */
+typedef struct tag_Backlog_Index
+{
+   int *rows;
+   int w; // of the screen the rows are counted for, 0 to rebuild the tree
+   size_t lines; // shown, from the newest one up to the first empty slot
+} Backlog_Index;
+
 typedef enum exmod {
      XMOD_KEYBOARD = 0,
      XMOD_CURSOR = 1,
@@ -137,18 +168,121 @@ typedef struct tag_Term_State {
     int xmod[6];
 } Term_State;
 
+/* Attributes an SGR sequence led to, see _handle_esc_csi_sgr() */
+#define TERMPTY_SGR_CACHE_LEN 64 /* power of 2 */
+#define TERMPTY_SGR_KEY_MAX 32
+
+typedef struct tag_Termpty_Sgr {
+    Termatt       in, out;
+    unsigned char used;
+    unsigned char len;
+    char          key[TERMPTY_SGR_KEY_MAX];
+} Termpty_Sgr;
+
+/* Exact truecolors, see termpty_truecolor_id_get() */
+#define TERMPTY_TRUECOLOR_MAX 2048 /* ids fit in 3 + 8 bits of Termatt */
+#define TERMPTY_TRUECOLOR_FREE 0xffffffff
+
+#define TERMATT_FG_ID(Att) (((Att).fg_hi << 8) | (Att).fg)
+#define TERMATT_BG_ID(Att) (((Att).bg_hi << 8) | (Att).bg)
+
+/* What the cells of a row may hold, so that bulk operations can skip the
+ * checks done for each cell. Set when such a cell is written, cleared when
+ * the whole row is overwritten */
+#define TERMPTY_ROW_LINKS  (1 << 0)
+#define TERMPTY_ROW_BLOCKS (1 << 1)
+#define TERMPTY_ROW_ANY    (TERMPTY_ROW_LINKS | TERMPTY_ROW_BLOCKS)
+
+/* Interned cell attributes, see termpty_att_id_get() */
+#define TERMPTY_ATTS_MAX (1 << 24) /* ids fit in Termcell.att_id */
+
+/* Cells holding more than one codepoint, a base and what combines with it,
+ * refer to a cluster by id: the codepoint is then TERMPTY_CLUSTER_FLAG | id.
+ * Unlike blocks, that is bit 30 and not bit 31, see termpty_cluster_append()
+ */
+#define TERMPTY_CLUSTER_FLAG 0x40000000
+#define TERMPTY_CLUSTER_LEN 8 /* codepoints at most, more are dropped */
+#define TERMPTY_CLUSTERS_MAX (1 << 20)
+#define TERMPTY_CODEPOINT_IS_CLUSTER(Codepoint) \
+   (((Codepoint) & 0xc0000000) == TERMPTY_CLUSTER_FLAG)
+/* Room needed by termpty_codepoint_to_utf8() */
+#define TERMPTY_CLUSTER_UTF8_MAX (TERMPTY_CLUSTER_LEN * 4 + 1)
+
+typedef struct tag_Termcluster {
+   Eina_Unicode codepoints[TERMPTY_CLUSTER_LEN]; /* 0 after the last one */
+} Termcluster;
+
+/* Truecolor approximations cache, see _tcc_find() */
+#define TERMPTY_TCC_SETS_BITS 5
+#define TERMPTY_TCC_WAYS 4
+
 typedef struct tag_Term_Cursor {
     int cx;
     int cy;
     unsigned char wrapnext : 1;
 } Term_Cursor;
 
+/* Cells of the backlog lines of a size class are carved out of chunks,
+ * see backlog.c */
+#define TERMPTY_ARENA_CLASSES 13
+
+typedef struct tag_Termarena
+{
+   Termchunk     *first, *last; // chunks with free slots first
+   unsigned int   nchunks;
+   unsigned int   used; // slots in use
+} Termarena;
+
+/* Blocks of the backlog recently decompressed, see termpty_save_cells_get()
+ */
+#define TERMPTY_CACHE_SIZE 8
+
+typedef struct tag_Termcache
+{
+   const Termsavecomp *block;
+   Termcell     *cells;
+   unsigned int  size; // in cells
+   unsigned int  last_use;
+} Termcache;
+
+/* Callbacks the reader thread leaves to the main loop, see
+ * termpty_defer() */
+#define TERMPTY_DEFER_TITLE (1 << 0)
+#define TERMPTY_DEFER_ICON  (1 << 1)
+#define TERMPTY_DEFER_BELL  (1 << 2)
+
+/* How a cache of the parser fared, see termpty_tcc_stats_get() */
+typedef struct tag_Termpty_Cache_Stats
+{
+   unsigned long hits, misses, evictions;
+} Termpty_Cache_Stats;
+
 struct tag_Termpty
 {
    Evas_Object *obj;
    Config *config;
    Ecore_Event_Handler *hand_exe_exit;
    Ecore_Fd_Handler *hand_fd;
+   /* when set, output is read and parsed in this thread instead of the
+    * main loop */
+   Ecore_Thread *reader;
+   int reader_wake[2];
+   Eina_Bool threaded;
+   Eina_Bool reader_notified;
+   /* the reader thread frees the terminal once it is done */
+   Eina_Bool freeing;
+   /* guards the screens and the backlog, see termpty_backlog_lock() */
+   struct {
+      Eina_Lock lock;
+      int depth; // times the thread holding it took it
+      Eina_Bool ready;
+   } lock;
+   /* lines scrolled by the reader thread, for the main loop to tell the
+    * terminal object, see termpty_scroll() */
+   struct {
+      int direction, start_y, end_y;
+   } scrolled;
+   unsigned char deferred; // TERMPTY_DEFER_*
    struct {
       struct {
          void (*func) (void *data);
@@ -166,19 +300,60 @@ struct tag_Termpty
    } prop;
    const char *cur_cmd;
    Termcell *screen, *screen2;
+   /* rows of screen and screen2, 2 * h of them: line y is
+    * rows[y + circular_offset], the second half repeating the first */
+   Termcell **rows, **rows2;
+   /* TERMPTY_ROW_* of the rows of screen and screen2, by offset */
+   uint8_t *row_flags, *row_flags2;
    unsigned int *tabs;
    int circular_offset;
    int circular_offset2;
+   /* codepoints to parse, [bufstart, buflen[ is an incomplete sequence
+    * waiting for more input */
    Eina_Unicode *buf;
-   size_t buflen;
+   size_t bufstart, buflen, bufsize;
+   /* resumes the scan of the sequence at bufstart where it stopped */
+   struct {
+      unsigned char state;
+      size_t body; /* offset of the sequence parameters */
+      size_t scanned; /* codepoints already known not to end it */
+   } parser;
+   /* OSC and DCS strings, up to config->esc_string_max codepoints */
+   struct {
+      Eina_Unicode *buf;
+      size_t size;
+   } esc_str;
+   /* OSC 52 payload decoded while it is received */
+   struct {
+      Eina_Binbuf *data;
+      Ty_Base64_Decoder dec;
+      size_t payload; /* offset of the payload in the pending sequence */
+      size_t len;
+      Eina_Bool active;
+   } osc52;
    Eina_Unicode last_char;
-   Eina_Bool buf_have_zero;
-   unsigned char oldbuf[4];
+   Utf8_Decoder utf8;
+   /* reused across reads, sized after config->pty_read_max */
+   struct {
+      char *bytes;
+      int size;
+   } readbuf;
    Termsave *back;
+   Eina_Bool back_mapped; /* from a file, when sized while spilling */
+   Termspill *spill;
+   Termarena arena[TERMPTY_ARENA_CLASSES];
+   size_t arena_wait; /* lines to save before compacting the arena again */
    size_t backsize, backpos;
+   size_t compress_next; /* first line of the next block to compress */
+   struct {
+      Termcache entries[TERMPTY_CACHE_SIZE];
+      unsigned int use;
+   } cache;
+   uint64_t backlog_view; /* when last shown, see termpty_backlog_viewed() */
    /* this beacon in the backlog tells about the top line in screen
     * coordinates that maps to a line in the backlog */
    Backlog_Beacon backlog_beacon;
+   Backlog_Index backlog_index;
    int w, h;
    int fd, slavefd;
    struct ty_sb write_buffer;
@@ -206,6 +381,49 @@ struct tag_Termpty
       unsigned char is_top_to_bottom : 1;
    } selection;
    Term_State termstate;
+   /* recent SGR sequences, keyed on their parameters and the attributes
+    * they applied to */
+   struct {
+      Termpty_Sgr entries[TERMPTY_SGR_CACHE_LEN];
+      unsigned long hits, misses;
+   } sgr_cache;
+   /* nearest colors in the extended palette, for truecolors */
+   Color_Lut *color_lut;
+   /* recent truecolor approximations */
+   struct {
+      uint32_t colors[1 << TERMPTY_TCC_SETS_BITS][TERMPTY_TCC_WAYS];
+      uint8_t used[1 << TERMPTY_TCC_SETS_BITS];
+      unsigned long hits, misses, evictions;
+   } tcc;
+   /* colors referenced by cells with fgrgb or bgrgb set */
+   struct {
+      uint32_t *colors; /* 0xRRGGBB by id */
+      uint16_t *hash; /* id + 1, 0 for empty buckets */
+      int count;
+      int backoff; /* colors to refuse before collecting again */
+      unsigned long collections;
+   } truecolor;
+   /* attributes the cells refer to by id, id 0 being the default ones */
+   struct {
+      Termatt *table;
+      uint32_t *hash; /* id + 1, 0 for empty buckets */
+      uint32_t *free; /* ids no longer used by any cell */
+      uint32_t size, used, nfree;
+      Termatt last; /* last lookup */
+      uint32_t last_id;
+      unsigned long collections;
+      /* cells are out of the screens and the backlog, as while resizing,
+       * so that the ids in use are not known */
+      Eina_Bool held;
+   } atts;
+   /* clusters the cells refer to, see TERMPTY_CLUSTER_FLAG */
+   struct {
+      Termcluster *table;
+      uint32_t *hash; /* id + 1, 0 for empty buckets */
+      uint32_t *free; /* ids no longer used by any cell */
+      uint32_t size, used, nfree;
+      unsigned long collections;
+   } clusters;
    Term_Cursor cursor_state;
    Term_Cursor cursor_save[2];
    int exit_code;
@@ -216,6 +434,11 @@ struct tag_Termpty
    unsigned int bracketed_paste : 1;
    unsigned int decoding_error : 1;
    unsigned int focus_reporting : 1;
+   /* rendering is held while the application updates the screen */
+   struct {
+      double start;
+      Eina_Bool active;
+   } sync_output;
    struct {
        Term_Link *links;
        uint8_t *bitmap;
@@ -224,30 +447,74 @@ struct tag_Termpty
    TitleIconElem *title_icon_stack;
 };
 
+/* Attributes are interned in Termpty.atts, see TERMPTY_CELL_ATT().
+ * The flags describing the cell itself rather than how it looks are kept
+ * here and are always 0 in the table */
 struct tag_Termcell
 {
    Eina_Unicode   codepoint;
-   Termatt        att;
+   unsigned int   att_id : 24;
+   unsigned int   dblwidth : 1;
+   unsigned int   autowrapped : 1;
+   unsigned int   newline : 1;
+   unsigned int   tab_inserted : 1;
+   unsigned int   tab_last : 1;
+   unsigned int   bit_padding : 3;
 };
 
 struct tag_Termsave
 {
-   unsigned int   gen  : 8;
+   unsigned int   line : 8; // in its block, when compressed
    unsigned int   comp : 1;
    unsigned int   z    : 1;
    unsigned int   w    : 22;
-   /* TODO: union ? */
-   Termcell       *cells;
+   uint8_t        flags; /* TERMPTY_ROW_* */
+   union {
+        Termcell     *cells;
+        Termsavecomp *block; // when comp is set
+   };
 };
 
-/* TODO: RESIZE rewrite Termsavecomp */
+/* Longest line of the backlog, in cells, see Termsave.w */
+#define TERMPTY_SAVE_W_MAX ((1 << 22) - 1)
+
+/* Lines of the backlog gone cold are compressed together, see backlog.c */
+#define TERMPTY_SAVE_BLOCK_LINES 64
+
 struct tag_Termsavecomp
 {
-   unsigned int   gen  : 8;
-   unsigned int   comp : 1;
-   unsigned int   z    : 1;
-   unsigned int   w    : 22; // compressed size in bytes
+   unsigned int   lines; // lines of the backlog still stored here
+   unsigned int   size; // compressed size in bytes
    unsigned int   wout; // output width in Termcells
+   unsigned int   offsets[TERMPTY_SAVE_BLOCK_LINES]; // of each line, in cells
+   /* attributes then clusters the cells refer to, for the collections */
+   uint32_t       natts, nclusters;
+   uint32_t      *ids;
+   unsigned char *data; // NULL once spilled
+   uint64_t       offset; // in the spill file, once spilled
+   Termspill     *spill; // NULL when not to be spilled
+   Termsavecomp  *prev, *next; // blocks of spill still in memory
+};
+
+typedef struct tag_Termextent
+{
+   size_t offset, size;
+} Termextent;
+
+/* File the oldest compressed blocks of a backlog go to, when the memory
+ * they take exceeds Config.scrollback_spill, see backlog.c */
+struct tag_Termspill
+{
+   int            fd;
+   Eina_Bool      failed;
+   unsigned char *map; // the file, read only
+   size_t         map_size;
+   size_t         size; // of the file, blocks go at the end if no hole fits
+   size_t         used; // bytes of the file still holding blocks
+   size_t         mem; // bytes of the blocks still in memory
+   Termsavecomp  *first, *last; // blocks still in memory, oldest first
+   Termextent    *holes; // left by the blocks gone, by offset
+   unsigned int   nholes, holes_max;
 };
 
 struct tag_Termblock
@@ -284,6 +551,11 @@ struct tag_Termexp
 
 void       termpty_init(void);
 void       termpty_shutdown(void);
+Eina_Bool  termpty_main_loop_begin(Termpty *ty);
+void       termpty_main_loop_end(Termpty *ty);
+void       termpty_defer(Termpty *ty, unsigned char what);
+void       termpty_scroll(Termpty *ty, int direction, int start_y, int end_y);
+void       termpty_scroll_flush(Termpty *ty);
 
 Termpty   *termpty_new(const char *cmd, Eina_Bool login_shell, const char *cd,
                        int w, int h, Config *config, const char *title,
@@ -302,6 +574,7 @@ void       termpty_write(Termpty *ty, const char *input, int len);
 void       termpty_resize(Termpty *ty, int new_w, int new_h);
 void       termpty_resize_tabs(Termpty *ty, int old_w, int new_w);
 void       termpty_backscroll_adjust(Termpty *ty, int *scroll);
+Eina_Bool  termpty_sync_output_held(Termpty *ty);
 
 pid_t      termpty_pid_get(const Termpty *ty);
 void       termpty_block_free(Termblock *tb);
@@ -313,15 +586,38 @@ void       termpty_block_chid_update(Termpty *ty, Termblock *blk);
 Termblock *termpty_block_chid_get(const Termpty *ty, const char *chid);
 
 void       termpty_cell_codepoint_att_fill(Termpty *ty, Eina_Unicode codepoint, Termatt att, Termcell *dst, int n);
+void       termpty_cell_codepoints_att_fill(Termpty *ty, const Eina_Unicode *codepoints, Termatt att, Termcell *dst, int n);
 void       termpty_cells_set_content(Termpty *ty, Termcell *cells,
                           Eina_Unicode codepoint, int count);
 void       termpty_screen_swap(Termpty *ty);
+Eina_Bool  termpty_rows_init(Termpty *ty);
+Eina_Bool  termpty_row_flags_reset(Termpty *ty);
 
-ssize_t termpty_line_length(const Termcell *cells, ssize_t nb_cells);
+ssize_t termpty_line_length(const Termpty *ty, const Termcell *cells,
+                            ssize_t nb_cells);
 
-void termpty_handle_buf(Termpty *ty, const Eina_Unicode *codepoints, int len);
+Eina_Unicode *termpty_handle_buf_reserve(Termpty *ty, int len);
+void termpty_handle_buf(Termpty *ty, int len);
 void termpty_handle_block_codepoint_overwrite_heavy(Termpty *ty, int oldc, int newc);
 
+Eina_Bool  termpty_atts_init(Termpty *ty);
+void       termpty_atts_shutdown(Termpty *ty);
+uint32_t   termpty_att_id_get(Termpty *ty, const Termatt *att);
+
+Eina_Bool    termpty_clusters_init(Termpty *ty);
+void         termpty_clusters_shutdown(Termpty *ty);
+Eina_Unicode termpty_cluster_append(Termpty *ty, Eina_Unicode codepoint,
+                                    Eina_Unicode g);
+int          termpty_cluster_codepoints_get(const Termpty *ty,
+                                            Eina_Unicode codepoint,
+                                            Eina_Unicode *codepoints);
+int          termpty_codepoint_to_utf8(const Termpty *ty,
+                                       Eina_Unicode codepoint, char *txt);
+Eina_Unicode termpty_cluster_glyph(const Termpty *ty, Eina_Unicode codepoint);
+
+int        termpty_truecolor_id_get(Termpty *ty, uint32_t rgb);
+int        termpty_truecolor_find(const Termpty *ty, uint32_t rgb);
+
 Term_Link * term_link_new(Termpty *ty);
 void term_link_free(Termpty *ty, Term_Link *link);
 
@@ -334,7 +630,31 @@ termpty_focus_report(Termpty *ty, Eina_Bool focus);
 extern int _termpty_log_dom;
 
 #define TERMPTY_SCREEN(Tpty, X, Y) \
-  Tpty->screen[X + (((Y + Tpty->circular_offset) % Tpty->h) * Tpty->w)]
+  Tpty->rows[(Y) + Tpty->circular_offset][X]
+
+/* Attributes of a cell, without its own flags. The pointer is no longer
+ * valid once another attribute is interned */
+#define TERMPTY_CELL_ATT(Tpty, Cell) \
+  ((const Termatt *)&((Tpty)->atts.table[(Cell)->att_id]))
+
+/* The codepoint to display for a cell, the base of its cluster if any */
+static inline Eina_Unicode
+termpty_codepoint_base(const Termpty *ty, Eina_Unicode codepoint)
+{
+   if (EINA_UNLIKELY(TERMPTY_CODEPOINT_IS_CLUSTER(codepoint)))
+     return ty->clusters.table[codepoint & ~TERMPTY_CLUSTER_FLAG]
+        .codepoints[0];
+   return codepoint;
+}
+
+/* The codepoint to draw for a cell, see termpty_cluster_glyph() */
+static inline Eina_Unicode
+termpty_codepoint_glyph(const Termpty *ty, Eina_Unicode codepoint)
+{
+   if (EINA_UNLIKELY(TERMPTY_CODEPOINT_IS_CLUSTER(codepoint)))
+     return termpty_cluster_glyph(ty, codepoint);
+   return codepoint;
+}
 
 #define TERMPTY_RESTRICT_FIELD(Field, Min, Max) \
    do {                                         \
@@ -344,6 +664,72 @@ extern int _termpty_log_dom;
      Field = Min;                               \
    } while (0)
 
+/* Returns the flags of the row holding @cells, and sets @offset to the
+ * offset of @cells in its screen. NULL if @cells is not in a screen */
+static inline uint8_t *
+termpty_row_flags_find(const Termpty *ty, const Termcell *cells,
+                       size_t *offset)
+{
+   size_t size = (size_t)ty->w * ty->h;
+
+   if ((ty->row_flags) &&
+       (cells >= ty->screen) && (cells < ty->screen + size))
+     {
+        *offset = cells - ty->screen;
+        return ty->row_flags;
+     }
+   if ((ty->row_flags2) &&
+       (cells >= ty->screen2) && (cells < ty->screen2 + size))
+     {
+        *offset = cells - ty->screen2;
+        return ty->row_flags2;
+     }
+   return NULL;
+}
+
+/* Flags of the rows spanned by the @n cells from @cells, all of them when
+ * these cells are not in a screen */
+static inline uint8_t
+termpty_rows_flags(const Termpty *ty, const Termcell *cells, int n)
+{
+   uint8_t *row_flags, flags = 0;
+   size_t offset, y, y_end;
+
+   if (n <= 0)
+     return 0;
+   row_flags = termpty_row_flags_find(ty, cells, &offset);
+   if (!row_flags)
+     return TERMPTY_ROW_ANY;
+   y_end = (offset + n - 1) / ty->w;
+   for (y = offset / ty->w; y <= y_end; y++)
+     flags |= row_flags[y];
+   return flags;
+}
+
+/* Records that the @n cells from @cells were overwritten with cells
+ * holding @flags: rows entirely overwritten only have these */
+static inline void
+termpty_rows_flags_set(Termpty *ty, const Termcell *cells, int n,
+                       uint8_t flags)
+{
+   uint8_t *row_flags;
+   size_t offset, end, y;
+
+   if (n <= 0)
+     return;
+   row_flags = termpty_row_flags_find(ty, cells, &offset);
+   if (!row_flags)
+     return;
+   end = offset + n;
+   for (y = offset / ty->w; y * ty->w < end; y++)
+     {
+        if ((y * ty->w >= offset) && ((y + 1) * ty->w <= end))
+          row_flags[y] = flags;
+        else
+          row_flags[y] |= flags;
+     }
+}
+
 /* Try to trick the compiler into inlining the first test */
 #define HANDLE_BLOCK_CODEPOINT_OVERWRITE(Tpty, OLDC, NEWC)                   \
 do {                                                                         \
@@ -354,18 +740,28 @@ do {                                                                         \
 #define TERMPTY_CELL_COPY(Tpty, Tsrc, Tdst, N)                               \
 do {                                                                         \
    int __i;                                                                  \
+   uint8_t __src_flags = termpty_rows_flags(Tpty, Tsrc, N);                  \
                                                                              \
-   for (__i = 0; __i < N; __i++)                                             \
+   if (EINA_UNLIKELY(__src_flags | termpty_rows_flags(Tpty, Tdst, N)))       \
      {                                                                       \
-        HANDLE_BLOCK_CODEPOINT_OVERWRITE(Tpty,                               \
-                                         (Tdst)[__i].codepoint,              \
-                                         (Tsrc)[__i].codepoint);             \
-        if (EINA_UNLIKELY((Tdst)[__i].att.link_id))                          \
-          term_link_refcount_dec(ty, (Tdst)[__i].att.link_id, 1);            \
-        if (EINA_UNLIKELY((Tsrc)[__i].att.link_id))                          \
-          term_link_refcount_inc(ty, (Tsrc)[__i].att.link_id, 1);            \
+        for (__i = 0; __i < N; __i++)                                        \
+          {                                                                  \
+             uint16_t __dst_link =                                           \
+                TERMPTY_CELL_ATT(Tpty, &(Tdst)[__i])->link_id;               \
+             uint16_t __src_link =                                           \
+                TERMPTY_CELL_ATT(Tpty, &(Tsrc)[__i])->link_id;               \
+                                                                             \
+             HANDLE_BLOCK_CODEPOINT_OVERWRITE(Tpty,                          \
+                                              (Tdst)[__i].codepoint,         \
+                                              (Tsrc)[__i].codepoint);        \
+             if (EINA_UNLIKELY(__dst_link))                                  \
+               term_link_refcount_dec(Tpty, __dst_link, 1);                  \
+             if (EINA_UNLIKELY(__src_link))                                  \
+               term_link_refcount_inc(Tpty, __src_link, 1);                  \
+          }                                                                  \
      }                                                                       \
    memcpy(Tdst, Tsrc, N * sizeof(Termcell));                                 \
+   termpty_rows_flags_set(Tpty, Tdst, N, __src_flags);                       \
 } while (0)
 
 
@@ -408,34 +804,119 @@ term_link_eq(Termpty *ty, Term_Link *hl, uint16_t link_id)
     return (strcmp(hl->url, hl2->url) == 0);
 }
 
+/* All the fields of @att in one integer, to compare or hash attributes
+ * without looking at the padding and unused bits of the structure */
+static inline uint64_t
+termpty_att_pack(const Termatt *att)
+{
+   uint64_t v;
+
+   v = att->fg | (att->bg << 8) | ((uint64_t)att->link_id << 16);
+   v |= (uint64_t)(att->bold | (att->faint << 1) | (att->italic << 2) |
+                   (att->dblwidth << 3) | (att->underline << 4) |
+                   (att->blink << 5) | (att->blink2 << 6) |
+                   (att->inverse << 7) | (att->invisible << 8) |
+                   (att->strike << 9) | (att->fg256 << 10) |
+                   (att->bg256 << 11) | (att->fgintense << 12) |
+                   (att->bgintense << 13) | (att->autowrapped << 14) |
+                   (att->newline << 15)) << 32;
+   v |= (uint64_t)(att->fraktur | (att->framed << 1) |
+                   (att->encircled << 2) | (att->overlined << 3) |
+                   (att->tab_inserted << 4) | (att->tab_last << 5) |
+                   (att->fgrgb << 6) | (att->bgrgb << 7) |
+                   (att->fg_hi << 8) | (att->bg_hi << 11)) << 48;
+#if defined(SUPPORT_80_132_COLUMNS)
+   v |= (uint64_t)att->is_80_132_mode_allowed << 62;
+#endif
+   return v;
+}
+
+/* Resolves COL_DEF in @fg and @bg to the colors drawn for a cell in reverse
+ * video (@inverse) or not. Color 0 of the extended palette (@fgext, @bgext)
+ * has the same value but is a color of its own, left as it is */
+static inline void
+termpty_colors_default_resolve(int *fg, int *bg, int fgext, int bgext,
+                               Eina_Bool inverse)
+{
+   if ((*fg == COL_DEF) && (!fgext) && (inverse))
+     *fg = COL_INVERSEBG;
+   if ((*bg == COL_DEF) && (!bgext))
+     *bg = (inverse) ? COL_INVERSE : COL_INVIS;
+}
+
+/* Sets the attributes of @cell and its own flags from @att */
+static inline void
+termpty_cell_att_set(Termpty *ty, Termcell *cell, const Termatt *att)
+{
+   cell->att_id = termpty_att_id_get(ty, att);
+   cell->dblwidth = att->dblwidth;
+   cell->autowrapped = att->autowrapped;
+   cell->newline = att->newline;
+   cell->tab_inserted = att->tab_inserted;
+   cell->tab_last = att->tab_last;
+}
+
+/* Reverse of termpty_cell_att_set() */
+static inline void
+termpty_cell_att_get(const Termpty *ty, const Termcell *cell, Termatt *att)
+{
+   *att = *TERMPTY_CELL_ATT(ty, cell);
+   att->dblwidth = cell->dblwidth;
+   att->autowrapped = cell->autowrapped;
+   att->newline = cell->newline;
+   att->tab_inserted = cell->tab_inserted;
+   att->tab_last = cell->tab_last;
+}
+
 static inline void
 termpty_cell_fill(Termpty *ty, Termcell *src, Termcell *dst, int n)
 {
+   uint8_t flags = 0;
    int i;
 
+   if (n <= 0)
+     return;
    if (src)
      {
+        uint16_t link_id = TERMPTY_CELL_ATT(ty, src)->link_id;
+
+        if (link_id)
+          flags |= TERMPTY_ROW_LINKS;
+        if (src->codepoint & 0x80000000)
+          flags |= TERMPTY_ROW_BLOCKS;
+        if (EINA_LIKELY(!(flags | termpty_rows_flags(ty, dst, n))))
+          {
+             for (i = 0; i < n; i++)
+               dst[i] = src[0];
+             termpty_rows_flags_set(ty, dst, n, 0);
+             return;
+          }
         for (i = 0; i < n; i++)
           {
              HANDLE_BLOCK_CODEPOINT_OVERWRITE(ty, dst[i].codepoint, src[0].codepoint);
-             if (EINA_UNLIKELY(dst[i].att.link_id))
-               term_link_refcount_dec(ty, dst[i].att.link_id, 1);
+             if (EINA_UNLIKELY(TERMPTY_CELL_ATT(ty, &dst[i])->link_id))
+               term_link_refcount_dec(ty, TERMPTY_CELL_ATT(ty, &dst[i])->link_id, 1);
 
              dst[i] = src[0];
           }
-        if (src[0].att.link_id)
-          term_link_refcount_inc(ty, src[0].att.link_id, n);
+        if (link_id)
+          term_link_refcount_inc(ty, link_id, n);
+     }
+   else if (EINA_LIKELY(!termpty_rows_flags(ty, dst, n)))
+     {
+        memset(dst, 0, n * sizeof(*dst));
      }
    else
      {
         for (i = 0; i < n; i++)
           {
              HANDLE_BLOCK_CODEPOINT_OVERWRITE(ty, dst[i].codepoint, 0);
-             if (EINA_UNLIKELY(dst[i].att.link_id))
-               term_link_refcount_dec(ty, dst[i].att.link_id, 1);
+             if (EINA_UNLIKELY(TERMPTY_CELL_ATT(ty, &dst[i])->link_id))
+               term_link_refcount_dec(ty, TERMPTY_CELL_ATT(ty, &dst[i])->link_id, 1);
 
              memset(&(dst[i]), 0, sizeof(*dst));
           }
      }
+   termpty_rows_flags_set(ty, dst, n, flags);
 }
 #endif
@@ -5,699 +5,1058 @@
 #include "termpty.h"
 #include "termptydbl.h"
 
-__attribute__((const))
-Eina_Bool
-_termpty_is_ambigous_wide(Eina_Unicode g, Eina_Bool emoji_dbl_width)
+const uint8_t _termpty_dbl_pages[2][2][3586] =
 {
-   if (emoji_dbl_width)
-     {
-        switch (g)
-          {
-           case 0xA1: EINA_FALLTHROUGH;
-           case 0xA4: EINA_FALLTHROUGH;
-           case 0xA7 ... 0xAA: EINA_FALLTHROUGH;
-           case 0xAD ... 0xAE: EINA_FALLTHROUGH;
-           case 0xB0 ... 0xB4: EINA_FALLTHROUGH;
-           case 0xB6 ... 0xBA: EINA_FALLTHROUGH;
-           case 0xBC ... 0xBF: EINA_FALLTHROUGH;
-           case 0xC6: EINA_FALLTHROUGH;
-           case 0xD0: EINA_FALLTHROUGH;
-           case 0xD7 ... 0xD8: EINA_FALLTHROUGH;
-           case 0xDE ... 0xE1: EINA_FALLTHROUGH;
-           case 0xE6: EINA_FALLTHROUGH;
-           case 0xE8 ... 0xEA: EINA_FALLTHROUGH;
-           case 0xEC ... 0xED: EINA_FALLTHROUGH;
-           case 0xF0: EINA_FALLTHROUGH;
-           case 0xF2 ... 0xF3: EINA_FALLTHROUGH;
-           case 0xF7 ... 0xFA: EINA_FALLTHROUGH;
-           case 0xFC: EINA_FALLTHROUGH;
-           case 0xFE: EINA_FALLTHROUGH;
-           case 0x101: EINA_FALLTHROUGH;
-           case 0x111: EINA_FALLTHROUGH;
-           case 0x113: EINA_FALLTHROUGH;
-           case 0x11B: EINA_FALLTHROUGH;
-           case 0x126 ... 0x127: EINA_FALLTHROUGH;
-           case 0x12B: EINA_FALLTHROUGH;
-           case 0x131 ... 0x133: EINA_FALLTHROUGH;
-           case 0x138: EINA_FALLTHROUGH;
-           case 0x13F ... 0x142: EINA_FALLTHROUGH;
-           case 0x144: EINA_FALLTHROUGH;
-           case 0x148 ... 0x14B: EINA_FALLTHROUGH;
-           case 0x14D: EINA_FALLTHROUGH;
-           case 0x152 ... 0x153: EINA_FALLTHROUGH;
-           case 0x166 ... 0x167: EINA_FALLTHROUGH;
-           case 0x16B: EINA_FALLTHROUGH;
-           case 0x1CE: EINA_FALLTHROUGH;
-           case 0x1D0: EINA_FALLTHROUGH;
-           case 0x1D2: EINA_FALLTHROUGH;
-           case 0x1D4: EINA_FALLTHROUGH;
-           case 0x1D6: EINA_FALLTHROUGH;
-           case 0x1D8: EINA_FALLTHROUGH;
-           case 0x1DA: EINA_FALLTHROUGH;
-           case 0x1DC: EINA_FALLTHROUGH;
-           case 0x251: EINA_FALLTHROUGH;
-           case 0x261: EINA_FALLTHROUGH;
-           case 0x2C4: EINA_FALLTHROUGH;
-           case 0x2C7: EINA_FALLTHROUGH;
-           case 0x2C9 ... 0x2CB: EINA_FALLTHROUGH;
-           case 0x2CD: EINA_FALLTHROUGH;
-           case 0x2D0: EINA_FALLTHROUGH;
-           case 0x2D8 ... 0x2DB: EINA_FALLTHROUGH;
-           case 0x2DD: EINA_FALLTHROUGH;
-           case 0x2DF: EINA_FALLTHROUGH;
-           case 0x300 ... 0x36F: EINA_FALLTHROUGH;
-           case 0x391 ... 0x3A9: EINA_FALLTHROUGH;
-           case 0x3B1 ... 0x3C1: EINA_FALLTHROUGH;
-           case 0x3C3 ... 0x3C9: EINA_FALLTHROUGH;
-           case 0x401: EINA_FALLTHROUGH;
-           case 0x410 ... 0x44F: EINA_FALLTHROUGH;
-           case 0x451: EINA_FALLTHROUGH;
-           case 0x1100 ... 0x115F: EINA_FALLTHROUGH;
-           case 0x2010: EINA_FALLTHROUGH;
-           case 0x2013 ... 0x2016: EINA_FALLTHROUGH;
-           case 0x2018 ... 0x2019: EINA_FALLTHROUGH;
-           case 0x201C ... 0x201D: EINA_FALLTHROUGH;
-           case 0x2020 ... 0x2022: EINA_FALLTHROUGH;
-           case 0x2024 ... 0x2027: EINA_FALLTHROUGH;
-           case 0x2030: EINA_FALLTHROUGH;
-           case 0x2032 ... 0x2033: EINA_FALLTHROUGH;
-           case 0x2035: EINA_FALLTHROUGH;
-           case 0x203B ... 0x203C: EINA_FALLTHROUGH;
-           case 0x203E: EINA_FALLTHROUGH;
-           case 0x2049: EINA_FALLTHROUGH;
-           case 0x2074: EINA_FALLTHROUGH;
-           case 0x207F: EINA_FALLTHROUGH;
-           case 0x2081 ... 0x2084: EINA_FALLTHROUGH;
-           case 0x20AC: EINA_FALLTHROUGH;
-           case 0x2103: EINA_FALLTHROUGH;
-           case 0x2105: EINA_FALLTHROUGH;
-           case 0x2109: EINA_FALLTHROUGH;
-           case 0x2113: EINA_FALLTHROUGH;
-           case 0x2116: EINA_FALLTHROUGH;
-           case 0x2121 ... 0x2122: EINA_FALLTHROUGH;
-           case 0x2126: EINA_FALLTHROUGH;
-           case 0x212B: EINA_FALLTHROUGH;
-           case 0x2139: EINA_FALLTHROUGH;
-           case 0x2153 ... 0x2154: EINA_FALLTHROUGH;
-           case 0x215B ... 0x215E: EINA_FALLTHROUGH;
-           case 0x2160 ... 0x216B: EINA_FALLTHROUGH;
-           case 0x2170 ... 0x2179: EINA_FALLTHROUGH;
-           case 0x2189: EINA_FALLTHROUGH;
-           case 0x2190 ... 0x2199: EINA_FALLTHROUGH;
-           case 0x21A9 ... 0x21AA: EINA_FALLTHROUGH;
-           case 0x21B8 ... 0x21B9: EINA_FALLTHROUGH;
-           case 0x21D2: EINA_FALLTHROUGH;
-           case 0x21D4: EINA_FALLTHROUGH;
-           case 0x21E7: EINA_FALLTHROUGH;
-           case 0x2200: EINA_FALLTHROUGH;
-           case 0x2202 ... 0x2203: EINA_FALLTHROUGH;
-           case 0x2207 ... 0x2208: EINA_FALLTHROUGH;
-           case 0x220B: EINA_FALLTHROUGH;
-           case 0x220F: EINA_FALLTHROUGH;
-           case 0x2211: EINA_FALLTHROUGH;
-           case 0x2215: EINA_FALLTHROUGH;
-           case 0x221A: EINA_FALLTHROUGH;
-           case 0x221D ... 0x2220: EINA_FALLTHROUGH;
-           case 0x2223: EINA_FALLTHROUGH;
-           case 0x2225: EINA_FALLTHROUGH;
-           case 0x2227 ... 0x222C: EINA_FALLTHROUGH;
-           case 0x222E: EINA_FALLTHROUGH;
-           case 0x2234 ... 0x2237: EINA_FALLTHROUGH;
-           case 0x223C ... 0x223D: EINA_FALLTHROUGH;
-           case 0x2248: EINA_FALLTHROUGH;
-           case 0x224C: EINA_FALLTHROUGH;
-           case 0x2252: EINA_FALLTHROUGH;
-           case 0x2260 ... 0x2261: EINA_FALLTHROUGH;
-           case 0x2264 ... 0x2267: EINA_FALLTHROUGH;
-           case 0x226A ... 0x226B: EINA_FALLTHROUGH;
-           case 0x226E ... 0x226F: EINA_FALLTHROUGH;
-           case 0x2282 ... 0x2283: EINA_FALLTHROUGH;
-           case 0x2286 ... 0x2287: EINA_FALLTHROUGH;
-           case 0x2295: EINA_FALLTHROUGH;
-           case 0x2299: EINA_FALLTHROUGH;
-           case 0x22A5: EINA_FALLTHROUGH;
-           case 0x22BF: EINA_FALLTHROUGH;
-           case 0x2312: EINA_FALLTHROUGH;
-           case 0x231A ... 0x231B: EINA_FALLTHROUGH;
-           case 0x2328 ... 0x232A: EINA_FALLTHROUGH;
-           case 0x23CF: EINA_FALLTHROUGH;
-           case 0x23E9 ... 0x23F3: EINA_FALLTHROUGH;
-           case 0x23F8 ... 0x23FA: EINA_FALLTHROUGH;
-           case 0x2460 ... 0x24E9: EINA_FALLTHROUGH;
-           case 0x24EB ... 0x254B: EINA_FALLTHROUGH;
-           case 0x2550 ... 0x2573: EINA_FALLTHROUGH;
-           case 0x2580 ... 0x258F: EINA_FALLTHROUGH;
-           case 0x2592 ... 0x2595: EINA_FALLTHROUGH;
-           case 0x25A0 ... 0x25A1: EINA_FALLTHROUGH;
-           case 0x25A3 ... 0x25AB: EINA_FALLTHROUGH;
-           case 0x25B2 ... 0x25B3: EINA_FALLTHROUGH;
-           case 0x25B6 ... 0x25B7: EINA_FALLTHROUGH;
-           case 0x25BC ... 0x25BD: EINA_FALLTHROUGH;
-           case 0x25C0 ... 0x25C1: EINA_FALLTHROUGH;
-           case 0x25C6 ... 0x25C8: EINA_FALLTHROUGH;
-           case 0x25CB: EINA_FALLTHROUGH;
-           case 0x25CE ... 0x25D1: EINA_FALLTHROUGH;
-           case 0x25E2 ... 0x25E5: EINA_FALLTHROUGH;
-           case 0x25EF: EINA_FALLTHROUGH;
-           case 0x25FB ... 0x25FE: EINA_FALLTHROUGH;
-           case 0x2600 ... 0x2606: EINA_FALLTHROUGH;
-           case 0x2609: EINA_FALLTHROUGH;
-           case 0x260E ... 0x260F: EINA_FALLTHROUGH;
-           case 0x2611: EINA_FALLTHROUGH;
-           case 0x2614 ... 0x2615: EINA_FALLTHROUGH;
-           case 0x2618: EINA_FALLTHROUGH;
-           case 0x261C ... 0x261E: EINA_FALLTHROUGH;
-           case 0x2620: EINA_FALLTHROUGH;
-           case 0x2622 ... 0x2623: EINA_FALLTHROUGH;
-           case 0x2626: EINA_FALLTHROUGH;
-           case 0x262A: EINA_FALLTHROUGH;
-           case 0x262E ... 0x262F: EINA_FALLTHROUGH;
-           case 0x2638 ... 0x263A: EINA_FALLTHROUGH;
-           case 0x2640: EINA_FALLTHROUGH;
-           case 0x2642: EINA_FALLTHROUGH;
-           case 0x2648 ... 0x2653: EINA_FALLTHROUGH;
-           case 0x265F ... 0x2661: EINA_FALLTHROUGH;
-           case 0x2663 ... 0x266A: EINA_FALLTHROUGH;
-           case 0x266C ... 0x266D: EINA_FALLTHROUGH;
-           case 0x266F: EINA_FALLTHROUGH;
-           case 0x267B: EINA_FALLTHROUGH;
-           case 0x267E ... 0x267F: EINA_FALLTHROUGH;
-           case 0x2692 ... 0x2697: EINA_FALLTHROUGH;
-           case 0x2699: EINA_FALLTHROUGH;
-           case 0x269B ... 0x269C: EINA_FALLTHROUGH;
-           case 0x269E ... 0x26A1: EINA_FALLTHROUGH;
-           case 0x26A7: EINA_FALLTHROUGH;
-           case 0x26AA ... 0x26AB: EINA_FALLTHROUGH;
-           case 0x26B0 ... 0x26B1: EINA_FALLTHROUGH;
-           case 0x26BD ... 0x26BF: EINA_FALLTHROUGH;
-           case 0x26C4 ... 0x26E1: EINA_FALLTHROUGH;
-           case 0x26E3: EINA_FALLTHROUGH;
-           case 0x26E8 ... 0x26FF: EINA_FALLTHROUGH;
-           case 0x2702: EINA_FALLTHROUGH;
-           case 0x2705: EINA_FALLTHROUGH;
-           case 0x2708 ... 0x270D: EINA_FALLTHROUGH;
-           case 0x270F: EINA_FALLTHROUGH;
-           case 0x2712: EINA_FALLTHROUGH;
-           case 0x2714: EINA_FALLTHROUGH;
-           case 0x2716: EINA_FALLTHROUGH;
-           case 0x271D: EINA_FALLTHROUGH;
-           case 0x2721: EINA_FALLTHROUGH;
-           case 0x2728: EINA_FALLTHROUGH;
-           case 0x2733 ... 0x2734: EINA_FALLTHROUGH;
-           case 0x273D: EINA_FALLTHROUGH;
-           case 0x2744: EINA_FALLTHROUGH;
-           case 0x2747: EINA_FALLTHROUGH;
-           case 0x274C: EINA_FALLTHROUGH;
-           case 0x274E: EINA_FALLTHROUGH;
-           case 0x2753 ... 0x2755: EINA_FALLTHROUGH;
-           case 0x2757: EINA_FALLTHROUGH;
-           case 0x2763 ... 0x2764: EINA_FALLTHROUGH;
-           case 0x2776 ... 0x277F: EINA_FALLTHROUGH;
-           case 0x2795 ... 0x2797: EINA_FALLTHROUGH;
-           case 0x27A1: EINA_FALLTHROUGH;
-           case 0x27B0: EINA_FALLTHROUGH;
-           case 0x27BF: EINA_FALLTHROUGH;
-           case 0x2934 ... 0x2935: EINA_FALLTHROUGH;
-           case 0x2B05 ... 0x2B07: EINA_FALLTHROUGH;
-           case 0x2B1B ... 0x2B1C: EINA_FALLTHROUGH;
-           case 0x2B50: EINA_FALLTHROUGH;
-           case 0x2B55 ... 0x2B59: EINA_FALLTHROUGH;
-           case 0x2E80 ... 0x303E: EINA_FALLTHROUGH;
-           case 0x3041 ... 0x4DBF: EINA_FALLTHROUGH;
-           case 0x4E00 ... 0xA4C6: EINA_FALLTHROUGH;
-           case 0xA960 ... 0xA97C: EINA_FALLTHROUGH;
-           case 0xAC00 ... 0xD7A3: EINA_FALLTHROUGH;
-           case 0xF900 ... 0xFAD9: EINA_FALLTHROUGH;
-           case 0xFE00 ... 0xFE19: EINA_FALLTHROUGH;
-           case 0xFE30 ... 0xFE6B: EINA_FALLTHROUGH;
-           case 0xFF01 ... 0xFF60: EINA_FALLTHROUGH;
-           case 0xFFE0 ... 0xFFE6: EINA_FALLTHROUGH;
-           case 0xFFFD: EINA_FALLTHROUGH;
-           case 0x16FE0 ... 0x1B2FB: EINA_FALLTHROUGH;
-           case 0x1F004: EINA_FALLTHROUGH;
-           case 0x1F0CF: EINA_FALLTHROUGH;
-           case 0x1F100 ... 0x1F10A: EINA_FALLTHROUGH;
-           case 0x1F110 ... 0x1F12D: EINA_FALLTHROUGH;
-           case 0x1F130 ... 0x1F169: EINA_FALLTHROUGH;
-           case 0x1F170 ... 0x1F1AC: EINA_FALLTHROUGH;
-           case 0x1F200 ... 0x1F64F: EINA_FALLTHROUGH;
-           case 0x1F680 ... 0x1F6C5: EINA_FALLTHROUGH;
-           case 0x1F6CB ... 0x1F6D2: EINA_FALLTHROUGH;
-           case 0x1F6D5 ... 0x1F6E5: EINA_FALLTHROUGH;
-           case 0x1F6E9: EINA_FALLTHROUGH;
-           case 0x1F6EB ... 0x1F6F0: EINA_FALLTHROUGH;
-           case 0x1F6F3 ... 0x1F6FC: EINA_FALLTHROUGH;
-           case 0x1F7E0 ... 0x1F7F0: EINA_FALLTHROUGH;
-           case 0x1F90C ... 0x1F93A: EINA_FALLTHROUGH;
-           case 0x1F93C ... 0x1F945: EINA_FALLTHROUGH;
-           case 0x1F947 ... 0x1F9FF: EINA_FALLTHROUGH;
-           case 0x1FA70 ... 0x1FAF8: EINA_FALLTHROUGH;
-           case 0x20000 ... 0x323AF: EINA_FALLTHROUGH;
-           case 0xE0100 ... 0xE01EF:
-             return EINA_TRUE;
-         }
-     }
-   else
-     {
-        switch (g)
-          {
-           case 0xA1: EINA_FALLTHROUGH;
-           case 0xA4: EINA_FALLTHROUGH;
-           case 0xA7 ... 0xA8: EINA_FALLTHROUGH;
-           case 0xAA: EINA_FALLTHROUGH;
-           case 0xAD ... 0xAE: EINA_FALLTHROUGH;
-           case 0xB0 ... 0xB4: EINA_FALLTHROUGH;
-           case 0xB6 ... 0xBA: EINA_FALLTHROUGH;
-           case 0xBC ... 0xBF: EINA_FALLTHROUGH;
-           case 0xC6: EINA_FALLTHROUGH;
-           case 0xD0: EINA_FALLTHROUGH;
-           case 0xD7 ... 0xD8: EINA_FALLTHROUGH;
-           case 0xDE ... 0xE1: EINA_FALLTHROUGH;
-           case 0xE6: EINA_FALLTHROUGH;
-           case 0xE8 ... 0xEA: EINA_FALLTHROUGH;
-           case 0xEC ... 0xED: EINA_FALLTHROUGH;
-           case 0xF0: EINA_FALLTHROUGH;
-           case 0xF2 ... 0xF3: EINA_FALLTHROUGH;
-           case 0xF7 ... 0xFA: EINA_FALLTHROUGH;
-           case 0xFC: EINA_FALLTHROUGH;
-           case 0xFE: EINA_FALLTHROUGH;
-           case 0x101: EINA_FALLTHROUGH;
-           case 0x111: EINA_FALLTHROUGH;
-           case 0x113: EINA_FALLTHROUGH;
-           case 0x11B: EINA_FALLTHROUGH;
-           case 0x126 ... 0x127: EINA_FALLTHROUGH;
-           case 0x12B: EINA_FALLTHROUGH;
-           case 0x131 ... 0x133: EINA_FALLTHROUGH;
-           case 0x138: EINA_FALLTHROUGH;
-           case 0x13F ... 0x142: EINA_FALLTHROUGH;
-           case 0x144: EINA_FALLTHROUGH;
-           case 0x148 ... 0x14B: EINA_FALLTHROUGH;
-           case 0x14D: EINA_FALLTHROUGH;
-           case 0x152 ... 0x153: EINA_FALLTHROUGH;
-           case 0x166 ... 0x167: EINA_FALLTHROUGH;
-           case 0x16B: EINA_FALLTHROUGH;
-           case 0x1CE: EINA_FALLTHROUGH;
-           case 0x1D0: EINA_FALLTHROUGH;
-           case 0x1D2: EINA_FALLTHROUGH;
-           case 0x1D4: EINA_FALLTHROUGH;
-           case 0x1D6: EINA_FALLTHROUGH;
-           case 0x1D8: EINA_FALLTHROUGH;
-           case 0x1DA: EINA_FALLTHROUGH;
-           case 0x1DC: EINA_FALLTHROUGH;
-           case 0x251: EINA_FALLTHROUGH;
-           case 0x261: EINA_FALLTHROUGH;
-           case 0x2C4: EINA_FALLTHROUGH;
-           case 0x2C7: EINA_FALLTHROUGH;
-           case 0x2C9 ... 0x2CB: EINA_FALLTHROUGH;
-           case 0x2CD: EINA_FALLTHROUGH;
-           case 0x2D0: EINA_FALLTHROUGH;
-           case 0x2D8 ... 0x2DB: EINA_FALLTHROUGH;
-           case 0x2DD: EINA_FALLTHROUGH;
-           case 0x2DF: EINA_FALLTHROUGH;
-           case 0x300 ... 0x36F: EINA_FALLTHROUGH;
-           case 0x391 ... 0x3A9: EINA_FALLTHROUGH;
-           case 0x3B1 ... 0x3C1: EINA_FALLTHROUGH;
-           case 0x3C3 ... 0x3C9: EINA_FALLTHROUGH;
-           case 0x401: EINA_FALLTHROUGH;
-           case 0x410 ... 0x44F: EINA_FALLTHROUGH;
-           case 0x451: EINA_FALLTHROUGH;
-           case 0x1100 ... 0x115F: EINA_FALLTHROUGH;
-           case 0x2010: EINA_FALLTHROUGH;
-           case 0x2013 ... 0x2016: EINA_FALLTHROUGH;
-           case 0x2018 ... 0x2019: EINA_FALLTHROUGH;
-           case 0x201C ... 0x201D: EINA_FALLTHROUGH;
-           case 0x2020 ... 0x2022: EINA_FALLTHROUGH;
-           case 0x2024 ... 0x2027: EINA_FALLTHROUGH;
-           case 0x2030: EINA_FALLTHROUGH;
-           case 0x2032 ... 0x2033: EINA_FALLTHROUGH;
-           case 0x2035: EINA_FALLTHROUGH;
-           case 0x203B: EINA_FALLTHROUGH;
-           case 0x203E: EINA_FALLTHROUGH;
-           case 0x2074: EINA_FALLTHROUGH;
-           case 0x207F: EINA_FALLTHROUGH;
-           case 0x2081 ... 0x2084: EINA_FALLTHROUGH;
-           case 0x20AC: EINA_FALLTHROUGH;
-           case 0x2103: EINA_FALLTHROUGH;
-           case 0x2105: EINA_FALLTHROUGH;
-           case 0x2109: EINA_FALLTHROUGH;
-           case 0x2113: EINA_FALLTHROUGH;
-           case 0x2116: EINA_FALLTHROUGH;
-           case 0x2121 ... 0x2122: EINA_FALLTHROUGH;
-           case 0x2126: EINA_FALLTHROUGH;
-           case 0x212B: EINA_FALLTHROUGH;
-           case 0x2153 ... 0x2154: EINA_FALLTHROUGH;
-           case 0x215B ... 0x215E: EINA_FALLTHROUGH;
-           case 0x2160 ... 0x216B: EINA_FALLTHROUGH;
-           case 0x2170 ... 0x2179: EINA_FALLTHROUGH;
-           case 0x2189: EINA_FALLTHROUGH;
-           case 0x2190 ... 0x2199: EINA_FALLTHROUGH;
-           case 0x21B8 ... 0x21B9: EINA_FALLTHROUGH;
-           case 0x21D2: EINA_FALLTHROUGH;
-           case 0x21D4: EINA_FALLTHROUGH;
-           case 0x21E7: EINA_FALLTHROUGH;
-           case 0x2200: EINA_FALLTHROUGH;
-           case 0x2202 ... 0x2203: EINA_FALLTHROUGH;
-           case 0x2207 ... 0x2208: EINA_FALLTHROUGH;
-           case 0x220B: EINA_FALLTHROUGH;
-           case 0x220F: EINA_FALLTHROUGH;
-           case 0x2211: EINA_FALLTHROUGH;
-           case 0x2215: EINA_FALLTHROUGH;
-           case 0x221A: EINA_FALLTHROUGH;
-           case 0x221D ... 0x2220: EINA_FALLTHROUGH;
-           case 0x2223: EINA_FALLTHROUGH;
-           case 0x2225: EINA_FALLTHROUGH;
-           case 0x2227 ... 0x222C: EINA_FALLTHROUGH;
-           case 0x222E: EINA_FALLTHROUGH;
-           case 0x2234 ... 0x2237: EINA_FALLTHROUGH;
-           case 0x223C ... 0x223D: EINA_FALLTHROUGH;
-           case 0x2248: EINA_FALLTHROUGH;
-           case 0x224C: EINA_FALLTHROUGH;
-           case 0x2252: EINA_FALLTHROUGH;
-           case 0x2260 ... 0x2261: EINA_FALLTHROUGH;
-           case 0x2264 ... 0x2267: EINA_FALLTHROUGH;
-           case 0x226A ... 0x226B: EINA_FALLTHROUGH;
-           case 0x226E ... 0x226F: EINA_FALLTHROUGH;
-           case 0x2282 ... 0x2283: EINA_FALLTHROUGH;
-           case 0x2286 ... 0x2287: EINA_FALLTHROUGH;
-           case 0x2295: EINA_FALLTHROUGH;
-           case 0x2299: EINA_FALLTHROUGH;
-           case 0x22A5: EINA_FALLTHROUGH;
-           case 0x22BF: EINA_FALLTHROUGH;
-           case 0x2312: EINA_FALLTHROUGH;
-           case 0x231A ... 0x231B: EINA_FALLTHROUGH;
-           case 0x2329 ... 0x232A: EINA_FALLTHROUGH;
-           case 0x23E9 ... 0x23EC: EINA_FALLTHROUGH;
-           case 0x23F0: EINA_FALLTHROUGH;
-           case 0x23F3: EINA_FALLTHROUGH;
-           case 0x2460 ... 0x24E9: EINA_FALLTHROUGH;
-           case 0x24EB ... 0x254B: EINA_FALLTHROUGH;
-           case 0x2550 ... 0x2573: EINA_FALLTHROUGH;
-           case 0x2580 ... 0x258F: EINA_FALLTHROUGH;
-           case 0x2592 ... 0x2595: EINA_FALLTHROUGH;
-           case 0x25A0 ... 0x25A1: EINA_FALLTHROUGH;
-           case 0x25A3 ... 0x25A9: EINA_FALLTHROUGH;
-           case 0x25B2 ... 0x25B3: EINA_FALLTHROUGH;
-           case 0x25B6 ... 0x25B7: EINA_FALLTHROUGH;
-           case 0x25BC ... 0x25BD: EINA_FALLTHROUGH;
-           case 0x25C0 ... 0x25C1: EINA_FALLTHROUGH;
-           case 0x25C6 ... 0x25C8: EINA_FALLTHROUGH;
-           case 0x25CB: EINA_FALLTHROUGH;
-           case 0x25CE ... 0x25D1: EINA_FALLTHROUGH;
-           case 0x25E2 ... 0x25E5: EINA_FALLTHROUGH;
-           case 0x25EF: EINA_FALLTHROUGH;
-           case 0x25FD ... 0x25FE: EINA_FALLTHROUGH;
-           case 0x2605 ... 0x2606: EINA_FALLTHROUGH;
-           case 0x2609: EINA_FALLTHROUGH;
-           case 0x260E ... 0x260F: EINA_FALLTHROUGH;
-           case 0x2614 ... 0x2615: EINA_FALLTHROUGH;
-           case 0x261C: EINA_FALLTHROUGH;
-           case 0x261E: EINA_FALLTHROUGH;
-           case 0x2640: EINA_FALLTHROUGH;
-           case 0x2642: EINA_FALLTHROUGH;
-           case 0x2648 ... 0x2653: EINA_FALLTHROUGH;
-           case 0x2660 ... 0x2661: EINA_FALLTHROUGH;
-           case 0x2663 ... 0x2665: EINA_FALLTHROUGH;
-           case 0x2667 ... 0x266A: EINA_FALLTHROUGH;
-           case 0x266C ... 0x266D: EINA_FALLTHROUGH;
-           case 0x266F: EINA_FALLTHROUGH;
-           case 0x267F: EINA_FALLTHROUGH;
-           case 0x2693: EINA_FALLTHROUGH;
-           case 0x269E ... 0x269F: EINA_FALLTHROUGH;
-           case 0x26A1: EINA_FALLTHROUGH;
-           case 0x26AA ... 0x26AB: EINA_FALLTHROUGH;
-           case 0x26BD ... 0x26BF: EINA_FALLTHROUGH;
-           case 0x26C4 ... 0x26E1: EINA_FALLTHROUGH;
-           case 0x26E3: EINA_FALLTHROUGH;
-           case 0x26E8 ... 0x26FF: EINA_FALLTHROUGH;
-           case 0x2705: EINA_FALLTHROUGH;
-           case 0x270A ... 0x270B: EINA_FALLTHROUGH;
-           case 0x2728: EINA_FALLTHROUGH;
-           case 0x273D: EINA_FALLTHROUGH;
-           case 0x274C: EINA_FALLTHROUGH;
-           case 0x274E: EINA_FALLTHROUGH;
-           case 0x2753 ... 0x2755: EINA_FALLTHROUGH;
-           case 0x2757: EINA_FALLTHROUGH;
-           case 0x2776 ... 0x277F: EINA_FALLTHROUGH;
-           case 0x2795 ... 0x2797: EINA_FALLTHROUGH;
-           case 0x27B0: EINA_FALLTHROUGH;
-           case 0x27BF: EINA_FALLTHROUGH;
-           case 0x2B1B ... 0x2B1C: EINA_FALLTHROUGH;
-           case 0x2B50: EINA_FALLTHROUGH;
-           case 0x2B55 ... 0x2B59: EINA_FALLTHROUGH;
-           case 0x2E80 ... 0x303E: EINA_FALLTHROUGH;
-           case 0x3041 ... 0x4DBF: EINA_FALLTHROUGH;
-           case 0x4E00 ... 0xA4C6: EINA_FALLTHROUGH;
-           case 0xA960 ... 0xA97C: EINA_FALLTHROUGH;
-           case 0xAC00 ... 0xD7A3: EINA_FALLTHROUGH;
-           case 0xF900 ... 0xFAD9: EINA_FALLTHROUGH;
-           case 0xFE00 ... 0xFE19: EINA_FALLTHROUGH;
-           case 0xFE30 ... 0xFE6B: EINA_FALLTHROUGH;
-           case 0xFF01 ... 0xFF60: EINA_FALLTHROUGH;
-           case 0xFFE0 ... 0xFFE6: EINA_FALLTHROUGH;
-           case 0xFFFD: EINA_FALLTHROUGH;
-           case 0x16FE0 ... 0x1B2FB: EINA_FALLTHROUGH;
-           case 0x1F004: EINA_FALLTHROUGH;
-           case 0x1F0CF: EINA_FALLTHROUGH;
-           case 0x1F100 ... 0x1F10A: EINA_FALLTHROUGH;
-           case 0x1F110 ... 0x1F12D: EINA_FALLTHROUGH;
-           case 0x1F130 ... 0x1F169: EINA_FALLTHROUGH;
-           case 0x1F170 ... 0x1F1AC: EINA_FALLTHROUGH;
-           case 0x1F200 ... 0x1F320: EINA_FALLTHROUGH;
-           case 0x1F32D ... 0x1F335: EINA_FALLTHROUGH;
-           case 0x1F337 ... 0x1F37C: EINA_FALLTHROUGH;
-           case 0x1F37E ... 0x1F393: EINA_FALLTHROUGH;
-           case 0x1F3A0 ... 0x1F3CA: EINA_FALLTHROUGH;
-           case 0x1F3CF ... 0x1F3D3: EINA_FALLTHROUGH;
-           case 0x1F3E0 ... 0x1F3F0: EINA_FALLTHROUGH;
-           case 0x1F3F4: EINA_FALLTHROUGH;
-           case 0x1F3F8 ... 0x1F43E: EINA_FALLTHROUGH;
-           case 0x1F440: EINA_FALLTHROUGH;
-           case 0x1F442 ... 0x1F4FC: EINA_FALLTHROUGH;
-           case 0x1F4FF ... 0x1F53D: EINA_FALLTHROUGH;
-           case 0x1F54B ... 0x1F54E: EINA_FALLTHROUGH;
-           case 0x1F550 ... 0x1F567: EINA_FALLTHROUGH;
-           case 0x1F57A: EINA_FALLTHROUGH;
-           case 0x1F595 ... 0x1F596: EINA_FALLTHROUGH;
-           case 0x1F5A4: EINA_FALLTHROUGH;
-           case 0x1F5FB ... 0x1F64F: EINA_FALLTHROUGH;
-           case 0x1F680 ... 0x1F6C5: EINA_FALLTHROUGH;
-           case 0x1F6CC: EINA_FALLTHROUGH;
-           case 0x1F6D0 ... 0x1F6D2: EINA_FALLTHROUGH;
-           case 0x1F6D5 ... 0x1F6DF: EINA_FALLTHROUGH;
-           case 0x1F6EB ... 0x1F6EC: EINA_FALLTHROUGH;
-           case 0x1F6F4 ... 0x1F6FC: EINA_FALLTHROUGH;
-           case 0x1F7E0 ... 0x1F7F0: EINA_FALLTHROUGH;
-           case 0x1F90C ... 0x1F93A: EINA_FALLTHROUGH;
-           case 0x1F93C ... 0x1F945: EINA_FALLTHROUGH;
-           case 0x1F947 ... 0x1F9FF: EINA_FALLTHROUGH;
-           case 0x1FA70 ... 0x1FAF8: EINA_FALLTHROUGH;
-           case 0x20000 ... 0x323AF: EINA_FALLTHROUGH;
-           case 0xE0100 ... 0xE01EF:
-             return EINA_TRUE;
-          }
-     }
-   return EINA_FALSE;
-}
+   {
+      /* not ambiguous, no emoji */
+      {
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   1,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   2,   0,   3,   4,   5,   0,   0,   0,   6,   0,   0,   7,   8,
+           9,   8,  10,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,  11,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,  12,   0,   0,   0,   0,  13,   0,   0,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,  14,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   8,  15,   0,   0,   0,  16,  17,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  18,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,  19,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          20,  21,   8,  22,  23,  24,  25,  26,   0,  27,  28,   0,   0,   0,   0,   0,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,  29,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,
+      },
+      /* not ambiguous, emoji */
+      {
+          30,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   1,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          31,  32,   0,  33,   0,  34,  35,  36,   0,  37,   0,  38,   0,   0,   7,   8,
+           9,   8,  10,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,  11,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,  12,   0,   0,   0,   0,  13,   0,   0,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,  14,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   8,  15,   0,   0,   0,  16,  17,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  18,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,  19,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          20,  21,   8,   8,   8,   8,  39,  26,   0,  27,  28,   0,   0,   0,   0,   0,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,  29,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,
+      },
+   },
+   {
+      /* ambiguous, no emoji */
+      {
+          40,  41,  42,  43,  44,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   1,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          45,  46,  47,  48,  49,  50,  51,  52,   0,   0,   0,  53,   0,   0,   7,   8,
+           9,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,  11,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,  12,   0,   0,   0,   0,  13,   0,   0,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,  14,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   8,  15,   0,   0,   0,  54,  55,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  18,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,  19,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          20,  56,   8,  22,  23,  24,  25,  26,   0,  27,  28,   0,   0,   0,   0,   0,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,  29,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,  57,
+      },
+      /* ambiguous, emoji */
+      {
+          58,  41,  42,  43,  44,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   1,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          59,  60,  47,  61,  49,  62,  63,  64,   0,  37,   0,  65,   0,   0,   7,   8,
+           9,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,  11,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,  12,   0,   0,   0,   0,  13,   0,   0,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,  14,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   8,  15,   0,   0,   0,  54,  55,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  18,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,  19,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          20,  56,   8,   8,   8,   8,  39,  26,   0,  27,  28,   0,   0,   0,   0,   0,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,   8,
+           8,   8,   8,  29,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+           0,  57,
+      },
+   },
+};
 
-__attribute__((const))
-Eina_Bool
-_termpty_is_wide(Eina_Unicode g, Eina_Bool emoji_dbl_width)
+const uint32_t _termpty_dbl_bits[66][8] =
 {
-   if (emoji_dbl_width)
-     {
-        switch (g)
-          {
-        case 0xA9: EINA_FALLTHROUGH;
-        case 0x1100 ... 0x115F: EINA_FALLTHROUGH;
-        case 0x203C: EINA_FALLTHROUGH;
-        case 0x2049: EINA_FALLTHROUGH;
-        case 0x2139: EINA_FALLTHROUGH;
-        case 0x21A9 ... 0x21AA: EINA_FALLTHROUGH;
-        case 0x231A ... 0x231B: EINA_FALLTHROUGH;
-        case 0x2328 ... 0x232A: EINA_FALLTHROUGH;
-        case 0x23CF: EINA_FALLTHROUGH;
-        case 0x23E9 ... 0x23F3: EINA_FALLTHROUGH;
-        case 0x23F8 ... 0x23FA: EINA_FALLTHROUGH;
-        case 0x25AA ... 0x25AB: EINA_FALLTHROUGH;
-        case 0x25FB ... 0x25FE: EINA_FALLTHROUGH;
-        case 0x2600 ... 0x2604: EINA_FALLTHROUGH;
-        case 0x2611: EINA_FALLTHROUGH;
-        case 0x2614 ... 0x2615: EINA_FALLTHROUGH;
-        case 0x2618: EINA_FALLTHROUGH;
-        case 0x261D: EINA_FALLTHROUGH;
-        case 0x2620: EINA_FALLTHROUGH;
-        case 0x2622 ... 0x2623: EINA_FALLTHROUGH;
-        case 0x2626: EINA_FALLTHROUGH;
-        case 0x262A: EINA_FALLTHROUGH;
-        case 0x262E ... 0x262F: EINA_FALLTHROUGH;
-        case 0x2638 ... 0x263A: EINA_FALLTHROUGH;
-        case 0x2648 ... 0x2653: EINA_FALLTHROUGH;
-        case 0x265F: EINA_FALLTHROUGH;
-        case 0x2666: EINA_FALLTHROUGH;
-        case 0x267B: EINA_FALLTHROUGH;
-        case 0x267E ... 0x267F: EINA_FALLTHROUGH;
-        case 0x2692 ... 0x2697: EINA_FALLTHROUGH;
-        case 0x2699: EINA_FALLTHROUGH;
-        case 0x269B ... 0x269C: EINA_FALLTHROUGH;
-        case 0x26A0 ... 0x26A1: EINA_FALLTHROUGH;
-        case 0x26A7: EINA_FALLTHROUGH;
-        case 0x26AA ... 0x26AB: EINA_FALLTHROUGH;
-        case 0x26B0 ... 0x26B1: EINA_FALLTHROUGH;
-        case 0x26BD ... 0x26BE: EINA_FALLTHROUGH;
-        case 0x26C4 ... 0x26C5: EINA_FALLTHROUGH;
-        case 0x26CE: EINA_FALLTHROUGH;
-        case 0x26D4: EINA_FALLTHROUGH;
-        case 0x26EA: EINA_FALLTHROUGH;
-        case 0x26F2 ... 0x26F3: EINA_FALLTHROUGH;
-        case 0x26F5: EINA_FALLTHROUGH;
-        case 0x26FA: EINA_FALLTHROUGH;
-        case 0x26FD: EINA_FALLTHROUGH;
-        case 0x2702: EINA_FALLTHROUGH;
-        case 0x2705: EINA_FALLTHROUGH;
-        case 0x2708 ... 0x270D: EINA_FALLTHROUGH;
-        case 0x270F: EINA_FALLTHROUGH;
-        case 0x2712: EINA_FALLTHROUGH;
-        case 0x2714: EINA_FALLTHROUGH;
-        case 0x2716: EINA_FALLTHROUGH;
-        case 0x271D: EINA_FALLTHROUGH;
-        case 0x2721: EINA_FALLTHROUGH;
-        case 0x2728: EINA_FALLTHROUGH;
-        case 0x2733 ... 0x2734: EINA_FALLTHROUGH;
-        case 0x2744: EINA_FALLTHROUGH;
-        case 0x2747: EINA_FALLTHROUGH;
-        case 0x274C: EINA_FALLTHROUGH;
-        case 0x274E: EINA_FALLTHROUGH;
-        case 0x2753 ... 0x2755: EINA_FALLTHROUGH;
-        case 0x2757: EINA_FALLTHROUGH;
-        case 0x2763 ... 0x2764: EINA_FALLTHROUGH;
-        case 0x2795 ... 0x2797: EINA_FALLTHROUGH;
-        case 0x27A1: EINA_FALLTHROUGH;
-        case 0x27B0: EINA_FALLTHROUGH;
-        case 0x27BF: EINA_FALLTHROUGH;
-        case 0x2934 ... 0x2935: EINA_FALLTHROUGH;
-        case 0x2B05 ... 0x2B07: EINA_FALLTHROUGH;
-        case 0x2B1B ... 0x2B1C: EINA_FALLTHROUGH;
-        case 0x2B50: EINA_FALLTHROUGH;
-        case 0x2B55: EINA_FALLTHROUGH;
-        case 0x2E80 ... 0x303E: EINA_FALLTHROUGH;
-        case 0x3041 ... 0x3247: EINA_FALLTHROUGH;
-        case 0x3250 ... 0x4DBF: EINA_FALLTHROUGH;
-        case 0x4E00 ... 0xA4C6: EINA_FALLTHROUGH;
-        case 0xA960 ... 0xA97C: EINA_FALLTHROUGH;
-        case 0xAC00 ... 0xD7A3: EINA_FALLTHROUGH;
-        case 0xF900 ... 0xFAD9: EINA_FALLTHROUGH;
-        case 0xFE10 ... 0xFE19: EINA_FALLTHROUGH;
-        case 0xFE30 ... 0xFE6B: EINA_FALLTHROUGH;
-        case 0xFF01 ... 0xFF60: EINA_FALLTHROUGH;
-        case 0xFFE0 ... 0xFFE6: EINA_FALLTHROUGH;
-        case 0x16FE0 ... 0x1B2FB: EINA_FALLTHROUGH;
-        case 0x1F004: EINA_FALLTHROUGH;
-        case 0x1F0CF: EINA_FALLTHROUGH;
-        case 0x1F18E: EINA_FALLTHROUGH;
-        case 0x1F191 ... 0x1F19A: EINA_FALLTHROUGH;
-        case 0x1F200 ... 0x1F64F: EINA_FALLTHROUGH;
-        case 0x1F680 ... 0x1F6C5: EINA_FALLTHROUGH;
-        case 0x1F6CB ... 0x1F6D2: EINA_FALLTHROUGH;
-        case 0x1F6D5 ... 0x1F6E5: EINA_FALLTHROUGH;
-        case 0x1F6E9: EINA_FALLTHROUGH;
-        case 0x1F6EB ... 0x1F6F0: EINA_FALLTHROUGH;
-        case 0x1F6F3 ... 0x1F6FC: EINA_FALLTHROUGH;
-        case 0x1F7E0 ... 0x1F7F0: EINA_FALLTHROUGH;
-        case 0x1F90C ... 0x1F93A: EINA_FALLTHROUGH;
-        case 0x1F93C ... 0x1F945: EINA_FALLTHROUGH;
-        case 0x1F947 ... 0x1F9FF: EINA_FALLTHROUGH;
-        case 0x1FA70 ... 0x1FAF8: EINA_FALLTHROUGH;
-        case 0x20000 ... 0x323AF:
-             return EINA_TRUE;
-          }
-     }
-   else
-     {
-        switch (g)
-          {
-        case 0x1100 ... 0x115F: EINA_FALLTHROUGH;
-        case 0x231A ... 0x231B: EINA_FALLTHROUGH;
-        case 0x2329 ... 0x232A: EINA_FALLTHROUGH;
-        case 0x23E9 ... 0x23EC: EINA_FALLTHROUGH;
-        case 0x23F0: EINA_FALLTHROUGH;
-        case 0x23F3: EINA_FALLTHROUGH;
-        case 0x25FD ... 0x25FE: EINA_FALLTHROUGH;
-        case 0x2614 ... 0x2615: EINA_FALLTHROUGH;
-        case 0x2648 ... 0x2653: EINA_FALLTHROUGH;
-        case 0x267F: EINA_FALLTHROUGH;
-        case 0x2693: EINA_FALLTHROUGH;
-        case 0x26A1: EINA_FALLTHROUGH;
-        case 0x26AA ... 0x26AB: EINA_FALLTHROUGH;
-        case 0x26BD ... 0x26BE: EINA_FALLTHROUGH;
-        case 0x26C4 ... 0x26C5: EINA_FALLTHROUGH;
-        case 0x26CE: EINA_FALLTHROUGH;
-        case 0x26D4: EINA_FALLTHROUGH;
-        case 0x26EA: EINA_FALLTHROUGH;
-        case 0x26F2 ... 0x26F3: EINA_FALLTHROUGH;
-        case 0x26F5: EINA_FALLTHROUGH;
-        case 0x26FA: EINA_FALLTHROUGH;
-        case 0x26FD: EINA_FALLTHROUGH;
-        case 0x2705: EINA_FALLTHROUGH;
-        case 0x270A ... 0x270B: EINA_FALLTHROUGH;
-        case 0x2728: EINA_FALLTHROUGH;
-        case 0x274C: EINA_FALLTHROUGH;
-        case 0x274E: EINA_FALLTHROUGH;
-        case 0x2753 ... 0x2755: EINA_FALLTHROUGH;
-        case 0x2757: EINA_FALLTHROUGH;
-        case 0x2795 ... 0x2797: EINA_FALLTHROUGH;
-        case 0x27B0: EINA_FALLTHROUGH;
-        case 0x27BF: EINA_FALLTHROUGH;
-        case 0x2B1B ... 0x2B1C: EINA_FALLTHROUGH;
-        case 0x2B50: EINA_FALLTHROUGH;
-        case 0x2B55: EINA_FALLTHROUGH;
-        case 0x2E80 ... 0x303E: EINA_FALLTHROUGH;
-        case 0x3041 ... 0x3247: EINA_FALLTHROUGH;
-        case 0x3250 ... 0x4DBF: EINA_FALLTHROUGH;
-        case 0x4E00 ... 0xA4C6: EINA_FALLTHROUGH;
-        case 0xA960 ... 0xA97C: EINA_FALLTHROUGH;
-        case 0xAC00 ... 0xD7A3: EINA_FALLTHROUGH;
-        case 0xF900 ... 0xFAD9: EINA_FALLTHROUGH;
-        case 0xFE10 ... 0xFE19: EINA_FALLTHROUGH;
-        case 0xFE30 ... 0xFE6B: EINA_FALLTHROUGH;
-        case 0xFF01 ... 0xFF60: EINA_FALLTHROUGH;
-        case 0xFFE0 ... 0xFFE6: EINA_FALLTHROUGH;
-        case 0x16FE0 ... 0x1B2FB: EINA_FALLTHROUGH;
-        case 0x1F004: EINA_FALLTHROUGH;
-        case 0x1F0CF: EINA_FALLTHROUGH;
-        case 0x1F18E: EINA_FALLTHROUGH;
-        case 0x1F191 ... 0x1F19A: EINA_FALLTHROUGH;
-        case 0x1F200 ... 0x1F320: EINA_FALLTHROUGH;
-        case 0x1F32D ... 0x1F335: EINA_FALLTHROUGH;
-        case 0x1F337 ... 0x1F37C: EINA_FALLTHROUGH;
-        case 0x1F37E ... 0x1F393: EINA_FALLTHROUGH;
-        case 0x1F3A0 ... 0x1F3CA: EINA_FALLTHROUGH;
-        case 0x1F3CF ... 0x1F3D3: EINA_FALLTHROUGH;
-        case 0x1F3E0 ... 0x1F3F0: EINA_FALLTHROUGH;
-        case 0x1F3F4: EINA_FALLTHROUGH;
-        case 0x1F3F8 ... 0x1F43E: EINA_FALLTHROUGH;
-        case 0x1F440: EINA_FALLTHROUGH;
-        case 0x1F442 ... 0x1F4FC: EINA_FALLTHROUGH;
-        case 0x1F4FF ... 0x1F53D: EINA_FALLTHROUGH;
-        case 0x1F54B ... 0x1F54E: EINA_FALLTHROUGH;
-        case 0x1F550 ... 0x1F567: EINA_FALLTHROUGH;
-        case 0x1F57A: EINA_FALLTHROUGH;
-        case 0x1F595 ... 0x1F596: EINA_FALLTHROUGH;
-        case 0x1F5A4: EINA_FALLTHROUGH;
-        case 0x1F5FB ... 0x1F64F: EINA_FALLTHROUGH;
-        case 0x1F680 ... 0x1F6C5: EINA_FALLTHROUGH;
-        case 0x1F6CC: EINA_FALLTHROUGH;
-        case 0x1F6D0 ... 0x1F6D2: EINA_FALLTHROUGH;
-        case 0x1F6D5 ... 0x1F6DF: EINA_FALLTHROUGH;
-        case 0x1F6EB ... 0x1F6EC: EINA_FALLTHROUGH;
-        case 0x1F6F4 ... 0x1F6FC: EINA_FALLTHROUGH;
-        case 0x1F7E0 ... 0x1F7F0: EINA_FALLTHROUGH;
-        case 0x1F90C ... 0x1F93A: EINA_FALLTHROUGH;
-        case 0x1F93C ... 0x1F945: EINA_FALLTHROUGH;
-        case 0x1F947 ... 0x1F9FF: EINA_FALLTHROUGH;
-        case 0x1FA70 ... 0x1FAF8: EINA_FALLTHROUGH;
-        case 0x20000 ... 0x323AF:
-             return EINA_TRUE;
-          }
-     }
-   return EINA_FALSE;
-}
+   { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0x0C000000, 0x00000600, 0x00000000, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x00091E00 },
+   { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x60000000 },
+   { 0x00300000, 0x00000000, 0x000FFF00, 0x80000000,
+     0x00080000, 0x60000C02, 0x00104030, 0x242C0400 },
+   { 0x00000C20, 0x00000100, 0x00B85000, 0x00000000,
+     0x00E00000, 0x80010000, 0x00000000, 0x00000000 },
+   { 0x18000000, 0x00000000, 0x00210000, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+   { 0xFFFFFFFF, 0x7FFFFFFF, 0xFFFFFFFE, 0xFFFFFFFF,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFF00FF, 0xFFFFFFFF,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+     0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0x00000000 },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+     0xFFFFFFFF, 0xFFFFFFFF, 0x0000007F, 0x00000000 },
+   { 0x00000000, 0x00000000, 0x00000000, 0x1FFFFFFF,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+     0xFFFFFFFF, 0x0000000F, 0x00000000, 0x00000000 },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+     0xFFFFFFFF, 0xFFFFFFFF, 0x03FFFFFF, 0x00000000 },
+   { 0x03FF0000, 0xFFFF0000, 0xFFFFFFFF, 0x00000FFF,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000001,
+     0x00000000, 0x00000000, 0x00000000, 0x0000007F },
+   { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0xFFFFFFFF },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x0FFFFFFF },
+   { 0x00000010, 0x00000000, 0x00000000, 0x00000000,
+     0x00000000, 0x00000000, 0x00008000, 0x00000000 },
+   { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x07FE4000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0xFFFFFFFF, 0xFFBFE001, 0xFFFFFFFF, 0xDFFFFFFF,
+     0x000FFFFF, 0xFFFFFFFF, 0x000F87FF, 0xFF11FFFF },
+   { 0xFFFFFFFF, 0x7FFFFFFF, 0xFFFFFFFD, 0xFFFFFFFF,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x9FFFFFFF },
+   { 0xFFFFFFFF, 0x3FFFFFFF, 0xFFFF7800, 0x040000FF,
+     0x00600000, 0x00000010, 0x00000000, 0xF8000000 },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0x0000FFFF, 0x00000000,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFE7103F, 0x1FF01800 },
+   { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x0001FFFF },
+   { 0xFFFFF000, 0xF7FFFFFF, 0xFFFFFFBF, 0xFFFFFFFF,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+   { 0x00000000, 0x00000000, 0x00000000, 0xFFFF0000,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x01FFFFFF },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+     0xFFFFFFFF, 0x0000FFFF, 0x00000000, 0x00000000 },
+   { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x00000000, 0x00000200, 0x00000000, 0x00000000 },
+   { 0x00000000, 0x10000000, 0x00000200, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0x00000000, 0x02000000, 0x00000000, 0x00000000,
+     0x00000000, 0x00000600, 0x00000000, 0x00000000 },
+   { 0x0C000000, 0x00000700, 0x00000000, 0x00000000,
+     0x00000000, 0x00000000, 0x00008000, 0x070FFE00 },
+   { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x00000000, 0x00000C00, 0x00000000, 0x78000000 },
+   { 0x2132001F, 0x0700C44D, 0x800FFF00, 0xC8000040,
+     0x1AFC0000, 0x60030C83, 0x00104030, 0x242C0400 },
+   { 0x2054BF24, 0x00180102, 0x00B85090, 0x00000018,
+     0x00E00000, 0x80010002, 0x00000000, 0x00000000 },
+   { 0x00000000, 0x00300000, 0x00000000, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0x180000E0, 0x00000000, 0x00210000, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0x0000FFFF, 0x00000000,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFE7F83F, 0x1FF9FA3F },
+   { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x00000000, 0xF7DF6592, 0xC1810040, 0x578D3743 },
+   { 0x080A0002, 0x810E08C0, 0x000C2F17, 0x000008C0,
+     0x00000000, 0x00000000, 0x15554000, 0x00000000 },
+   { 0x00000000, 0x00000000, 0x00020000, 0x00000002,
+     0x00000000, 0x00000000, 0xAF012E90, 0x00000000 },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x0000FFFF,
+     0xFFFE0000, 0xFFFE03FF, 0x000003FB, 0x00000000 },
+   { 0xFFFF0002, 0xFFFFFFFF, 0x0002FFFF, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0x33790000, 0x482D00F7, 0x00000000, 0x80100000,
+     0x0000001E, 0x00001000, 0x00000000, 0x00000000 },
+   { 0x00480228, 0x00000846, 0x78180000, 0x03FF0FFF,
+     0x03FF0200, 0x03000000, 0x00140000, 0x00000080 },
+   { 0xE422898D, 0x30F05FA9, 0x00041100, 0x0000CCF3,
+     0x022000CC, 0x80000020, 0x00000000, 0x00000000 },
+   { 0x0C040000, 0x00000600, 0x00000000, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x00091E00 },
+   { 0x00000000, 0x00000000, 0x00000000, 0xFFFFFFFF,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFBFF },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFF0FFF, 0x000FFFFF,
+     0x003CFFFF, 0x30CC03FB, 0x0003C9C3, 0x6000803C },
+   { 0x5030C260, 0x00000000, 0x000FFF05, 0x8000B7BB,
+     0xC0080000, 0xE0000C02, 0xFFFFFFF0, 0xFFFFFF0B },
+   { 0x00000C20, 0x20000100, 0x00B85000, 0xFFC00000,
+     0x00E00000, 0x80010000, 0x00000000, 0x00000000 },
+   { 0x18000000, 0x00000000, 0x03E10000, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0x03FFFFFF, 0xFFFF0000, 0xFFFFFFFF, 0x00000FFF,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+   { 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000001,
+     0x00000000, 0x00000000, 0x00000000, 0x2000007F },
+   { 0xFFFF07FF, 0xFFFF3FFF, 0xFFFFFFFF, 0xFFFF03FF,
+     0xFFFFFFFF, 0x00001FFF, 0x00000000, 0x00000000 },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+     0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x0000FFFF },
+   { 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x00000000, 0xF7DF6792, 0xC1810040, 0x578D3743 },
+   { 0x33790000, 0x582D00F7, 0x00000200, 0x80100000,
+     0x0000001E, 0x00001000, 0x00000000, 0x00000000 },
+   { 0x00480228, 0x02000846, 0x78180000, 0x03FF0FFF,
+     0x03FF0200, 0x03000600, 0x00140000, 0x00000080 },
+   { 0x0C040000, 0x00000700, 0x00000000, 0x00000000,
+     0x00000000, 0x00000000, 0x00008000, 0x070FFE00 },
+   { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFF0FFF, 0x000FFFFF,
+     0x003CFFFF, 0x30CC0FFB, 0x0003C9C3, 0x7800803C },
+   { 0x7132C27F, 0x0700C44D, 0x800FFF05, 0xC800B7FB,
+     0xDAFC0000, 0xE0030C83, 0xFFFFFFF0, 0xFFFFFF0B },
+   { 0x2054BF24, 0x20180102, 0x00B85090, 0xFFC00018,
+     0x00E00000, 0x80010002, 0x00000000, 0x00000000 },
+   { 0x180000E0, 0x00000000, 0x03E10000, 0x00000000,
+     0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+};
@@ -2,19 +2,27 @@
 #ifndef TERMINOLOGY_TERMPTY_DBL_H_
 #define TERMINOLOGY_TERMPTY_DBL_H_ 1
 
-Eina_Bool _termpty_is_wide(const Eina_Unicode g, Eina_Bool emoji_dbl_width);
-Eina_Bool _termpty_is_ambigous_wide(const Eina_Unicode g, Eina_Bool emoji_dbl_width);
+#define TERMPTY_DBL_PAGE_BITS 8
+#define TERMPTY_DBL_MAX 0xE01EF
+
+/* Pages of the tables, by [cjk_ambiguous_wide][emoji_dbl_width] */
+extern const uint8_t _termpty_dbl_pages[2][2][3586];
+/* Bits of the pages, set on double-width codepoints */
+extern const uint32_t _termpty_dbl_bits[66][8];
 
 static inline Eina_Bool
 _termpty_is_dblwidth_get(const Termpty *ty, const Eina_Unicode g)
 {
+   const uint8_t *pages;
+
    /* optimize for latin1 non-ambiguous */
-   if (g <= 0xA0)
+   if ((g <= 0xA0) || (g > TERMPTY_DBL_MAX))
      return EINA_FALSE;
-   if (!ty->termstate.cjk_ambiguous_wide)
-     return _termpty_is_wide(g, ty->config->emoji_dbl_width);
-   else
-     return _termpty_is_ambigous_wide(g, ty->config->emoji_dbl_width);
+   pages = _termpty_dbl_pages[ty->termstate.cjk_ambiguous_wide]
+      [!!ty->config->emoji_dbl_width];
+   return (_termpty_dbl_bits[pages[g >> TERMPTY_DBL_PAGE_BITS]]
+           [(g >> 5) & ((1 << (TERMPTY_DBL_PAGE_BITS - 5)) - 1)]
+           >> (g & 31)) & 1;
 }
 
 #endif
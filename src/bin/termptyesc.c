@@ -5,6 +5,7 @@
 #include "colors.h"
 #include "termio.h"
 #include "termpty.h"
+#include "backlog.h"
 #include "termptydbl.h"
 #include "termptyesc.h"
 #include "termptyops.h"
@@ -34,6 +35,9 @@
 #define OSC 0x9d
 #define DEL 0x7f
 
+/* Longest CSI sequence kept before giving up on it */
+#define SEQ_BUF_MAX 4096
+
 
 /* XXX: all handle_ functions return the number of bytes successfully read, 0
  * if not enough bytes could be read
@@ -114,17 +118,41 @@ enum esc_arg_error {
      ESC_ARG_ERROR = 2
 };
 
+/* CSI parameters are parsed once, on first use, into a vector that the
+ * handlers then consume with _csi_arg_get().  Parameters separated by ':' are
+ * sub-parameters of the one before them (e.g. "38:2::r:g:b" or "4:3").
+ * Each entry keeps where the parser stopped so that handlers reading the raw
+ * characters, like truecolors, can resume from there. */
+#define CSI_ARGS_MAX 32
+
+typedef struct _Csi_Arg
+{
+   int value; /* or -ESC_ARG_NO_VALUE / -ESC_ARG_ERROR */
+   int next; /* offset of the next parameter, -1 when none is left */
+   Eina_Bool sub; /* followed by a ':' sub-parameter */
+} Csi_Arg;
+
+typedef struct _Csi_Args
+{
+   Eina_Unicode *buf;
+   int pos; /* offset of the next parameter, -1 when none is left */
+   int n, cur;
+   Eina_Bool sub; /* last parameter returned is followed by sub-parameters */
+   Csi_Arg arg[CSI_ARGS_MAX];
+} Csi_Args;
+
 static int
-_csi_arg_get(Termpty *ty, Eina_Unicode **ptr)
+_csi_arg_parse(const Eina_Unicode *buf, int pos, Csi_Arg *arg)
 {
-   Eina_Unicode *b = *ptr;
+   const Eina_Unicode *b = buf + pos;
    int sum = 0;
 
-   if ((b == NULL) || (*b == '\0'))
-     {
-        *ptr = NULL;
-        return -ESC_ARG_NO_VALUE;
-     }
+   arg->value = -ESC_ARG_NO_VALUE;
+   arg->next = -1;
+   arg->sub = EINA_FALSE;
+
+   if (*b == '\0')
+     return -1;
 
    /* Skip potential '?', '>'.... */
    while ((*b) && ( (*b) != ';' && ((*b) < '0' || (*b) > '9')))
@@ -133,50 +161,119 @@ _csi_arg_get(Termpty *ty, Eina_Unicode **ptr)
    if (*b == ';')
      {
         b++;
-        *ptr = b;
-        return -ESC_ARG_NO_VALUE;
+        arg->next = b - buf;
+        return arg->next;
      }
 
    if (*b == '\0')
-     {
-        *ptr = NULL;
-        return -ESC_ARG_NO_VALUE;
-     }
+     return -1;
 
    while ((*b >= '0') && (*b <= '9'))
      {
         if (sum > INT32_MAX/10 )
           {
-             ERR("Invalid sequence: argument is too large");
-             ty->decoding_error = EINA_TRUE;
-             goto error;
+             arg->value = -ESC_ARG_ERROR;
+             return -1;
           }
         sum *= 10;
         sum += *b - '0';
         b++;
      }
+   arg->value = sum;
 
    if ((*b == ';') || (*b == ':'))
      {
+        arg->sub = (*b == ':');
         if (b[1])
           b++;
-        *ptr = b;
+        arg->next = b - buf;
      }
-   else if (*b == '\0')
+   else if (*b != '\0')
      {
-        *ptr = NULL;
+        arg->next = b - buf;
      }
-   else
+   return arg->next;
+}
+
+static void
+_csi_args_fill(Csi_Args *args)
+{
+   int pos = args->pos;
+
+   args->n = 0;
+   args->cur = 0;
+   while ((pos >= 0) && (args->n < CSI_ARGS_MAX))
      {
-        *ptr = b;
+        pos = _csi_arg_parse(args->buf, pos, &args->arg[args->n]);
+        args->n++;
      }
-   return sum;
+}
 
-error:
-   ERR("Invalid CSI argument");
-   ty->decoding_error = EINA_TRUE;
-   *ptr = NULL;
-   return -ESC_ARG_ERROR;
+static void
+_csi_args_init(Csi_Args *args, Eina_Unicode *buf)
+{
+   args->buf = buf;
+   args->pos = 0;
+   args->sub = EINA_FALSE;
+   args->n = 0;
+   args->cur = 0;
+}
+
+/* Whether _csi_arg_get() still has parameters to return */
+static inline Eina_Bool
+_csi_args_more(const Csi_Args *args)
+{
+   return args->pos >= 0;
+}
+
+/* Whether the last parameter returned is followed by sub-parameters */
+static inline Eina_Bool
+_csi_args_sub(const Csi_Args *args)
+{
+   return args->sub;
+}
+
+/* Position of the next parameter in the raw sequence, NULL if none */
+static Eina_Unicode *
+_csi_args_ptr(const Csi_Args *args)
+{
+   if (args->pos < 0)
+     return NULL;
+   return args->buf + args->pos;
+}
+
+/* Continue parsing from @ptr, after reading raw characters */
+static void
+_csi_args_seek(Csi_Args *args, const Eina_Unicode *ptr)
+{
+   args->pos = ptr ? (int)(ptr - args->buf) : -1;
+   args->sub = EINA_FALSE;
+   args->n = 0;
+   args->cur = 0;
+}
+
+static int
+_csi_arg_get(Termpty *ty, Csi_Args *args)
+{
+   const Csi_Arg *arg;
+
+   if (args->pos < 0)
+     {
+        args->sub = EINA_FALSE;
+        return -ESC_ARG_NO_VALUE;
+     }
+   if (args->cur == args->n)
+     _csi_args_fill(args);
+
+   arg = &args->arg[args->cur++];
+   args->pos = arg->next;
+   args->sub = arg->sub;
+   if (arg->value == -ESC_ARG_ERROR)
+     {
+        ERR("Invalid sequence: argument is too large");
+        ty->decoding_error = EINA_TRUE;
+     }
+   return arg->value;
 }
 
 static void
@@ -212,7 +309,7 @@ _handle_cursor_control(Termpty *ty, const Eina_Unicode *cc)
      {
       case 0x07: // BEL '\a' (bell)
         DBG("->BEL");
-         if (ty->cb.bell.func) ty->cb.bell.func(ty->cb.bell.data);
+         termpty_defer(ty, TERMPTY_DEFER_BELL);
          return;
       case 0x08: // BS  '\b' (backspace)
          DBG("->BS");
@@ -223,10 +320,10 @@ _handle_cursor_control(Termpty *ty, const Eina_Unicode *cc)
       case 0x09: // HT  '\t' (horizontal tab)
          DBG("->HT");
          cell = &(TERMPTY_SCREEN(ty, ty->cursor_state.cx, ty->cursor_state.cy));
-         cell->att.tab_inserted = 1;
+         cell->tab_inserted = 1;
          _tab_forward(ty, 1);
          cell = &(TERMPTY_SCREEN(ty, ty->cursor_state.cx -1, ty->cursor_state.cy));
-         cell->att.tab_last = 1;
+         cell->tab_last = 1;
          return;
       case 0x0a: // LF  '\n' (new line)
       case 0x0b: // VT  '\v' (vertical tab)
@@ -280,8 +377,7 @@ _move_cursor_to_origin(Termpty *ty)
 
 
 static void
-_handle_esc_csi_reset_mode(Termpty *ty, Eina_Unicode cc, Eina_Unicode *b,
-                           const Eina_Unicode * const end)
+_handle_esc_csi_reset_mode(Termpty *ty, Eina_Unicode cc, Csi_Args *args)
 {
    Eina_Bool mode = EINA_FALSE;
    Eina_Bool priv = EINA_FALSE;
@@ -289,16 +385,13 @@ _handle_esc_csi_reset_mode(Termpty *ty, Eina_Unicode cc, Eina_Unicode *b,
 
    if (cc == 'h')
      mode = EINA_TRUE;
-   if (*b == '?')
-     {
-        priv = EINA_TRUE;
-        b++;
-     }
+   if (args->buf[0] == '?')
+     priv = EINA_TRUE;
    if (priv) /* DEC Private Mode Reset (DECRST) */
      {
-        while (b && b <= end)
+        while (_csi_args_more(args))
           {
-             arg = _csi_arg_get(ty, &b);
+             arg = _csi_arg_get(ty, args);
              // complete-ish list here:
              // http://ttssh2.sourceforge.jp/manual/en/about/ctrlseq.html
              switch (arg)
@@ -321,12 +414,16 @@ _handle_esc_csi_reset_mode(Termpty *ty, Eina_Unicode cc, Eina_Unicode *b,
                         Evas_Object *wn;
                         int w, h;
 
-                        wn = termio_win_get(ty->obj);
-                        elm_win_size_step_get(wn, &w, &h);
-                        evas_object_resize(wn,
-                                           4 +
-                                           (mode ? 132 : 80) * w,
-                                           4 + ty->h * h);
+                        if (termpty_main_loop_begin(ty))
+                          {
+                             wn = termio_win_get(ty->obj);
+                             elm_win_size_step_get(wn, &w, &h);
+                             evas_object_resize(wn,
+                                                4 +
+                                                (mode ? 132 : 80) * w,
+                                                4 + ty->h * h);
+                             termpty_main_loop_end(ty);
+                          }
                         termpty_resize(ty, mode ? 132 : 80,
                                        ty->h);
                         termpty_reset_state(ty);
@@ -472,8 +569,15 @@ _handle_esc_csi_reset_mode(Termpty *ty, Eina_Unicode cc, Eina_Unicode *b,
                    DBG("%s focus reporting", mode ? "enable" : "disable");
                    if (mode)
                      {
+                        Eina_Bool focused = EINA_FALSE;
+
                         ty->focus_reporting = EINA_TRUE;
-                        termpty_focus_report(ty, termio_is_focused(ty->obj));
+                        if (termpty_main_loop_begin(ty))
+                          {
+                             focused = termio_is_focused(ty->obj);
+                             termpty_main_loop_end(ty);
+                          }
+                        termpty_focus_report(ty, focused);
                      }
                    else
                      {
@@ -540,6 +644,12 @@ _handle_esc_csi_reset_mode(Termpty *ty, Eina_Unicode cc, Eina_Unicode *b,
                 case 2004:
                    ty->bracketed_paste = mode;
                    break;
+                case 2026:
+                   DBG("%s synchronized output", mode ? "begin" : "end");
+                   if ((mode) && (!ty->sync_output.active))
+                     ty->sync_output.start = ecore_time_get();
+                   ty->sync_output.active = mode;
+                   break;
                 case 7700: // ignore
                    WRN("TODO: ambiguous width reporting %i", mode);
                    ty->decoding_error = EINA_TRUE;
@@ -575,9 +685,9 @@ _handle_esc_csi_reset_mode(Termpty *ty, Eina_Unicode cc, Eina_Unicode *b,
      }
    else /* Reset Mode (RM) */
      {
-        while (b && b <= end)
+        while (_csi_args_more(args))
           {
-             arg = _csi_arg_get(ty, &b);
+             arg = _csi_arg_get(ty, args);
 
              switch (arg)
                {
@@ -611,6 +721,91 @@ _handle_esc_csi_reset_mode(Termpty *ty, Eina_Unicode cc, Eina_Unicode *b,
      }
 }
 
+static int
+_decrqm_private_mode(const Termpty *ty, int mode)
+{
+   switch (mode)
+     {
+      case 1:
+         return ty->termstate.appcursor;
+      case 5:
+         return ty->termstate.reverse;
+      case 6:
+         return ty->termstate.restrict_cursor;
+      case 7:
+         return ty->termstate.wrap;
+      case 8:
+         return !ty->termstate.no_autorepeat;
+      case 9:
+         return ty->mouse_mode == MOUSE_X10;
+      case 25:
+         return !ty->termstate.hide_cursor;
+      case 47:
+         EINA_FALLTHROUGH;
+      case 1047:
+         EINA_FALLTHROUGH;
+      case 1049:
+         return ty->altbuf;
+      case 67:
+         return ty->termstate.send_bs;
+      case 69:
+         return ty->termstate.lr_margins;
+      case 1000:
+         return ty->mouse_mode == MOUSE_NORMAL;
+      case 1002:
+         return ty->mouse_mode == MOUSE_NORMAL_BTN_MOVE;
+      case 1003:
+         return ty->mouse_mode == MOUSE_NORMAL_ALL_MOVE;
+      case 1004:
+         return ty->focus_reporting;
+      case 1005:
+         return ty->mouse_ext == MOUSE_EXT_UTF8;
+      case 1006:
+         return ty->mouse_ext == MOUSE_EXT_SGR;
+      case 1015:
+         return ty->mouse_ext == MOUSE_EXT_URXVT;
+      case 2004:
+         return ty->bracketed_paste;
+      case 2026:
+         return ty->sync_output.active;
+      case 7727:
+         return ty->termstate.esc_keycode;
+      case 7728:
+         return ty->termstate.alternate_esc;
+      default:
+         return -1;
+     }
+}
+
+static void
+_handle_esc_csi_decrqm(Termpty *ty, Csi_Args *args)
+{
+   Eina_Bool priv = (args->buf[0] == '?');
+   int arg = _csi_arg_get(ty, args);
+   int state = -1;
+   int len;
+   char bf[32];
+
+   DBG("DECRQM - Request Mode (private: %d) %d", priv, arg);
+   if (arg < 0)
+     {
+        ty->decoding_error = EINA_TRUE;
+        return;
+     }
+   if (priv)
+     state = _decrqm_private_mode(ty, arg);
+   else if (arg == 4)
+     state = ty->termstate.insert;
+   else if (arg == 20)
+     state = ty->termstate.crlf;
+
+   /* 0: not recognized, 1: set, 2: reset */
+   len = snprintf(bf, sizeof(bf), "\033[%s%d;%d$y",
+                  priv ? "?" : "", arg,
+                  (state < 0) ? 0 : (state ? 1 : 2));
+   termpty_write(ty, bf, len);
+}
+
 static int
 _csi_truecolor_arg_get(Termpty *ty, Eina_Unicode **ptr)
 {
@@ -684,67 +879,68 @@ _csi_truecolor_arg_get(Termpty *ty, Eina_Unicode **ptr)
 /*********************************
  * cache true color approximations
  *********************************
- * Approximating true colors is costly since it needs to compare 256 colors.
- * The following considers that a few colors are used a lot.  For example, one
- * can consider that a text editor with syntax highlighting would only use a
- * small palette.
- * Given that, using the cache needs to be efficient: it needs to speed up the
- * approximation when the color is already in the cache but not knowing the
- * color requested is not in the cache needs to be efficient too.
+ * Even with the palette lookup table, approximating a true color is more
+ * costly than remembering it.  One can consider that a few colors are used
+ * a lot: for example, a text editor with syntax highlighting would only use
+ * a small palette.
  *
- * The cache is an array of @TCC_LEN uint32_t.
+ * Each terminal has its own cache since terminals may have different
+ * palettes.  It is set-associative: a color can only live in the
+ * @TERMPTY_TCC_WAYS entries of the set its hash points to.  Entries of a set
+ * are kept from the most recently used to the least recently used one,
+ * which is the one evicted when a new color comes in.
  * Each entry has on the MSB the color as 3 uint8_t (R,G,B) and the LSB is
  * the approximated color.
- * Searching a color is simply going through the array and testing the mask on
- * the 3 most significant bytes.
- * When a color is found, it is bubbled up towards the start of the array by
- * swapping this entry with the one above.  This way the array is ordered to
- * get most used colors as fast as possible.
- * When a color is not found, the slow process of comparing it with the 256
- * colors is used.  Then the result is inserted in the lower half of the
- * array.  This ensures that new entries can live a bit and not be removed by
- * the next new color.  Using a modulo with a prime number makes for a
- * nice-enough random generator to figure out where to insert.
  */
-#define TCC_LEN 32
-#define TCC_PRIME 17 /* smallest prime number larger than @TCC_LEN/2 */
-static struct {
-     uint32_t colors[TCC_LEN];
-} _truecolor_cache;
-static int _tcc_random_pos = 0;
+static inline unsigned int
+_tcc_set(const uint32_t color_msb)
+{
+   return (color_msb * 2654435761u) >> (32 - TERMPTY_TCC_SETS_BITS);
+}
 
 static Eina_Bool
-_tcc_find(const uint32_t color_msb, uint8_t *chosen_color)
+_tcc_find(Termpty *ty, const uint32_t color_msb, uint8_t *chosen_color)
 {
+   const unsigned int set = _tcc_set(color_msb);
+   uint32_t *colors = ty->tcc.colors[set];
    int i;
-   for (i = 0; i < TCC_LEN; i++)
+
+   for (i = 0; i < ty->tcc.used[set]; i++)
      {
-        if ((_truecolor_cache.colors[i] & 0xffffff00) == color_msb)
+        if ((colors[i] & 0xffffff00) == color_msb)
           {
-             *chosen_color = _truecolor_cache.colors[i] & 0xff;
-             /* bubble up this result */
-             if (i > 0)
-               {
-                  uint32_t prev = _truecolor_cache.colors[i - 1];
-                  _truecolor_cache.colors[i - 1] = _truecolor_cache.colors[i];
-                  _truecolor_cache.colors[i] = prev;
-               }
+             uint32_t c = colors[i];
+
+             *chosen_color = c & 0xff;
+             /* move it first */
+             for (; i > 0; i--)
+               colors[i] = colors[i - 1];
+             colors[0] = c;
+             ty->tcc.hits++;
              return EINA_TRUE;
           }
      }
+   ty->tcc.misses++;
    return EINA_FALSE;
 }
 
 static void
-_tcc_insert(const uint32_t color_msb, const uint8_t approximated)
+_tcc_insert(Termpty *ty, const uint32_t color_msb, const uint8_t approximated)
 {
-   uint32_t c = color_msb | approximated;
-   int i;
-
-   _tcc_random_pos = ((_tcc_random_pos + TCC_PRIME) % (TCC_LEN / 2));
-   i = (TCC_LEN / 2) + _tcc_random_pos;
+   const unsigned int set = _tcc_set(color_msb);
+   uint32_t *colors = ty->tcc.colors[set];
+   int i = ty->tcc.used[set];
 
-  _truecolor_cache.colors[i] = c;
+   if (i == TERMPTY_TCC_WAYS)
+     {
+        ty->tcc.evictions++;
+        i--;
+     }
+   else
+     ty->tcc.used[set]++;
+   for (; i > 0; i--)
+     colors[i] = colors[i - 1];
+   colors[0] = color_msb | approximated;
 }
 #endif
 
@@ -758,62 +954,42 @@ _approximate_truecolor_rgb(Termpty *ty, uint8_t r0, uint8_t g0, uint8_t b0)
    (void) g0;
    (void) b0;
 #else
-   int c;
-   int distance_min = INT_MAX;
-   Evas_Object *textgrid;
    const uint32_t color_msb = 0
       | (((uint32_t)r0) << 24)
       | (((uint32_t)g0) << 16)
       | (((uint32_t)b0) << 8);
 
-   if (_tcc_find(color_msb, &chosen_color))
+   if (_tcc_find(ty, color_msb, &chosen_color))
      return chosen_color;
 
-   textgrid = termio_textgrid_get(ty->obj);
-   for (c = 0; c < 256; c++)
+   if (!ty->color_lut)
      {
-        int r1 = 0, g1 = 0, b1 = 0, a1 = 0;
-        int delta_red_sq, delta_green_sq, delta_blue_sq, red_mean;
-        int distance;
+        uint8_t palette[256][3];
+        int c;
 
-        evas_object_textgrid_palette_get(textgrid,
-                                         EVAS_TEXTGRID_PALETTE_EXTENDED,
-                                         c, &r1, &g1, &b1, &a1);
-        /* Compute the color distance
-         * XXX: this is inacurate but should give good enough results.
-         * See https://en.wikipedia.org/wiki/Color_difference
-         */
-        red_mean = (r0 + r1) / 2;
-        delta_red_sq = (r0 - r1) * (r0 - r1);
-        delta_green_sq = (g0 - g1) * (g0 - g1);
-        delta_blue_sq = (b0 - b1) * (b0 - b1);
-
-#if 1
-        distance = 2 * delta_red_sq
-           + 4 * delta_green_sq
-           + 3 * delta_blue_sq
-           + ((red_mean) * (delta_red_sq - delta_blue_sq) / 256);
-#else
-        /* from https://www.compuphase.com/cmetric.htm */
-        distance = (((512 + red_mean) * delta_red_sq) >> 8)
-                 + 4 * delta_green_sq
-                 + (((767 - red_mean) * delta_blue_sq) >> 8);
-        /* euclidian distance */
-        distance = delta_red_sq + delta_green_sq + delta_blue_sq;
-        (void)red_mean;
-#endif
-        if (distance < distance_min)
+        if (!termpty_main_loop_begin(ty))
+          return chosen_color;
+        for (c = 0; c < 256; c++)
           {
-             distance_min = distance;
-             chosen_color = c;
+             int r1 = 0, g1 = 0, b1 = 0, a1 = 0;
+
+             termio_palette_extended_get(ty->obj, c, &r1, &g1, &b1, &a1);
+             palette[c][0] = r1;
+             palette[c][1] = g1;
+             palette[c][2] = b1;
           }
+        termpty_main_loop_end(ty);
+        ty->color_lut = colors_lut_new(palette);
+        if (!ty->color_lut)
+          return chosen_color;
      }
-   _tcc_insert(color_msb, chosen_color);
+   chosen_color = colors_lut_nearest(ty->color_lut, r0, g0, b0);
+   _tcc_insert(ty, color_msb, chosen_color);
 #endif
    return chosen_color;
 }
 
-static uint8_t
+static int
 _handle_esc_csi_truecolor_rgb(Termpty *ty, Eina_Unicode **ptr)
 {
    int r, g, b;
@@ -822,7 +998,7 @@ _handle_esc_csi_truecolor_rgb(Termpty *ty, Eina_Unicode **ptr)
 
    if ((u == NULL) || (*u == '\0'))
      {
-        return COL_DEF;
+        return -1;
      }
    separator = *(u-1);
 
@@ -832,7 +1008,7 @@ _handle_esc_csi_truecolor_rgb(Termpty *ty, Eina_Unicode **ptr)
    if ((r == -ESC_ARG_ERROR) ||
        (g == -ESC_ARG_ERROR) ||
        (b == -ESC_ARG_ERROR))
-     return COL_DEF;
+     return -1;
 
    if (separator == ':' && *ptr)
      {
@@ -863,10 +1039,10 @@ _handle_esc_csi_truecolor_rgb(Termpty *ty, Eina_Unicode **ptr)
    if (b == -ESC_ARG_NO_VALUE)
      b = 0;
 
-   return _approximate_truecolor_rgb(ty, (uint8_t)r, (uint8_t)g, (uint8_t)b);
+   return ((uint8_t)r << 16) | ((uint8_t)g << 8) | (uint8_t)b;
 }
 
-static uint8_t
+static int
 _handle_esc_csi_truecolor_cmy(Termpty *ty, Eina_Unicode **ptr)
 {
    int r, g, b, c, m, y;
@@ -875,7 +1051,7 @@ _handle_esc_csi_truecolor_cmy(Termpty *ty, Eina_Unicode **ptr)
 
    if ((u == NULL) || (*u == '\0'))
      {
-        return COL_DEF;
+        return -1;
      }
    separator = *(u-1);
 
@@ -887,7 +1063,7 @@ _handle_esc_csi_truecolor_cmy(Termpty *ty, Eina_Unicode **ptr)
    if ((c == -ESC_ARG_ERROR) ||
        (m == -ESC_ARG_ERROR) ||
        (y == -ESC_ARG_ERROR))
-     return COL_DEF;
+     return -1;
 
    if (separator == ':' && *ptr)
      {
@@ -922,10 +1098,10 @@ _handle_esc_csi_truecolor_cmy(Termpty *ty, Eina_Unicode **ptr)
    g = 255 - ((m * 255) / 100);
    b = 255 - ((y * 255) / 100);
 
-   return _approximate_truecolor_rgb(ty, (uint8_t)r, (uint8_t)g, (uint8_t)b);
+   return ((uint8_t)r << 16) | ((uint8_t)g << 8) | (uint8_t)b;
 }
 
-static uint8_t
+static int
 _handle_esc_csi_truecolor_cmyk(Termpty *ty, Eina_Unicode **ptr)
 {
    int r, g, b, c, m, y, k;
@@ -934,7 +1110,7 @@ _handle_esc_csi_truecolor_cmyk(Termpty *ty, Eina_Unicode **ptr)
 
    if ((u == NULL) || (*u == '\0'))
      {
-        return COL_DEF;
+        return -1;
      }
    separator = *(u-1);
 
@@ -948,7 +1124,7 @@ _handle_esc_csi_truecolor_cmyk(Termpty *ty, Eina_Unicode **ptr)
        (m == -ESC_ARG_ERROR) ||
        (y == -ESC_ARG_ERROR) ||
        (k == -ESC_ARG_ERROR))
-     return COL_DEF;
+     return -1;
 
    if (separator == ':' && *ptr)
      {
@@ -986,19 +1162,75 @@ _handle_esc_csi_truecolor_cmyk(Termpty *ty, Eina_Unicode **ptr)
    g = (255 * (100 - m) * (100 - k)) / 100 / 100;
    b = (255 * (100 - y) * (100 - k)) / 100 / 100;
 
-   return _approximate_truecolor_rgb(ty, (uint8_t)r, (uint8_t)g, (uint8_t)b);
+   return ((uint8_t)r << 16) | ((uint8_t)g << 8) | (uint8_t)b;
 }
 
+/* Truecolors read the raw sequence: empty sub-parameters are significant
+ * there.
+ * The color is stored exactly if enabled and there is room, approximated
+ * in the extended palette otherwise */
 static void
-_handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
-                          const Eina_Unicode * const end)
+_handle_esc_csi_truecolor(Termpty *ty, Csi_Args *args, int space,
+                          Eina_Bool is_bg)
 {
-   Eina_Unicode *b = *ptr;
+   Eina_Unicode *ptr = _csi_args_ptr(args);
+   Termatt *att = &ty->termstate.att;
+   int rgb, id = -1;
+   uint8_t color = COL_DEF;
 
+   switch (space)
+     {
+      case 2:
+         rgb = _handle_esc_csi_truecolor_rgb(ty, &ptr);
+         break;
+      case 3:
+         rgb = _handle_esc_csi_truecolor_cmy(ty, &ptr);
+         break;
+      default:
+         rgb = _handle_esc_csi_truecolor_cmyk(ty, &ptr);
+         break;
+     }
+   _csi_args_seek(args, ptr);
+
+   if (rgb >= 0)
+     {
+        if ((ty->config) && (ty->config->exact_truecolor))
+          id = termpty_truecolor_id_get(ty, rgb);
+        if (id >= 0)
+          color = id & 0xff;
+        else
+          color = _approximate_truecolor_rgb(ty, rgb >> 16,
+                                             (rgb >> 8) & 0xff, rgb & 0xff);
+     }
+   if (is_bg)
+     {
+        att->bg256 = 1;
+        att->bg = color;
+        att->bgrgb = (id >= 0);
+        att->bg_hi = (id >= 0) ? (id >> 8) : 0;
+     }
+   else
+     {
+        att->fg256 = 1;
+        att->fg = color;
+        att->fgrgb = (id >= 0);
+        att->fg_hi = (id >= 0) ? (id >> 8) : 0;
+     }
+   DBG("truecolor %s: #%06x got %s %d", is_bg ? "bg" : "fg", rgb,
+       (id >= 0) ? "exact color" : "approximation", (id >= 0) ? id : color);
+}
+
+/* Colors set without _handle_esc_csi_truecolor() are never exact */
+#define FG_RGB_CLEAR(Att) do { (Att).fgrgb = 0; (Att).fg_hi = 0; } while (0)
+#define BG_RGB_CLEAR(Att) do { (Att).bgrgb = 0; (Att).bg_hi = 0; } while (0)
+
+static void
+_handle_esc_csi_color_set(Termpty *ty, Csi_Args *args)
+{
    DBG("color set");
-   while (b && b <= end)
+   while (_csi_args_more(args))
      {
-        int arg = _csi_arg_get(ty, &b);
+        int arg = _csi_arg_get(ty, args);
         switch (arg)
           {
            case -ESC_ARG_ERROR:
@@ -1019,6 +1251,9 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
               break;
            case 4: // underline
               ty->termstate.att.underline = 1;
+              /* 4:0 is no underline, other styles are drawn as single */
+              if ((_csi_args_sub(args)) && (_csi_arg_get(ty, args) == 0))
+                ty->termstate.att.underline = 0;
               break;
            case 5: // blink
               ty->termstate.att.blink = 1;
@@ -1074,11 +1309,12 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
            case 36:
            case 37:
               ty->termstate.att.fg256 = 0;
+              FG_RGB_CLEAR(ty->termstate.att);
               ty->termstate.att.fg = (arg - 30) + COL_BLACK;
               ty->termstate.att.fgintense = 0;
               break;
            case 38: // xterm 256 fg color ???
-              arg = _csi_arg_get(ty, &b);
+              arg = _csi_arg_get(ty, args);
               switch (arg)
                 {
                  case -ESC_ARG_ERROR:
@@ -1087,32 +1323,19 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
                     return;
                  case 1:
                     ty->termstate.att.fg256 = 0;
+                    FG_RGB_CLEAR(ty->termstate.att);
                     ty->termstate.att.fg = COL_INVIS;
                     break;
-                 case 2:
-                    ty->termstate.att.fg256 = 1;
-                    ty->termstate.att.fg =
-                       _handle_esc_csi_truecolor_rgb(ty, &b);
-                    DBG("truecolor RGB fg: approximation got color %d",
-                        ty->termstate.att.fg);
-                    break;
-                 case 3:
-                    ty->termstate.att.fg256 = 1;
-                    ty->termstate.att.fg =
-                       _handle_esc_csi_truecolor_cmy(ty, &b);
-                    DBG("truecolor CMY fg: approximation got color %d",
-                        ty->termstate.att.fg);
-                    break;
-                 case 4:
-                    ty->termstate.att.fg256 = 1;
-                    ty->termstate.att.fg =
-                       _handle_esc_csi_truecolor_cmyk(ty, &b);
-                    DBG("truecolor CMYK fg: approximation got color %d",
-                        ty->termstate.att.fg);
+                 case 2: // RGB
+                    EINA_FALLTHROUGH;
+                 case 3: // CMY
+                    EINA_FALLTHROUGH;
+                 case 4: // CMYK
+                    _handle_esc_csi_truecolor(ty, args, arg, EINA_FALSE);
                     break;
                  case 5:
                     // then get next arg - should be color index 0-255
-                    arg = _csi_arg_get(ty, &b);
+                    arg = _csi_arg_get(ty, args);
                     if (arg <= -ESC_ARG_ERROR || arg > 255)
                       {
                          ERR("Invalid fg color %d", arg);
@@ -1123,6 +1346,7 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
                          if (arg == -ESC_ARG_NO_VALUE)
                            arg = 0;
                          ty->termstate.att.fg256 = 1;
+                         FG_RGB_CLEAR(ty->termstate.att);
                          ty->termstate.att.fg = arg;
                       }
                     break;
@@ -1134,6 +1358,7 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
               break;
            case 39: // default fg color
               ty->termstate.att.fg256 = 0;
+              FG_RGB_CLEAR(ty->termstate.att);
               ty->termstate.att.fg = COL_DEF;
               ty->termstate.att.fgintense = 0;
               break;
@@ -1146,11 +1371,12 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
            case 46:
            case 47:
               ty->termstate.att.bg256 = 0;
+              BG_RGB_CLEAR(ty->termstate.att);
               ty->termstate.att.bg = (arg - 40) + COL_BLACK;
               ty->termstate.att.bgintense = 0;
               break;
            case 48: // xterm 256 bg color ???
-              arg = _csi_arg_get(ty, &b);
+              arg = _csi_arg_get(ty, args);
               switch (arg)
                 {
                  case -ESC_ARG_ERROR:
@@ -1159,32 +1385,19 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
                     return;
                  case 1:
                     ty->termstate.att.bg256 = 0;
+                    BG_RGB_CLEAR(ty->termstate.att);
                     ty->termstate.att.bg = COL_INVIS;
                     break;
-                 case 2:
-                    ty->termstate.att.bg256 = 1;
-                    ty->termstate.att.bg =
-                       _handle_esc_csi_truecolor_rgb(ty, &b);
-                    DBG("truecolor RGB bg: approximation got color %d",
-                        ty->termstate.att.bg);
-                    break;
-                 case 3:
-                    ty->termstate.att.bg256 = 1;
-                    ty->termstate.att.bg =
-                       _handle_esc_csi_truecolor_cmy(ty, &b);
-                    DBG("truecolor CMY bg: approximation got color %d",
-                        ty->termstate.att.bg);
-                    break;
-                 case 4:
-                    ty->termstate.att.bg256 = 1;
-                    ty->termstate.att.bg =
-                       _handle_esc_csi_truecolor_cmyk(ty, &b);
-                    DBG("truecolor CMYK bg: approximation got color %d",
-                        ty->termstate.att.bg);
+                 case 2: // RGB
+                    EINA_FALLTHROUGH;
+                 case 3: // CMY
+                    EINA_FALLTHROUGH;
+                 case 4: // CMYK
+                    _handle_esc_csi_truecolor(ty, args, arg, EINA_TRUE);
                     break;
                  case 5:
                     // then get next arg - should be color index 0-255
-                    arg = _csi_arg_get(ty, &b);
+                    arg = _csi_arg_get(ty, args);
                     if (arg <= -ESC_ARG_ERROR || arg > 255)
                       {
                          ERR("Invalid bg color %d", arg);
@@ -1195,6 +1408,7 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
                          if (arg == -ESC_ARG_NO_VALUE)
                            arg = 0;
                          ty->termstate.att.bg256 = 1;
+                         BG_RGB_CLEAR(ty->termstate.att);
                          ty->termstate.att.bg = arg;
                       }
                     break;
@@ -1206,6 +1420,7 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
               break;
            case 49: // default bg color
               ty->termstate.att.bg256 = 0;
+              BG_RGB_CLEAR(ty->termstate.att);
               ty->termstate.att.bg = COL_DEF;
               ty->termstate.att.bgintense = 0;
               break;
@@ -1236,11 +1451,13 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
            case 96:
            case 97:
               ty->termstate.att.fg256 = 0;
+              FG_RGB_CLEAR(ty->termstate.att);
               ty->termstate.att.fg = (arg - 90) + COL_BLACK;
               ty->termstate.att.fgintense = 1;
               break;
            case 99: // default fg color
               ty->termstate.att.fg256 = 0;
+              FG_RGB_CLEAR(ty->termstate.att);
               ty->termstate.att.fg = COL_DEF;
               ty->termstate.att.fgintense = 1;
               break;
@@ -1253,11 +1470,13 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
            case 106:
            case 107:
               ty->termstate.att.bg256 = 0;
+              BG_RGB_CLEAR(ty->termstate.att);
               ty->termstate.att.bg = (arg - 100) + COL_BLACK;
               ty->termstate.att.bgintense = 1;
               break;
            case 109: // default bg color
               ty->termstate.att.bg256 = 0;
+              BG_RGB_CLEAR(ty->termstate.att);
               ty->termstate.att.bg = COL_DEF;
               ty->termstate.att.bgintense = 1;
               break;
@@ -1266,14 +1485,160 @@ _handle_esc_csi_color_set(Termpty *ty, Eina_Unicode **ptr,
               ty->decoding_error = EINA_TRUE;
               break;
           }
+        /* sub-parameters are not attributes on their own */
+        while (_csi_args_sub(args))
+          _csi_arg_get(ty, args);
      }
 }
 
+static uint32_t
+_sgr_cache_hash(uint64_t att, const char *key, int len)
+{
+   uint32_t h = 2166136261u;
+   unsigned int i;
+
+   for (i = 0; i < sizeof(att); i++)
+     h = (h ^ ((att >> (i * 8)) & 0xff)) * 16777619u;
+   for (i = 0; i < (unsigned int)len; i++)
+     h = (h ^ (unsigned char)key[i]) * 16777619u;
+   return h;
+}
+
+/* Applications repeat the same few SGR sequences over and over: remember
+ * the attributes each one led to from the current attributes */
 static void
-_handle_esc_csi_cnl(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_sgr(Termpty *ty, Csi_Args *args, int len)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   Termpty_Sgr *e;
+   Termatt in;
+   uint64_t in_packed;
+   char key[TERMPTY_SGR_KEY_MAX];
+   unsigned int decoding_error;
+   int i;
+
+   if (len > TERMPTY_SGR_KEY_MAX)
+     {
+        _handle_esc_csi_color_set(ty, args);
+        return;
+     }
+   /* parameters are all below '?' */
+   for (i = 0; i < len; i++)
+     key[i] = args->buf[i];
+   in = ty->termstate.att;
+   in_packed = termpty_att_pack(&in);
+   e = &ty->sgr_cache.entries[_sgr_cache_hash(in_packed, key, len)
+                              & (TERMPTY_SGR_CACHE_LEN - 1)];
+   if ((e->used) && (e->len == len) &&
+       (termpty_att_pack(&e->in) == in_packed) &&
+       (!memcmp(e->key, key, len)))
+     {
+        ty->sgr_cache.hits++;
+        ty->termstate.att = e->out;
+        return;
+     }
+   ty->sgr_cache.misses++;
+
+   decoding_error = ty->decoding_error;
+   ty->decoding_error = EINA_FALSE;
+   _handle_esc_csi_color_set(ty, args);
+   /* keep invalid sequences out so that they are still reported */
+   if (!ty->decoding_error)
+     {
+        e->in = in;
+        e->out = ty->termstate.att;
+        e->len = len;
+        memcpy(e->key, key, len);
+        e->used = 1;
+     }
+   ty->decoding_error |= decoding_error;
+}
+
+uint8_t
+termpty_truecolor_approximate(Termpty *ty, uint32_t rgb)
+{
+   return _approximate_truecolor_rgb(ty, rgb >> 16,
+                                     (rgb >> 8) & 0xff, rgb & 0xff);
+}
+
+/* Truecolor approximations depend on the palette */
+void
+termpty_palette_changed(Termpty *ty)
+{
+   termpty_backlog_lock(ty);
+   memset(ty->sgr_cache.entries, 0, sizeof(ty->sgr_cache.entries));
+   memset(ty->tcc.used, 0, sizeof(ty->tcc.used));
+   colors_lut_free(ty->color_lut);
+   ty->color_lut = NULL;
+   termpty_backlog_unlock(ty);
+}
+
+/* How the cache of truecolor approximations fared so far */
+void
+termpty_tcc_stats_get(Termpty *ty, Termpty_Cache_Stats *stats)
+{
+   termpty_backlog_lock(ty);
+   stats->hits = ty->tcc.hits;
+   stats->misses = ty->tcc.misses;
+   stats->evictions = ty->tcc.evictions;
+   termpty_backlog_unlock(ty);
+}
+
+/* How the cache of SGR sequences fared so far. Its entries are replaced
+ * without being counted as evicted */
+void
+termpty_sgr_cache_stats_get(Termpty *ty, Termpty_Cache_Stats *stats)
+{
+   termpty_backlog_lock(ty);
+   stats->hits = ty->sgr_cache.hits;
+   stats->misses = ty->sgr_cache.misses;
+   stats->evictions = 0;
+   termpty_backlog_unlock(ty);
+}
+
+#if defined(BINARY_TYTEST)
+int
+tytest_cache_stats(void)
+{
+   static const Eina_Unicode sgr[] = {
+        ESC, '[', '1', ';', '3', '1', 'm'
+   };
+   const int len = sizeof(sgr) / sizeof(sgr[0]);
+   Termpty ty;
+   Termpty_Cache_Stats stats;
+   uint32_t rgb;
+   int i;
+
+   memset(&ty, 0, sizeof(ty));
+   for (i = 0; i < 3; i++)
+     assert(termpty_handle_seq(&ty, sgr, sgr + len) == len);
+   /* the first one applies to other attributes than the next ones */
+   termpty_sgr_cache_stats_get(&ty, &stats);
+   assert(stats.hits == 1);
+   assert(stats.misses == 2);
+   assert(stats.evictions == 0);
+
+   termpty_truecolor_approximate(&ty, 0x123456);
+   termpty_truecolor_approximate(&ty, 0x123456);
+   termpty_tcc_stats_get(&ty, &stats);
+   assert(stats.hits == 1);
+   assert(stats.misses == 1);
+   assert(stats.evictions == 0);
+   /* more colors than the cache holds */
+   for (rgb = 0; rgb < 1000; rgb++)
+     termpty_truecolor_approximate(&ty, rgb * 0x010101);
+   termpty_tcc_stats_get(&ty, &stats);
+   assert(stats.misses == 1001);
+   assert(stats.evictions == 1001 - (1 << TERMPTY_TCC_SETS_BITS)
+                                    * TERMPTY_TCC_WAYS);
+   colors_lut_free(ty.color_lut);
+   return 0;
+}
+#endif
+
+static void
+_handle_esc_csi_cnl(Termpty *ty, Csi_Args *args)
+{
+   int arg = _csi_arg_get(ty, args);
    int max = ty->h;
 
    if (arg == -ESC_ARG_ERROR)
@@ -1295,10 +1660,9 @@ _handle_esc_csi_cnl(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_cpl(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_cpl(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
    int max = ty->h;
 
    if (arg == -ESC_ARG_ERROR)
@@ -1319,11 +1683,25 @@ _handle_esc_csi_cpl(Termpty *ty, Eina_Unicode **ptr)
    ty->cursor_state.cx = ty->termstate.left_margin;
 }
 
+/* Cell shifted in by deleting characters */
 static void
-_handle_esc_csi_dch(Termpty *ty, Eina_Unicode **ptr)
+_cell_blank(Termpty *ty, Termcell *cell)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   Termatt att = ty->termstate.att;
+   uint16_t link_id = TERMPTY_CELL_ATT(ty, cell)->link_id;
+
+   cell->codepoint = ' ';
+   if (EINA_UNLIKELY(link_id))
+     term_link_refcount_dec(ty, link_id, 1);
+   att.link_id = 0;
+   att.dblwidth = 0;
+   termpty_cell_att_set(ty, cell, &att);
+}
+
+static void
+_handle_esc_csi_dch(Termpty *ty, Csi_Args *args)
+{
+   int arg = _csi_arg_get(ty, args);
    Termcell *cells;
    int x, lim, max;
 
@@ -1352,31 +1730,21 @@ _handle_esc_csi_dch(Termpty *ty, Eina_Unicode **ptr)
         if (x < lim)
           TERMPTY_CELL_COPY(ty, &(cells[x + arg]), &(cells[x]), 1);
         else
-          {
-             cells[x].codepoint = ' ';
-             if (EINA_UNLIKELY(cells[x].att.link_id))
-               term_link_refcount_dec(ty, cells[x].att.link_id, 1);
-             cells[x].att = ty->termstate.att;
-             cells[x].att.link_id = 0;
-             cells[x].att.dblwidth = 0;
-          }
+          _cell_blank(ty, &cells[x]);
      }
 }
 
 
 static void
-_handle_esc_csi_dsr(Termpty *ty, Eina_Unicode *b)
+_handle_esc_csi_dsr(Termpty *ty, Csi_Args *args)
 {
    int arg, len;
    char bf[32];
    Eina_Bool question_mark = EINA_FALSE;
 
-   if (*b == '?')
-     {
-        question_mark = EINA_TRUE;
-        b++;
-     }
-   arg = _csi_arg_get(ty, &b);
+   if (args->buf[0] == '?')
+     question_mark = EINA_TRUE;
+   arg = _csi_arg_get(ty, args);
    switch (arg)
      {
       case -ESC_ARG_ERROR:
@@ -1486,7 +1854,7 @@ _handle_esc_csi_dsr(Termpty *ty, Eina_Unicode *b)
          if (question_mark)
            {
               /* DSR-DECCKSR (Memory Checksum) */
-              int pid = _csi_arg_get(ty, &b);
+              int pid = _csi_arg_get(ty, args);
               if (pid == -ESC_ARG_NO_VALUE)
                 pid = 65535;
               len = snprintf(bf, sizeof(bf), "\033P%u!~0000\033\\",
@@ -1523,10 +1891,10 @@ _handle_esc_csi_dsr(Termpty *ty, Eina_Unicode *b)
 }
 
 static void
-_handle_esc_csi_decslrm(Termpty *ty, Eina_Unicode **b)
+_handle_esc_csi_decslrm(Termpty *ty, Csi_Args *args)
 {
-  int left = _csi_arg_get(ty, b);
-  int right = _csi_arg_get(ty, b);
+  int left = _csi_arg_get(ty, args);
+  int right = _csi_arg_get(ty, args);
 
   DBG("DECSLRM (%d;%d) Set Left and Right Margins", left, right);
   if ((left == -ESC_ARG_ERROR) || (right == -ESC_ARG_ERROR))
@@ -1557,10 +1925,10 @@ bad:
 }
 
 static void
-_handle_esc_csi_decstbm(Termpty *ty, Eina_Unicode **b)
+_handle_esc_csi_decstbm(Termpty *ty, Csi_Args *args)
 {
-  int top = _csi_arg_get(ty, b);
-  int bottom = _csi_arg_get(ty, b);
+  int top = _csi_arg_get(ty, args);
+  int bottom = _csi_arg_get(ty, args);
 
   DBG("DECSTBM (%d;%d) Set Top and Bottom Margins", top, bottom);
   if ((top == -ESC_ARG_ERROR) || (bottom == -ESC_ARG_ERROR))
@@ -1724,14 +2092,14 @@ _clean_up_from_to_coordinates(Termpty *ty,
 }
 
 static void
-_handle_esc_csi_decfra(Termpty *ty, Eina_Unicode **b)
+_handle_esc_csi_decfra(Termpty *ty, Csi_Args *args)
 {
-   int c = _csi_arg_get(ty, b);
+   int c = _csi_arg_get(ty, args);
 
-   int top = _csi_arg_get(ty, b);
-   int left = _csi_arg_get(ty, b);
-   int bottom = _csi_arg_get(ty, b);
-   int right = _csi_arg_get(ty, b);
+   int top = _csi_arg_get(ty, args);
+   int left = _csi_arg_get(ty, args);
+   int bottom = _csi_arg_get(ty, args);
+   int right = _csi_arg_get(ty, args);
    int len;
 
    DBG("DECFRA (%d; %d;%d;%d;%d) Fill Rectangular Area",
@@ -1760,7 +2128,7 @@ _handle_esc_csi_decfra(Termpty *ty, Eina_Unicode **b)
 }
 
 static void
-_deccara(Termcell *cells, int len,
+_deccara(Termpty *ty, Termcell *cells, int len,
          Eina_Bool set_bold, Eina_Bool reset_bold,
          Eina_Bool set_underline, Eina_Bool reset_underline,
          Eina_Bool set_blink, Eina_Bool reset_blink,
@@ -1770,31 +2138,33 @@ _deccara(Termcell *cells, int len,
 
    for (i = 0; i < len; i++)
      {
-        Termatt * att = &cells[i].att;
+        Termatt att;
+
+        termpty_cell_att_get(ty, &cells[i], &att);
         if (set_bold)
-          att->bold = 1;
+          att.bold = 1;
         if (set_underline)
-          att->underline = 1;
+          att.underline = 1;
         if (set_blink)
-          att->blink = 1;
+          att.blink = 1;
         if (set_inverse)
-          att->inverse = 1;
+          att.inverse = 1;
         if (reset_bold)
-          att->bold = 0;
+          att.bold = 0;
         if (reset_underline)
-          att->underline = 0;
+          att.underline = 0;
         if (reset_blink)
-          att->blink = 0;
+          att.blink = 0;
         if (reset_inverse)
-          att->inverse = 0;
+          att.inverse = 0;
+        termpty_cell_att_set(ty, &cells[i], &att);
      }
 }
 
 static void
-_handle_esc_csi_deccara(Termpty *ty, Eina_Unicode **ptr,
+_handle_esc_csi_deccara(Termpty *ty, Csi_Args *args,
                         const Eina_Unicode * const end)
 {
-   Eina_Unicode *b = *ptr;
    Termcell *cells;
    int top;
    int left;
@@ -1806,10 +2176,10 @@ _handle_esc_csi_deccara(Termpty *ty, Eina_Unicode **ptr,
    Eina_Bool set_blink = EINA_FALSE, reset_blink = EINA_FALSE;
    Eina_Bool set_inverse = EINA_FALSE, reset_inverse = EINA_FALSE;
 
-   top = _csi_arg_get(ty, &b);
-   left = _csi_arg_get(ty, &b);
-   bottom = _csi_arg_get(ty, &b);
-   right = _csi_arg_get(ty, &b);
+   top = _csi_arg_get(ty, args);
+   left = _csi_arg_get(ty, args);
+   bottom = _csi_arg_get(ty, args);
+   right = _csi_arg_get(ty, args);
 
    DBG("DECCARA (%d;%d;%d;%d) Change Attributes in Rectangular Area",
        top, left, bottom, right);
@@ -1819,9 +2189,9 @@ _handle_esc_csi_deccara(Termpty *ty, Eina_Unicode **ptr,
        (right == -ESC_ARG_ERROR))
      return;
 
-   while (b && b < end)
+   while (_csi_args_more(args) && (_csi_args_ptr(args) < end))
      {
-        int arg = _csi_arg_get(ty, &b);
+        int arg = _csi_arg_get(ty, args);
         switch (arg)
           {
            case -ESC_ARG_ERROR:
@@ -1881,7 +2251,7 @@ _handle_esc_csi_deccara(Termpty *ty, Eina_Unicode **ptr,
         for (; top <= bottom; top++)
           {
              cells = &(TERMPTY_SCREEN(ty, left, top));
-             _deccara(cells, len, set_bold, reset_bold, set_underline,
+             _deccara(ty, cells, len, set_bold, reset_bold, set_underline,
                       reset_underline, set_blink, reset_blink, set_inverse,
                       reset_inverse);
           }
@@ -1898,7 +2268,7 @@ _handle_esc_csi_deccara(Termpty *ty, Eina_Unicode **ptr,
           {
              cells = &(TERMPTY_SCREEN(ty, left, top));
              len = right - left;
-             _deccara(cells, len, set_bold, reset_bold,
+             _deccara(ty, cells, len, set_bold, reset_bold,
                       set_underline, reset_underline,
                       set_blink, reset_blink,
                       set_inverse, reset_inverse);
@@ -1908,7 +2278,7 @@ _handle_esc_csi_deccara(Termpty *ty, Eina_Unicode **ptr,
              /* First line */
              cells = &(TERMPTY_SCREEN(ty, left, top));
              len = right_border - left;
-             _deccara(cells, len, set_bold, reset_bold,
+             _deccara(ty, cells, len, set_bold, reset_bold,
                       set_underline, reset_underline,
                       set_blink, reset_blink,
                       set_inverse, reset_inverse);
@@ -1918,7 +2288,7 @@ _handle_esc_csi_deccara(Termpty *ty, Eina_Unicode **ptr,
              for (top = top + 1; top < bottom; top++)
                {
                   cells = &(TERMPTY_SCREEN(ty, left_border, top));
-                  _deccara(cells, len, set_bold, reset_bold,
+                  _deccara(ty, cells, len, set_bold, reset_bold,
                            set_underline, reset_underline,
                            set_blink, reset_blink,
                            set_inverse, reset_inverse);
@@ -1927,7 +2297,7 @@ _handle_esc_csi_deccara(Termpty *ty, Eina_Unicode **ptr,
              /* Last line */
              cells = &(TERMPTY_SCREEN(ty, left_border, bottom));
              len = right - left_border;
-             _deccara(cells, len, set_bold, reset_bold,
+             _deccara(ty, cells, len, set_bold, reset_bold,
                       set_underline, reset_underline,
                       set_blink, reset_blink,
                       set_inverse, reset_inverse);
@@ -1936,7 +2306,7 @@ _handle_esc_csi_deccara(Termpty *ty, Eina_Unicode **ptr,
 }
 
 static void
-_decrara(Termcell *cells, int len,
+_decrara(Termpty *ty, Termcell *cells, int len,
          Eina_Bool reverse_bold,
          Eina_Bool reverse_underline,
          Eina_Bool reverse_blink,
@@ -1946,23 +2316,25 @@ _decrara(Termcell *cells, int len,
 
    for (i = 0; i < len; i++)
      {
-        Termatt * att = &cells[i].att;
+        Termatt att;
+
+        termpty_cell_att_get(ty, &cells[i], &att);
         if (reverse_bold)
-          att->bold = !att->bold;
+          att.bold = !att.bold;
         if (reverse_underline)
-          att->underline = !att->underline;
+          att.underline = !att.underline;
         if (reverse_blink)
-          att->blink = !att->blink;
+          att.blink = !att.blink;
         if (reverse_inverse)
-          att->inverse = !att->inverse;
+          att.inverse = !att.inverse;
+        termpty_cell_att_set(ty, &cells[i], &att);
      }
 }
 
 static void
-_handle_esc_csi_decrara(Termpty *ty, Eina_Unicode **ptr,
+_handle_esc_csi_decrara(Termpty *ty, Csi_Args *args,
                         const Eina_Unicode * const end)
 {
-   Eina_Unicode *b = *ptr;
    Termcell *cells;
    int top;
    int left;
@@ -1974,10 +2346,10 @@ _handle_esc_csi_decrara(Termpty *ty, Eina_Unicode **ptr,
    Eina_Bool reverse_blink = EINA_FALSE;
    Eina_Bool reverse_inverse = EINA_FALSE;
 
-   top = _csi_arg_get(ty, &b);
-   left = _csi_arg_get(ty, &b);
-   bottom = _csi_arg_get(ty, &b);
-   right = _csi_arg_get(ty, &b);
+   top = _csi_arg_get(ty, args);
+   left = _csi_arg_get(ty, args);
+   bottom = _csi_arg_get(ty, args);
+   right = _csi_arg_get(ty, args);
 
    DBG("DECRARA (%d;%d;%d;%d) Reverse Attributes in Rectangular Area",
        top, left, bottom, right);
@@ -1987,9 +2359,9 @@ _handle_esc_csi_decrara(Termpty *ty, Eina_Unicode **ptr,
        (right == -ESC_ARG_ERROR))
      return;
 
-   while (b && b < end)
+   while (_csi_args_more(args) && (_csi_args_ptr(args) < end))
      {
-        int arg = _csi_arg_get(ty, &b);
+        int arg = _csi_arg_get(ty, args);
         switch (arg)
           {
            case -ESC_ARG_ERROR:
@@ -2028,7 +2400,7 @@ _handle_esc_csi_decrara(Termpty *ty, Eina_Unicode **ptr,
         for (; top <= bottom; top++)
           {
              cells = &(TERMPTY_SCREEN(ty, left, top));
-             _decrara(cells, len, reverse_bold, reverse_underline,
+             _decrara(ty, cells, len, reverse_bold, reverse_underline,
                       reverse_blink, reverse_inverse);
           }
      }
@@ -2044,7 +2416,7 @@ _handle_esc_csi_decrara(Termpty *ty, Eina_Unicode **ptr,
           {
              cells = &(TERMPTY_SCREEN(ty, left, top));
              len = right - left;
-             _decrara(cells, len, reverse_bold, reverse_underline,
+             _decrara(ty, cells, len, reverse_bold, reverse_underline,
                       reverse_blink, reverse_inverse);
           }
         else
@@ -2052,7 +2424,7 @@ _handle_esc_csi_decrara(Termpty *ty, Eina_Unicode **ptr,
              /* First line */
              cells = &(TERMPTY_SCREEN(ty, left, top));
              len = right_border - left;
-             _decrara(cells, len, reverse_bold, reverse_underline,
+             _decrara(ty, cells, len, reverse_bold, reverse_underline,
                       reverse_blink, reverse_inverse);
 
              /* Middle */
@@ -2060,26 +2432,26 @@ _handle_esc_csi_decrara(Termpty *ty, Eina_Unicode **ptr,
              for (top = top + 1; top < bottom; top++)
                {
                   cells = &(TERMPTY_SCREEN(ty, left_border, top));
-                  _decrara(cells, len, reverse_bold, reverse_underline,
+                  _decrara(ty, cells, len, reverse_bold, reverse_underline,
                            reverse_blink, reverse_inverse);
                }
 
              /* Last line */
              cells = &(TERMPTY_SCREEN(ty, left_border, bottom));
              len = right - left_border;
-             _decrara(cells, len, reverse_bold, reverse_underline,
+             _decrara(ty, cells, len, reverse_bold, reverse_underline,
                       reverse_blink, reverse_inverse);
           }
      }
 }
 
 static void
-_handle_esc_csi_decera(Termpty *ty, Eina_Unicode **b)
+_handle_esc_csi_decera(Termpty *ty, Csi_Args *args)
 {
-   int top = _csi_arg_get(ty ,b);
-   int left = _csi_arg_get(ty, b);
-   int bottom = _csi_arg_get(ty, b);
-   int right = _csi_arg_get(ty, b);
+   int top = _csi_arg_get(ty, args);
+   int left = _csi_arg_get(ty, args);
+   int bottom = _csi_arg_get(ty, args);
+   int right = _csi_arg_get(ty, args);
    int len;
 
    DBG("DECERA (%d;%d;%d;%d) Erase Rectangular Area",
@@ -2103,16 +2475,16 @@ _handle_esc_csi_decera(Termpty *ty, Eina_Unicode **b)
 }
 
 static void
-_handle_esc_csi_deccra(Termpty *ty, Eina_Unicode **b)
-{
-   int top = _csi_arg_get(ty, b);
-   int left = _csi_arg_get(ty, b);
-   int bottom = _csi_arg_get(ty, b);
-   int right = _csi_arg_get(ty, b);
-   int p1 = _csi_arg_get(ty, b);
-   int to_top = _csi_arg_get(ty, b);
-   int to_left = _csi_arg_get(ty, b);
-   int p2 = _csi_arg_get(ty, b);
+_handle_esc_csi_deccra(Termpty *ty, Csi_Args *args)
+{
+   int top = _csi_arg_get(ty, args);
+   int left = _csi_arg_get(ty, args);
+   int bottom = _csi_arg_get(ty, args);
+   int right = _csi_arg_get(ty, args);
+   int p1 = _csi_arg_get(ty, args);
+   int to_top = _csi_arg_get(ty, args);
+   int to_left = _csi_arg_get(ty, args);
+   int p2 = _csi_arg_get(ty, args);
    int to_bottom = ty->h - 1;
    int to_right = ty->w;
    int len;
@@ -2228,13 +2600,13 @@ _handle_esc_csi_deccra(Termpty *ty, Eina_Unicode **b)
 }
 
 static void
-_handle_esc_csi_cursor_pos_set(Termpty *ty, Eina_Unicode **b,
+_handle_esc_csi_cursor_pos_set(Termpty *ty, Csi_Args *args,
                                const Eina_Unicode *cc)
 {
    int cx = 0, cy = 0;
    ty->cursor_state.wrapnext = 0;
-   cy = _csi_arg_get(ty, b);
-   cx = _csi_arg_get(ty, b);
+   cy = _csi_arg_get(ty, args);
+   cx = _csi_arg_get(ty, args);
 
    if ((cx == -ESC_ARG_ERROR) || (cy == -ESC_ARG_ERROR))
      return;
@@ -2270,9 +2642,9 @@ _handle_esc_csi_cursor_pos_set(Termpty *ty, Eina_Unicode **b,
 }
 
 static void
-_handle_esc_csi_decscusr(Termpty *ty, Eina_Unicode **b)
+_handle_esc_csi_decscusr(Termpty *ty, Csi_Args *args)
 {
-  int arg = _csi_arg_get(ty, b);
+  int arg = _csi_arg_get(ty, args);
   Cursor_Shape shape = CURSOR_SHAPE_BLOCK;
 
   DBG("DECSCUSR (%d) Set Cursor Shape", arg);
@@ -2306,13 +2678,17 @@ _handle_esc_csi_decscusr(Termpty *ty, Eina_Unicode **b)
         return;
     }
 
-  termio_set_cursor_shape(ty->obj, shape);
+  if (termpty_main_loop_begin(ty))
+    {
+       termio_set_cursor_shape(ty->obj, shape);
+       termpty_main_loop_end(ty);
+    }
 }
 
 static void
-_handle_esc_csi_term_version(Termpty *ty, Eina_Unicode **b)
+_handle_esc_csi_term_version(Termpty *ty, Csi_Args *args)
 {
-  int arg = _csi_arg_get(ty, b);
+  int arg = _csi_arg_get(ty, args);
 
   DBG("CSI Term version (%d)", arg);
 
@@ -2333,9 +2709,9 @@ _handle_esc_csi_term_version(Termpty *ty, Eina_Unicode **b)
 }
 
 static void
-_handle_esc_csi_decsace(Termpty *ty, Eina_Unicode **b)
+_handle_esc_csi_decsace(Termpty *ty, Csi_Args *args)
 {
-  int arg = _csi_arg_get(ty, b);
+  int arg = _csi_arg_get(ty, args);
 
   DBG("DECSACE (%d) Select Attribute Change Extent", arg);
 
@@ -2361,9 +2737,9 @@ _handle_esc_csi_decsace(Termpty *ty, Eina_Unicode **b)
 }
 
 static void
-_handle_esc_csi_decic(Termpty *ty, Eina_Unicode **b)
+_handle_esc_csi_decic(Termpty *ty, Csi_Args *args)
 {
-   int arg = _csi_arg_get(ty, b);
+   int arg = _csi_arg_get(ty, args);
    int old_insert = ty->termstate.insert;
    Eina_Unicode blank[1] = { ' ' };
    int top = 0;
@@ -2414,9 +2790,9 @@ _handle_esc_csi_decic(Termpty *ty, Eina_Unicode **b)
 }
 
 static void
-_handle_esc_csi_decdc(Termpty *ty, Eina_Unicode **b)
+_handle_esc_csi_decdc(Termpty *ty, Csi_Args *args)
 {
-   int arg = _csi_arg_get(ty, b);
+   int arg = _csi_arg_get(ty, args);
    int y = 0;
    int max_y = ty->h;
    int max_x = ty->w;
@@ -2464,24 +2840,16 @@ _handle_esc_csi_decdc(Termpty *ty, Eina_Unicode **b)
              if (x < lim)
                TERMPTY_CELL_COPY(ty, &(cells[x + arg]), &(cells[x]), 1);
              else
-               {
-                  cells[x].codepoint = ' ';
-                  if (EINA_UNLIKELY(cells[x].att.link_id))
-                    term_link_refcount_dec(ty, cells[x].att.link_id, 1);
-                  cells[x].att = ty->termstate.att;
-                  cells[x].att.link_id = 0;
-                  cells[x].att.dblwidth = 0;
-               }
+               _cell_blank(ty, &cells[x]);
           }
      }
 }
 
 static void
-_handle_esc_csi_ich(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_ich(Termpty *ty, Csi_Args *args)
 {
    Eina_Unicode blank[1] = { ' ' };
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
    int i;
    int old_insert = ty->termstate.insert;
    int old_cx = ty->cursor_state.cx;
@@ -2524,10 +2892,9 @@ _handle_esc_csi_ich(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_cuu(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_cuu(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -2545,11 +2912,10 @@ _handle_esc_csi_cuu(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_cud_or_vpr(Termpty *ty, Eina_Unicode **ptr,
+_handle_esc_csi_cud_or_vpr(Termpty *ty, Csi_Args *args,
                            const Eina_Unicode *cc)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -2577,10 +2943,9 @@ _handle_esc_csi_cud_or_vpr(Termpty *ty, Eina_Unicode **ptr,
 }
 
 static void
-_handle_esc_csi_cuf(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_cuf(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -2598,10 +2963,9 @@ _handle_esc_csi_cuf(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_cub(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_cub(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -2619,11 +2983,10 @@ _handle_esc_csi_cub(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_cha(Termpty *ty, Eina_Unicode **ptr,
+_handle_esc_csi_cha(Termpty *ty, Csi_Args *args,
                     const Eina_Unicode *cc)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
    int min = 0;
    int max = ty->w;
 
@@ -2656,10 +3019,9 @@ _handle_esc_csi_cha(Termpty *ty, Eina_Unicode **ptr,
 }
 
 static void
-_handle_esc_csi_cht(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_cht(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -2669,10 +3031,9 @@ _handle_esc_csi_cht(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_ed(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_ed(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -2702,17 +3063,16 @@ _handle_esc_csi_ed(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_decsed(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_decsed(Termpty *ty, Csi_Args *args)
 {
    WRN("DECSED - Selective Erase in Display: Unsupported");
-   _handle_esc_csi_ed(ty, ptr);
+   _handle_esc_csi_ed(ty, args);
 }
 
 static void
-_handle_esc_csi_el(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_el(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -2733,17 +3093,16 @@ _handle_esc_csi_el(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_decsel(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_decsel(Termpty *ty, Csi_Args *args)
 {
    WRN("DECSEL - Selective Erase in Line: Unsupported");
-   _handle_esc_csi_el(ty, ptr);
+   _handle_esc_csi_el(ty, args);
 }
 
 static void
-_handle_esc_csi_il(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_il(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
    int sy1, sy2, i;
 
    if (arg == -ESC_ARG_ERROR)
@@ -2778,10 +3137,9 @@ _handle_esc_csi_il(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_dl(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_dl(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
    int sy1, sy2, i;
 
    if (arg == -ESC_ARG_ERROR)
@@ -2816,10 +3174,9 @@ _handle_esc_csi_dl(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_su(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_su(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
    int i;
 
    if (arg == -ESC_ARG_ERROR)
@@ -2832,10 +3189,9 @@ _handle_esc_csi_su(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_sd(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_sd(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
    int i;
 
    if (arg == -ESC_ARG_ERROR)
@@ -2854,7 +3210,7 @@ _handle_esc_csi_sd(Termpty *ty, Eina_Unicode **ptr)
 
 static void
 _handle_xterm_unset_title_modes(Termpty *ty EINA_UNUSED,
-                                Eina_Unicode **ptr EINA_UNUSED,
+                                Csi_Args *args EINA_UNUSED,
                                 const Eina_Unicode * const end EINA_UNUSED)
 {
    DBG("Unset Title Modes: TODO");
@@ -2862,16 +3218,15 @@ _handle_xterm_unset_title_modes(Termpty *ty EINA_UNUSED,
 
 static void
 _handle_sixel_regis_graphics_attributes(Termpty *ty EINA_UNUSED,
-                                        Eina_Unicode **ptr EINA_UNUSED)
+                                        Csi_Args *args EINA_UNUSED)
 {
    DBG("Sixel/ReGIS Graphics Attributes: TODO");
 }
 
 static void
-_handle_esc_csi_decst8c(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_decst8c(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
    int i;
 
    if (arg == -ESC_ARG_ERROR)
@@ -2892,10 +3247,9 @@ _handle_esc_csi_decst8c(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_ctc(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_ctc(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -2923,10 +3277,9 @@ _handle_esc_csi_ctc(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_tbc(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_tbc(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -2952,10 +3305,9 @@ _handle_esc_csi_tbc(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_ech(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_ech(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -2965,11 +3317,10 @@ _handle_esc_csi_ech(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_cbt(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_cbt(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
    int cx = ty->cursor_state.cx;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -2990,10 +3341,9 @@ _handle_esc_csi_cbt(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_rep(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_rep(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -3023,19 +3373,14 @@ _handle_esc_csi_rep(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_da(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_da(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
    char bf[32];
-   char start = 'X';
+   char start = args->buf[0];
    int arg;
    int len;
 
-   if (b)
-     {
-        start = *b;
-     }
-   arg = _csi_arg_get(ty, &b);
+   arg = _csi_arg_get(ty, args);
 
    if ((arg == -ESC_ARG_ERROR) || (arg > 0))
      return;
@@ -3094,10 +3439,9 @@ _handle_esc_csi_da(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_uts(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_uts(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -3107,10 +3451,9 @@ _handle_esc_csi_uts(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_vpa(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_vpa(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
    int max = ty->h + 1;
 
    if (arg == -ESC_ARG_ERROR)
@@ -3126,10 +3469,9 @@ _handle_esc_csi_vpa(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_esc_csi_decswbv(Termpty *ty, Eina_Unicode **ptr)
+_handle_esc_csi_decswbv(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -3152,13 +3494,12 @@ _handle_esc_csi_decswbv(Termpty *ty, Eina_Unicode **ptr)
 }
 
 static void
-_handle_resize_by_chars(Termpty *ty, Eina_Unicode **ptr)
+_handle_resize_by_chars(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
    int w, h;
 
-   h = _csi_arg_get(ty, &b);
-   w = _csi_arg_get(ty, &b);
+   h = _csi_arg_get(ty, args);
+   w = _csi_arg_get(ty, args);
 
    if ((w == -ESC_ARG_ERROR) || (h == -ESC_ARG_ERROR))
      return;
@@ -3183,12 +3524,16 @@ _handle_resize_by_chars(Termpty *ty, Eina_Unicode **ptr)
         Evas_Object *wn;
         int step_w = 0, step_h = 0, base_w = 0, base_h = 0;
 
-        wn = termio_win_get(ty->obj);
-        elm_win_size_base_get(wn, &base_w, &base_h);
-        elm_win_size_step_get(wn, &step_w, &step_h);
-        evas_object_resize(wn,
-                           base_w + step_w * w,
-                           base_h + step_h * h);
+        if (termpty_main_loop_begin(ty))
+          {
+             wn = termio_win_get(ty->obj);
+             elm_win_size_base_get(wn, &base_w, &base_h);
+             elm_win_size_step_get(wn, &step_w, &step_h);
+             evas_object_resize(wn,
+                                base_w + step_w * w,
+                                base_h + step_h * h);
+             termpty_main_loop_end(ty);
+          }
 #else
         tytest_termio_resize(w, h);
 #endif
@@ -3204,9 +3549,9 @@ struct tag_TitleIconElem {
 };
 
 static void
-_title_icon_stack_push(Termpty *ty, Eina_Unicode **p)
+_title_icon_stack_push(Termpty *ty, Csi_Args *args)
 {
-   int arg = _csi_arg_get(ty, p);
+   int arg = _csi_arg_get(ty, args);
    TitleIconElem *elem = calloc(1, sizeof(*elem));
 
    if (!elem)
@@ -3246,9 +3591,9 @@ _title_icon_stack_push(Termpty *ty, Eina_Unicode **p)
 }
 
 static void
-_title_icon_stack_pop(Termpty *ty, Eina_Unicode **p)
+_title_icon_stack_pop(Termpty *ty, Csi_Args *args)
 {
-   int arg = _csi_arg_get(ty, p);
+   int arg = _csi_arg_get(ty, args);
    TitleIconElem *elem = ty->title_icon_stack;
 
    if (!elem)
@@ -3263,24 +3608,19 @@ _title_icon_stack_pop(Termpty *ty, Eina_Unicode **p)
       case 0:
          eina_stringshare_del(ty->prop.icon);
          ty->prop.icon = eina_stringshare_ref(elem->icon);
-         if (ty->cb.set_icon.func)
-           ty->cb.set_icon.func(ty->cb.set_icon.data);
          eina_stringshare_del(ty->prop.title);
          ty->prop.title = eina_stringshare_ref(elem->title);
-         if (ty->cb.set_title.func)
-           ty->cb.set_title.func(ty->cb.set_title.data);
+         termpty_defer(ty, TERMPTY_DEFER_ICON | TERMPTY_DEFER_TITLE);
          break;
       case 1:
          eina_stringshare_del(ty->prop.icon);
          ty->prop.icon = eina_stringshare_ref(elem->icon);
-         if (ty->cb.set_icon.func)
-           ty->cb.set_icon.func(ty->cb.set_icon.data);
+         termpty_defer(ty, TERMPTY_DEFER_ICON);
          break;
       case 2:
          eina_stringshare_del(ty->prop.title);
          ty->prop.title = eina_stringshare_ref(elem->title);
-         if (ty->cb.set_title.func)
-           ty->cb.set_title.func(ty->cb.set_title.data);
+         termpty_defer(ty, TERMPTY_DEFER_TITLE);
          break;
       default:
          break;
@@ -3292,10 +3632,9 @@ _title_icon_stack_pop(Termpty *ty, Eina_Unicode **p)
 }
 
 static void
-_handle_window_manipulation(Termpty *ty, Eina_Unicode **ptr)
+_handle_window_manipulation(Termpty *ty, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
-   int arg = _csi_arg_get(ty, &b);
+   int arg = _csi_arg_get(ty, args);
 
    if (arg == -ESC_ARG_ERROR)
      return;
@@ -3303,13 +3642,13 @@ _handle_window_manipulation(Termpty *ty, Eina_Unicode **ptr)
    switch (arg)
      {
       case 8:
-         _handle_resize_by_chars(ty, &b);
+         _handle_resize_by_chars(ty, args);
          break;
       case 22:
-        _title_icon_stack_push(ty, &b);
+        _title_icon_stack_push(ty, args);
         break;
       case 23:
-        _title_icon_stack_pop(ty, &b);
+        _title_icon_stack_pop(ty, args);
         break;
       default:
         // many others
@@ -3322,12 +3661,10 @@ _handle_window_manipulation(Termpty *ty, Eina_Unicode **ptr)
 
 static void
 _handle_xmodkeys(Termpty *ty,
-                 Eina_Unicode cmd, Eina_Unicode **ptr)
+                 Eina_Unicode cmd, Csi_Args *args)
 {
-   Eina_Unicode *b = *ptr;
    Eina_Bool set = (cmd == 'm');
-   Eina_Unicode param = *b;
-   b++;
+   Eina_Unicode param = args->buf[0];
    if (param == '?')
      return; // Not actually supported by xterm
    if (param != '>')
@@ -3338,8 +3675,8 @@ _handle_xmodkeys(Termpty *ty,
      }
    if (set)
      {
-        int arg1 = _csi_arg_get(ty, &b);
-        int arg2 = _csi_arg_get(ty, &b);
+        int arg1 = _csi_arg_get(ty, args);
+        int arg2 = _csi_arg_get(ty, args);
         int v, mod;
         if (arg1 == -ESC_ARG_ERROR)
           {
@@ -3380,7 +3717,7 @@ _handle_xmodkeys(Termpty *ty,
      }
    else
      { /* reset */
-        int arg = _csi_arg_get(ty, &b);
+        int arg = _csi_arg_get(ty, args);
         switch (arg)
           {
            case XMOD_KEYBOARD:
@@ -3407,14 +3744,16 @@ static int
 _handle_esc_csi(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
 {
    const Eina_Unicode *cc, *be;
-   Eina_Unicode buf[4096], *b;
+   Eina_Unicode buf[SEQ_BUF_MAX], *b;
+   Csi_Args args;
 
    cc = (Eina_Unicode *)c;
    b = buf;
    be = buf + sizeof(buf) / sizeof(buf[0]);
    while ((cc < ce) && (*cc <= '?') && (b < be))
      {
-        _handle_cursor_control(ty, cc);
+        if (*cc < ' ')
+          _handle_cursor_control(ty, cc);
         *b = *cc;
         b++;
         cc++;
@@ -3428,144 +3767,147 @@ _handle_esc_csi(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
    *b = 0;
    be = b;
    b = buf;
+   _csi_args_init(&args, buf);
    DBG(" CSI: '%s' args '%s'", termptyesc_safechar(*cc), (char *) buf);
    switch (*cc)
      {
         /* sorted by ascii value */
       case '@':
          /* TODO: SL */
-         _handle_esc_csi_ich(ty, &b);
+         _handle_esc_csi_ich(ty, &args);
         break;
       case 'A':
         /* TODO: SR */
-         _handle_esc_csi_cuu(ty, &b);
+         _handle_esc_csi_cuu(ty, &args);
         break;
       case 'B':
-        _handle_esc_csi_cud_or_vpr(ty, &b, cc);
+        _handle_esc_csi_cud_or_vpr(ty, &args, cc);
         break;
       case 'C':
-        _handle_esc_csi_cuf(ty, &b);
+        _handle_esc_csi_cuf(ty, &args);
         break;
       case 'D':
-        _handle_esc_csi_cub(ty, &b);
+        _handle_esc_csi_cub(ty, &args);
         break;
       case 'E':
-        _handle_esc_csi_cnl(ty, &b);
+        _handle_esc_csi_cnl(ty, &args);
         break;
       case 'F':
-        _handle_esc_csi_cpl(ty, &b);
+        _handle_esc_csi_cpl(ty, &args);
         break;
       case 'G':
-        _handle_esc_csi_cha(ty, &b, cc);
+        _handle_esc_csi_cha(ty, &args, cc);
         break;
       case 'H':
-        _handle_esc_csi_cursor_pos_set(ty, &b, cc);
+        _handle_esc_csi_cursor_pos_set(ty, &args, cc);
         break;
       case 'I':
-        _handle_esc_csi_cht(ty, &b);
+        _handle_esc_csi_cht(ty, &args);
         break;
       case 'J':
         if (*b == '?')
-          _handle_esc_csi_decsed(ty, &b);
+          _handle_esc_csi_decsed(ty, &args);
         else
-          _handle_esc_csi_ed(ty, &b);
+          _handle_esc_csi_ed(ty, &args);
         break;
       case 'K':
         if (*b == '?')
-          _handle_esc_csi_decsel(ty, &b);
+          _handle_esc_csi_decsel(ty, &args);
         else
-          _handle_esc_csi_el(ty, &b);
+          _handle_esc_csi_el(ty, &args);
         break;
       case 'L':
-        _handle_esc_csi_il(ty, &b);
+        _handle_esc_csi_il(ty, &args);
         break;
       case 'M':
-        _handle_esc_csi_dl(ty, &b);
+        _handle_esc_csi_dl(ty, &args);
         break;
       case 'P':
-        _handle_esc_csi_dch(ty, &b);
+        _handle_esc_csi_dch(ty, &args);
         break;
       case 'S':
         if (*b == '?')
-          _handle_sixel_regis_graphics_attributes(ty, &b);
+          _handle_sixel_regis_graphics_attributes(ty, &args);
         else
-          _handle_esc_csi_su(ty, &b);
+          _handle_esc_csi_su(ty, &args);
         break;
       case 'T':
         if (*b == '?')
-          _handle_xterm_unset_title_modes(ty, &b, be);
+          _handle_xterm_unset_title_modes(ty, &args, be);
         else
-          _handle_esc_csi_sd(ty, &b);
+          _handle_esc_csi_sd(ty, &args);
         break;
       case 'W':
         if (*b == '?')
-          _handle_esc_csi_decst8c(ty, &b);
+          _handle_esc_csi_decst8c(ty, &args);
         else
-          _handle_esc_csi_ctc(ty, &b);
+          _handle_esc_csi_ctc(ty, &args);
         break;
       case 'X':
-        _handle_esc_csi_ech(ty, &b);
+        _handle_esc_csi_ech(ty, &args);
         break;
       case 'Z':
-        _handle_esc_csi_cbt(ty, &b);
+        _handle_esc_csi_cbt(ty, &args);
         break;
       case '`':
-        _handle_esc_csi_cha(ty, &b, cc);
+        _handle_esc_csi_cha(ty, &args, cc);
         break;
       case 'a':
-        _handle_esc_csi_cuf(ty, &b);
+        _handle_esc_csi_cuf(ty, &args);
         break;
       case 'b':
-        _handle_esc_csi_rep(ty, &b);
+        _handle_esc_csi_rep(ty, &args);
         break;
       case 'c':
-        _handle_esc_csi_da(ty, &b);
+        _handle_esc_csi_da(ty, &args);
         break;
       case 'd':
         if (*(cc-1) == ' ')
-          _handle_esc_csi_uts(ty, &b);
+          _handle_esc_csi_uts(ty, &args);
         else
-          _handle_esc_csi_vpa(ty, &b);
+          _handle_esc_csi_vpa(ty, &args);
         break;
       case 'e':
-        _handle_esc_csi_cud_or_vpr(ty, &b, cc);
+        _handle_esc_csi_cud_or_vpr(ty, &args, cc);
         break;
       case 'f':
-        _handle_esc_csi_cursor_pos_set(ty, &b, cc);
+        _handle_esc_csi_cursor_pos_set(ty, &args, cc);
        break;
       case 'g':
-        _handle_esc_csi_tbc(ty, &b);
+        _handle_esc_csi_tbc(ty, &args);
         break;
       case 'h':
-        _handle_esc_csi_reset_mode(ty, *cc, b, be);
+        _handle_esc_csi_reset_mode(ty, *cc, &args);
         break;
       case 'i':
         WRN("TODO: Media Copy (?:%s)", (*b == '?') ? "yes": "no");
         ty->decoding_error = EINA_TRUE;
         break;
       case 'j':
-        _handle_esc_csi_cub(ty, &b);
+        _handle_esc_csi_cub(ty, &args);
         break;
       case 'k':
-        _handle_esc_csi_cuu(ty, &b);
+        _handle_esc_csi_cuu(ty, &args);
         break;
       case 'l':
-        _handle_esc_csi_reset_mode(ty, *cc, b, be);
+        _handle_esc_csi_reset_mode(ty, *cc, &args);
         break;
       case 'm': // color set
         if (b && (*b == '>' || *b == '?'))
-          _handle_xmodkeys(ty, *cc, &b);
+          _handle_xmodkeys(ty, *cc, &args);
         else
-          _handle_esc_csi_color_set(ty, &b, be);
+          _handle_esc_csi_sgr(ty, &args, be - buf);
         break;
       case 'n':
         if (*b == '>')
-          _handle_xmodkeys(ty, *cc, &b);
+          _handle_xmodkeys(ty, *cc, &args);
         else
-          _handle_esc_csi_dsr(ty, b);
+          _handle_esc_csi_dsr(ty, &args);
         break;
       case 'p': // define key assignments based on keycode
-        if (b && *b == '!')
+        if (*(cc-1) == '$')
+          _handle_esc_csi_decrqm(ty, &args);
+        else if (b && *b == '!')
           {
              DBG("soft reset (DECSTR)");
              termpty_soft_reset_state(ty);
@@ -3577,7 +3919,7 @@ _handle_esc_csi(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
         break;
       case 'q':
         if (*(cc-1) == ' ')
-          _handle_esc_csi_decscusr(ty, &b);
+          _handle_esc_csi_decscusr(ty, &args);
         else if (*(cc-1) == '"')
           {
              WRN("TODO: select character protection attribute (DECSCA)");
@@ -3586,7 +3928,7 @@ _handle_esc_csi(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
         else
           {
              if (*b == '>')
-               _handle_esc_csi_term_version(ty, &b);
+               _handle_esc_csi_term_version(ty, &args);
              else
                {
                   WRN("TODO: Load LEDs (DECLL)");
@@ -3596,14 +3938,14 @@ _handle_esc_csi(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
         break;
       case 'r':
         if (*(cc-1) == '$')
-          _handle_esc_csi_deccara(ty, &b, be-1);
+          _handle_esc_csi_deccara(ty, &args, be-1);
         else
-          _handle_esc_csi_decstbm(ty, &b);
+          _handle_esc_csi_decstbm(ty, &args);
         break;
       case 's':
         if (ty->termstate.lr_margins)
           {
-            _handle_esc_csi_decslrm(ty, &b);
+            _handle_esc_csi_decslrm(ty, &args);
           }
         else
           {
@@ -3613,14 +3955,14 @@ _handle_esc_csi(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
         break;
       case 't':
         if (*(cc-1) == '$')
-          _handle_esc_csi_decrara(ty, &b, be-1);
+          _handle_esc_csi_decrara(ty, &args, be-1);
         else if (*(cc-1) == ' ')
           {
-             _handle_esc_csi_decswbv(ty, &b);
+             _handle_esc_csi_decswbv(ty, &args);
           }
         else
           {
-             _handle_window_manipulation(ty, &b);
+             _handle_window_manipulation(ty, &args);
           }
         break;
       case 'u':
@@ -3637,7 +3979,7 @@ _handle_esc_csi(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
         break;
       case 'v':
         if (*(cc-1) == '$')
-          _handle_esc_csi_deccra(ty, &b);
+          _handle_esc_csi_deccra(ty, &args);
         else
           {
              ERR("unhandled 'v' CSI escape code");
@@ -3646,9 +3988,9 @@ _handle_esc_csi(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
         break;
       case 'x':
         if (*(cc-1) == '$')
-          _handle_esc_csi_decfra(ty, &b);
+          _handle_esc_csi_decfra(ty, &args);
         else if (*(cc-1) == '*')
-          _handle_esc_csi_decsace(ty, &b);
+          _handle_esc_csi_decsace(ty, &args);
         else
           {
              ERR("unhandled 'x' CSI escape code");
@@ -3657,7 +3999,7 @@ _handle_esc_csi(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
         break;
       case 'z':
         if (*(cc-1) == '$')
-          _handle_esc_csi_decera(ty, &b);
+          _handle_esc_csi_decera(ty, &args);
         else
           {
              ERR("unhandled 'z' CSI escape code");
@@ -3666,7 +4008,7 @@ _handle_esc_csi(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
         break;
       case '}':
         if (*(cc-1) == '\'')
-          _handle_esc_csi_decic(ty, &b);
+          _handle_esc_csi_decic(ty, &args);
         else
           {
              ERR("unhandled '}' CSI escape code");
@@ -3675,7 +4017,7 @@ _handle_esc_csi(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
         break;
       case '~':
         if (*(cc-1) == '\'')
-          _handle_esc_csi_decdc(ty, &b);
+          _handle_esc_csi_decdc(ty, &args);
         else
           {
              ERR("unhandled '~' CSI escape code");
@@ -4180,8 +4522,12 @@ _handle_xterm_50_command(Termpty *ty,
             s += pattern_len;
             errno = 0;
             size = strtol(s, &endptr, 10);
-            if (endptr != s && errno == 0)
-               termio_font_size_set(ty->obj, size);
+            if ((endptr != s) && (errno == 0) &&
+                (termpty_main_loop_begin(ty)))
+              {
+                 termio_font_size_set(ty->obj, size);
+                 termpty_main_loop_end(ty);
+              }
          }
        len--;
        s++;
@@ -4204,11 +4550,6 @@ _handle_xterm_777_command(Termpty *ty,
         return;
      }
 
-   if (!elm_need_sys_notify())
-     {
-        WRN("no elementary system notification support");
-        return;
-     }
    cmd_end = s + strlen("notify");
    if (*cmd_end != ';')
      return;
@@ -4223,9 +4564,16 @@ _handle_xterm_777_command(Termpty *ty,
    *title_end = '\0';
    message = title_end + 1;
 
-   elm_sys_notify_send(0, "dialog-information", title, message,
-                       ELM_SYS_NOTIFY_URGENCY_NORMAL, -1,
-                       NULL, NULL);
+   if (termpty_main_loop_begin(ty))
+     {
+        if (elm_need_sys_notify())
+          elm_sys_notify_send(0, "dialog-information", title, message,
+                              ELM_SYS_NOTIFY_URGENCY_NORMAL, -1,
+                              NULL, NULL);
+        else
+          WRN("no elementary system notification support");
+        termpty_main_loop_end(ty);
+     }
    *cmd_end = ';';
    *title_end = ';';
 }
@@ -4247,15 +4595,17 @@ _handle_xterm_10_command(Termpty *ty, Eina_Unicode *p, int len)
      {
         int r, g, b;
 #if !defined(BINARY_TYFUZZ) && !defined(BINARY_TYTEST)
+        if (!termpty_main_loop_begin(ty))
+          return;
         evas_object_textgrid_palette_get(
            termio_textgrid_get(ty->obj),
            EVAS_TEXTGRID_PALETTE_STANDARD, 0,
            &r, &g, &b, NULL);
+        termpty_main_loop_end(ty);
 #else
-        Config *config = termio_config_get(ty->obj);
-        r = config->colors[0].r;
-        g = config->colors[0].g;
-        b = config->colors[0].b;
+        r = ty->config->colors[0].r;
+        g = ty->config->colors[0].g;
+        b = ty->config->colors[0].b;
 #endif
         _write_xterm_color_response(ty, 10, r, g, b);
      }
@@ -4265,10 +4615,14 @@ _handle_xterm_10_command(Termpty *ty, Eina_Unicode *p, int len)
         if (_xterm_parse_color(ty, &p, &r, &g, &b, len) < 0)
           goto err;
 #if !defined(BINARY_TYFUZZ) && !defined(BINARY_TYTEST)
-        evas_object_textgrid_palette_set(
-           termio_textgrid_get(ty->obj),
-           EVAS_TEXTGRID_PALETTE_STANDARD, 0,
-           r, g, b, 0xff);
+        if (termpty_main_loop_begin(ty))
+          {
+             evas_object_textgrid_palette_set(
+                termio_textgrid_get(ty->obj),
+                EVAS_TEXTGRID_PALETTE_STANDARD, 0,
+                r, g, b, 0xff);
+             termpty_main_loop_end(ty);
+          }
 #endif
      }
    return;
@@ -4320,6 +4674,99 @@ err:
    ty->decoding_error = EINA_TRUE;
 }
 
+/* Longest OSC or DCS string, at least SEQ_BUF_MAX */
+static size_t
+_esc_string_max(const Termpty *ty)
+{
+   int max = ty->config ? ty->config->esc_string_max : 0;
+
+   if (max <= 0)
+     max = CONFIG_ESC_STRING_MAX_DEFAULT;
+   if (max < SEQ_BUF_MAX)
+     max = SEQ_BUF_MAX;
+   return max;
+}
+
+/* Room for an OSC or DCS string of len codepoints and a terminating nul */
+static Eina_Unicode *
+_esc_string_buf(Termpty *ty, size_t len)
+{
+   if (len + 1 > ty->esc_str.size)
+     {
+        size_t size = ty->esc_str.size * 2;
+        Eina_Unicode *buf;
+
+        if (size < len + 1)
+          size = len + 1;
+        buf = realloc(ty->esc_str.buf, size * sizeof(Eina_Unicode));
+        if (!buf)
+          {
+             ERR(_("memerr: %s"), strerror(errno));
+             return NULL;
+          }
+        ty->esc_str.buf = buf;
+        ty->esc_str.size = size;
+     }
+   return ty->esc_str.buf;
+}
+
+/* Release the string buffer if a long string made it grow */
+void
+termpty_esc_strings_trim(Termpty *ty)
+{
+   if (ty->esc_str.size <= SEQ_BUF_MAX + 1)
+     return;
+   free(ty->esc_str.buf);
+   ty->esc_str.buf = NULL;
+   ty->esc_str.size = 0;
+}
+
+/* OSC 52 payloads can be large: they are decoded while being received,
+ * see termpty_seq_ready() */
+static void
+_osc52_stream_begin(Termpty *ty)
+{
+   ty->osc52.active = EINA_TRUE;
+   ty->osc52.len = 0;
+   ty_base64_decoder_init(&ty->osc52.dec);
+   ty->osc52.data = NULL;
+   if ((ty->config) && (ty->config->selection_escapes))
+     ty->osc52.data = eina_binbuf_new();
+}
+
+static void
+_osc52_stream_feed(Termpty *ty, const Eina_Unicode *c, size_t len)
+{
+   ty->osc52.len += len;
+   if (!ty->osc52.data)
+     return;
+   if (ty->osc52.len > _esc_string_max(ty))
+     {
+        ERR("OSC 52 payload too large, dropping it");
+        ty->decoding_error = EINA_TRUE;
+        eina_binbuf_free(ty->osc52.data);
+        ty->osc52.data = NULL;
+        return;
+     }
+   if (!ty_eina_unicode_base64_decode_chunk(&ty->osc52.dec, c, len,
+                                            ty->osc52.data))
+     {
+        eina_binbuf_free(ty->osc52.data);
+        ty->osc52.data = NULL;
+     }
+}
+
+static void
+_osc52_stream_end(Termpty *ty)
+{
+   if (!ty->osc52.active)
+     return;
+   if (ty->osc52.data)
+     eina_binbuf_free(ty->osc52.data);
+   ty->osc52.data = NULL;
+   ty->osc52.active = EINA_FALSE;
+}
+
 static Elm_Sel_Type
 _elm_sel_type_from_osc52(Eina_Unicode c)
 {
@@ -4412,6 +4859,8 @@ _handle_osc_selection(Termpty *ty, Eina_Unicode *p, int len)
 
         cb.ty = ty;
         cb.has_data = EINA_FALSE;
+        if (!termpty_main_loop_begin(ty))
+          return;
         c = p;
         while (!cb.has_data && *c != ';')
           {
@@ -4427,19 +4876,23 @@ _handle_osc_selection(Termpty *ty, Eina_Unicode *p, int len)
              termio_selection_buffer_get_cb(ty->obj, cb.sel, ELM_SEL_FORMAT_TEXT,
                                    _osc52_report_cb, &cb);
           }
+        termpty_main_loop_end(ty);
      }
    else
      {
         /* Set */
         sel_type = _elm_sel_type_from_osc52(*p);
-        /* Decode base64 from the request */
-        p[len] = '\0';
-        char *out = ty_eina_unicode_base64_decode(c);
-
-        if (out)
+        /* Decode base64 from the request, what came with the previous
+         * reads is already decoded */
+        if (!ty->osc52.active)
+          _osc52_stream_begin(ty);
+        _osc52_stream_feed(ty, c, eina_unicode_strlen(c));
+        if ((ty->osc52.data) && (ty_base64_decoder_end(&ty->osc52.dec)) &&
+            (termpty_main_loop_begin(ty)))
           {
-             termio_set_selection_text(ty->obj, sel_type, out);
-             free(out);
+             termio_set_selection_text(ty->obj, sel_type,
+                (const char *)eina_binbuf_string_get(ty->osc52.data));
+             termpty_main_loop_end(ty);
           }
      }
    return;
@@ -4448,41 +4901,38 @@ err:
 }
 
 static int
-_handle_esc_osc(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
+_handle_esc_osc_string(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
 {
-   const Eina_Unicode *cc, *be;
-   Eina_Unicode buf[4096], *p;
+   const Eina_Unicode *cc;
+   Eina_Unicode *buf, *p;
+   size_t n = 0, max = _esc_string_max(ty);
    char *s;
    int len = 0;
    int arg;
 
-   cc = c;
-   p = buf;
-   be = buf + sizeof(buf) / sizeof(buf[0]);
-   while ((cc < ce) && (*cc != ST) && (*cc != BEL) && (p < be))
+   for (cc = c; (cc < ce) && (*cc != ST) && (*cc != BEL) && (n < max);
+        cc++, n++)
      {
-        if ((cc < ce - 1) &&
-            (((*cc == ESC) && (*(cc + 1) == '\\')) ||
-             (*cc == ST)))
+        if ((cc < ce - 1) && (*cc == ESC) && (*(cc + 1) == '\\'))
           {
              cc++;
              break;
           }
-        *p = *cc;
-        p++;
-        cc++;
      }
-   if (p == be)
+   if (n == max)
      {
         ERR("OSC parsing overflowed, skipping the whole buffer (binary data?)");
         return cc - c;
      }
-   *p = '\0';
-   p = buf;
-   if ((*cc == ST) || (*cc == BEL) || (*cc == '\\'))
-     cc++;
-   else
+   if ((*cc != ST) && (*cc != BEL) && (*cc != '\\'))
      return 0;
+   buf = _esc_string_buf(ty, n);
+   if (!buf)
+     return cc + 1 - c;
+   memcpy(buf, c, n * sizeof(Eina_Unicode));
+   buf[n] = '\0';
+   p = buf;
+   cc++;
 
    arg = _osc_arg_get(ty, &p);
    switch (arg)
@@ -4509,10 +4959,7 @@ _handle_esc_osc(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
              ty->prop.title = NULL;
              ty->prop.icon = NULL;
           }
-        if (ty->cb.set_title.func)
-          ty->cb.set_title.func(ty->cb.set_title.data);
-        if (ty->cb.set_icon.func)
-          ty->cb.set_icon.func(ty->cb.set_icon.data);
+        termpty_defer(ty, TERMPTY_DEFER_TITLE | TERMPTY_DEFER_ICON);
         break;
       case 1:
         // icon name
@@ -4529,7 +4976,7 @@ _handle_esc_osc(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
           {
              ty->prop.icon = NULL;
           }
-        if (ty->cb.set_icon.func) ty->cb.set_icon.func(ty->cb.set_icon.data);
+        termpty_defer(ty, TERMPTY_DEFER_ICON);
         break;
       case 2:
         // Title
@@ -4546,7 +4993,7 @@ _handle_esc_osc(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
           {
              ty->prop.title = NULL;
           }
-        if (ty->cb.set_title.func) ty->cb.set_title.func(ty->cb.set_title.data);
+        termpty_defer(ty, TERMPTY_DEFER_TITLE);
         break;
       case 4:
         if (!p || !*p)
@@ -4570,15 +5017,23 @@ _handle_esc_osc(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
         break;
       case 11:
         DBG("Set background color");
-        _handle_xterm_set_color_class(ty, p, cc - c - (p - buf),
-                                      termio_bg_get(ty->obj),
-                                      "BG", 11);
+        if (termpty_main_loop_begin(ty))
+          {
+             _handle_xterm_set_color_class(ty, p, cc - c - (p - buf),
+                                           termio_bg_get(ty->obj),
+                                           "BG", 11);
+             termpty_main_loop_end(ty);
+          }
         break;
       case 12:
         DBG("Set cursor color");
-        _handle_xterm_set_color_class(ty, p, cc - c - (p - buf),
-                                      termio_get_cursor(ty->obj),
-                                      "CURSOR", 12);
+        if (termpty_main_loop_begin(ty))
+          {
+             _handle_xterm_set_color_class(ty, p, cc - c - (p - buf),
+                                           termio_get_cursor(ty->obj),
+                                           "CURSOR", 12);
+             termpty_main_loop_end(ty);
+          }
         break;
       case 50:
         DBG("xterm font support");
@@ -4651,6 +5106,16 @@ err:
     return cc - c;
 }
 
+static int
+_handle_esc_osc(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
+{
+   int len = _handle_esc_osc_string(ty, c, ce);
+
+   if (len > 0)
+     _osc52_stream_end(ty);
+   return len;
+}
+
 static int
 _handle_esc_terminology(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
 {
@@ -4658,12 +5123,6 @@ _handle_esc_terminology(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *
    const Eina_Unicode *buf;
    char *cmd;
    size_t blen = 0;
-   Config *config;
-
-   if (!ty->buf_have_zero)
-     return 0;
-
-   config = termio_config_get(ty->obj);
 
    cc = (Eina_Unicode *)c;
    if ((cc < ce) && (*cc == 0x0))
@@ -4683,10 +5142,15 @@ _handle_esc_terminology(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *
    // commands are stored in the buffer, 0 bytes not allowed (end marker)
    cmd = eina_unicode_unicode_to_utf8(buf, NULL);
    ty->cur_cmd = cmd;
-   if ((!config->ty_escapes) || (!termpty_ext_handle(ty, buf, blen)))
+   /* the commands go to the user interface */
+   if (termpty_main_loop_begin(ty))
      {
-        if (ty->cb.command.func)
-          ty->cb.command.func(ty->cb.command.data);
+        if ((!ty->config->ty_escapes) || (!termpty_ext_handle(ty, buf, blen)))
+          {
+             if (ty->cb.command.func)
+               ty->cb.command.func(ty->cb.command.data);
+          }
+        termpty_main_loop_end(ty);
      }
    ty->cur_cmd = NULL;
    free(cmd);
@@ -4701,36 +5165,33 @@ _handle_esc_dcs(Termpty *ty,
                 const Eina_Unicode *c,
                 const Eina_Unicode *ce)
 {
-   const Eina_Unicode *cc, *be;
-   Eina_Unicode buf[4096], *b;
+   const Eina_Unicode *cc;
+   Eina_Unicode *buf;
+   size_t n = 0, max = _esc_string_max(ty);
    int len = 0;
 
-   cc = c;
-   b = buf;
-   be = buf + sizeof(buf) / sizeof(buf[0]);
-   while ((cc < ce) && (*cc != ST) && (b < be))
+   for (cc = c; (cc < ce) && (*cc != ST) && (n < max); cc++, n++)
      {
-        if ((cc < ce - 1) &&
-            (((*cc == ESC) && (*(cc + 1) == '\\')) ||
-             (*cc == ST)))
+        if ((cc < ce - 1) && (*cc == ESC) && (*(cc + 1) == '\\'))
           {
              cc++;
              break;
           }
-        *b = *cc;
-        b++;
-        cc++;
      }
-   if (b == be)
+   if (n == max)
      {
         ERR("dcs parsing overflowed, skipping the whole buffer (binary data?)");
         len = cc - c;
         goto end;
      }
-   *b = 0;
    if ((*cc == ST) || (*cc == '\\')) cc++;
    else return 0;
    len = cc - c;
+   buf = _esc_string_buf(ty, n);
+   if (!buf)
+     goto end;
+   memcpy(buf, c, n * sizeof(Eina_Unicode));
+   buf[n] = 0;
    switch (buf[0])
      {
       case '+':
@@ -4923,14 +5384,7 @@ _handle_decfi(Termpty *ty)
                   if (x < max_x)
                     TERMPTY_CELL_COPY(ty, &(cells[x + 1]), &(cells[x]), 1);
                   else
-                    {
-                       cells[x].codepoint = ' ';
-                       if (EINA_UNLIKELY(cells[x].att.link_id))
-                         term_link_refcount_dec(ty, cells[x].att.link_id, 1);
-                       cells[x].att = ty->termstate.att;
-                       cells[x].att.link_id = 0;
-                       cells[x].att.dblwidth = 0;
-                    }
+                    _cell_blank(ty, &cells[x]);
                }
           }
      }
@@ -5223,3 +5677,128 @@ end:
    ty->last_char = last_char;
    return len;
 }
+
+/* {{{ Incomplete sequences */
+
+/* Remember what the incomplete sequence [c, ce[ left by
+ * termpty_handle_seq() is waiting for */
+void
+termpty_seq_pending(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce)
+{
+   size_t len = ce - c;
+
+   ty->parser.state = TERMPTY_PARSER_ESCAPE;
+   ty->parser.body = 1;
+   ty->parser.scanned = len;
+   if (c[0] == CSI)
+     ty->parser.state = TERMPTY_PARSER_CSI_PARAM;
+   else if (c[0] == OSC)
+     ty->parser.state = TERMPTY_PARSER_OSC_STRING;
+   else if ((c[0] == ESC) && (len >= 2))
+     {
+        ty->parser.body = 2;
+        switch (c[1])
+          {
+           case '[':
+              ty->parser.state = TERMPTY_PARSER_CSI_PARAM;
+              break;
+           case ']':
+              ty->parser.state = TERMPTY_PARSER_OSC_STRING;
+              break;
+           case 'P':
+              ty->parser.state = TERMPTY_PARSER_DCS_PASSTHROUGH;
+              break;
+           case '}':
+              ty->parser.state = TERMPTY_PARSER_TERMINOLOGY;
+              break;
+          }
+     }
+}
+
+/* Decode what was received of the OSC 52 payload of the pending sequence
+ * starting at c and drop it, so that it is not kept until the end of the
+ * sequence shows up */
+static void
+_osc52_stream(Termpty *ty, Eina_Unicode *c, Eina_Unicode **ce)
+{
+   Eina_Unicode *body = c + ty->parser.body, *payload, *end;
+
+   if (!ty->osc52.active)
+     {
+        /* "52;" selection ";" and anything but a query */
+        if ((*ce - body < 5) ||
+            (body[0] != '5') || (body[1] != '2') || (body[2] != ';'))
+          return;
+        for (payload = body + 3;
+             (payload < *ce - 1) && (*payload != ';') && (payload - body < 16);
+             payload++)
+          ;
+        if ((*payload != ';') || (payload[1] == '?'))
+          return;
+        payload++;
+        _osc52_stream_begin(ty);
+        ty->osc52.payload = payload - c;
+     }
+   payload = c + ty->osc52.payload;
+   end = *ce;
+   /* may be the start of the string terminator */
+   if ((end > payload) && (end[-1] == ESC))
+     end--;
+   if (end == payload)
+     return;
+   _osc52_stream_feed(ty, payload, end - payload);
+   memmove(payload, end, (*ce - end) * sizeof(Eina_Unicode));
+   *ce = payload + (*ce - end);
+}
+
+/* Whether the pending sequence [c, *ce[ may be complete now. Only the
+ * codepoints added since the previous call are looked at, so that a long
+ * sequence split across many reads is not parsed again and again.
+ * *ce is moved back when part of the sequence got handled already */
+Eina_Bool
+termpty_seq_ready(Termpty *ty, Eina_Unicode *c, Eina_Unicode **ce)
+{
+   const Eina_Unicode *cc, *body = c + ty->parser.body, *e = *ce;
+
+   cc = c + ty->parser.scanned;
+   switch (ty->parser.state)
+     {
+      case TERMPTY_PARSER_CSI_PARAM:
+         if (e - body >= SEQ_BUF_MAX)
+           return EINA_TRUE;
+         for (; cc < e; cc++)
+           if (*cc > '?')
+             return EINA_TRUE;
+         break;
+      case TERMPTY_PARSER_OSC_STRING:
+      case TERMPTY_PARSER_DCS_PASSTHROUGH:
+         if ((size_t)(e - body) >= _esc_string_max(ty))
+           return EINA_TRUE;
+         /* ESC may have been the last codepoint seen */
+         if (cc > body)
+           cc--;
+         for (; cc < e; cc++)
+           {
+              if ((*cc == ST) ||
+                  ((*cc == BEL) &&
+                   (ty->parser.state == TERMPTY_PARSER_OSC_STRING)) ||
+                  ((*cc == ESC) && (cc + 1 < e) && (cc[1] == '\\')))
+                return EINA_TRUE;
+           }
+         if (ty->parser.state == TERMPTY_PARSER_OSC_STRING)
+           _osc52_stream(ty, c, ce);
+         break;
+      case TERMPTY_PARSER_TERMINOLOGY:
+         for (; cc < e; cc++)
+           if (*cc == 0x0)
+             return EINA_TRUE;
+         break;
+      default:
+         /* short sequences are just parsed again */
+         return EINA_TRUE;
+     }
+   ty->parser.scanned = *ce - c;
+   return EINA_FALSE;
+}
+
+/* }}} */
@@ -2,6 +2,13 @@
 #define TERMINOLOGY_TERMPTY_ESC_H_ 1
 
 int termpty_handle_seq(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce);
+void termpty_seq_pending(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce);
+Eina_Bool termpty_seq_ready(Termpty *ty, Eina_Unicode *c, Eina_Unicode **ce);
+void termpty_esc_strings_trim(Termpty *ty);
+void termpty_palette_changed(Termpty *ty);
+uint8_t termpty_truecolor_approximate(Termpty *ty, uint32_t rgb);
+void termpty_tcc_stats_get(Termpty *ty, Termpty_Cache_Stats *stats);
+void termpty_sgr_cache_stats_get(Termpty *ty, Termpty_Cache_Stats *stats);
 const char * EINA_PURE termptyesc_safechar(const unsigned int c);
 
 #endif
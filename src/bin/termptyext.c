@@ -326,13 +326,16 @@ _handle_link(Termpty *ty, const Eina_Unicode *buf)
    /* highlight where the mouse is */
      {
         Termcell *cells = NULL;
+        Termatt att;
         ssize_t w;
 
         cells = termpty_cellrow_get(ty, sd->mouse.cy, &w);
-        termpty_reset_att(&cells[sd->mouse.cx].att);
-        cells[sd->mouse.cx].att.bold = 1;
-        cells[sd->mouse.cx].att.fg = COL_WHITE;
-        cells[sd->mouse.cx].att.bg = COL_RED;
+        termpty_cell_att_get(ty, &cells[sd->mouse.cx], &att);
+        termpty_reset_att(&att);
+        att.bold = 1;
+        att.fg = COL_WHITE;
+        att.bg = COL_RED;
+        termpty_cell_att_set(ty, &cells[sd->mouse.cx], &att);
      }
 
    /* skip type */
@@ -25,16 +25,52 @@ void
 termpty_cells_clear(Termpty *ty, Termcell *cells, int count)
 {
    Termcell src;
+   Termatt att = ty->termstate.att;
 
    memset(&src, 0, sizeof(src));
    src.codepoint = 0;
-   src.att = ty->termstate.att;
-   src.att.link_id = 0;
+   att.link_id = 0;
+   termpty_cell_att_set(ty, &src, &att);
 
    termpty_cell_fill(ty, &src, cells, count);
 }
 
 
+/* Lines from @start_y to @end_y move by one, up if @up, the line going out
+ * of the region coming back on its other end. Returns that line */
+static Termcell *
+_rows_rotate(Termpty *ty, int start_y, int end_y, Eina_Bool up)
+{
+   Termcell **rows = &ty->rows[ty->circular_offset];
+   Termcell *row;
+   int y;
+
+   if (up)
+     {
+        row = rows[start_y];
+        for (y = start_y; y < end_y; y++)
+          rows[y] = rows[y + 1];
+        rows[end_y] = row;
+     }
+   else
+     {
+        row = rows[end_y];
+        for (y = end_y; y > start_y; y--)
+          rows[y] = rows[y - 1];
+        rows[start_y] = row;
+     }
+   /* keep the other half of ty->rows in sync */
+   for (y = start_y + ty->circular_offset;
+        y <= end_y + ty->circular_offset; y++)
+     {
+        if (y < ty->h)
+          ty->rows[y + ty->h] = ty->rows[y];
+        else
+          ty->rows[y - ty->h] = ty->rows[y];
+     }
+   return row;
+}
+
 void
 termpty_text_scroll(Termpty *ty, Eina_Bool clear)
 {
@@ -49,7 +85,7 @@ termpty_text_scroll(Termpty *ty, Eina_Bool clear)
        (!ty->altbuf))
      termpty_text_save_top(ty, &(TERMPTY_SCREEN(ty, 0, 0)), ty->w);
 
-   termio_scroll(ty->obj, -1, start_y, end_y);
+   termpty_scroll(ty, -1, start_y, end_y);
    DBG("... scroll!!!!! [%i->%i]", start_y, end_y);
 
    if ((start_y == 0 && end_y == ty->h - 1) &&
@@ -57,7 +93,7 @@ termpty_text_scroll(Termpty *ty, Eina_Bool clear)
        (ty->termstate.right_margin == 0))
      {
         // screen is a circular buffer now
-        cells = &(ty->screen[ty->circular_offset * ty->w]);
+        cells = ty->rows[ty->circular_offset];
         if (clear)
           termpty_cells_clear(ty, cells, ty->w);
 
@@ -74,6 +110,17 @@ termpty_text_scroll(Termpty *ty, Eina_Bool clear)
         if (ty->termstate.right_margin)
           w = ty->termstate.right_margin - x;
 
+        if ((x == 0) && (w == ty->w) && (start_y < end_y))
+          {
+             cells = _rows_rotate(ty, start_y, end_y, EINA_TRUE);
+             if (clear)
+               termpty_cells_clear(ty, cells, w);
+             else
+               TERMPTY_CELL_COPY(ty, &(TERMPTY_SCREEN(ty, 0, end_y - 1)),
+                                 cells, w);
+             return;
+          }
+
         cells = &(TERMPTY_SCREEN(ty, x, end_y));
         for (y = start_y; y < end_y; y++)
           {
@@ -100,7 +147,7 @@ termpty_text_scroll_rev(Termpty *ty, Eina_Bool clear)
         end_y = ty->termstate.bottom_margin - 1;
      }
    DBG("... scroll rev!!!!! [%i->%i]", start_y, end_y);
-   termio_scroll(ty->obj, 1, start_y, end_y);
+   termpty_scroll(ty, 1, start_y, end_y);
 
    if ((start_y == 0 && end_y == (ty->h - 1)) &&
        (ty->termstate.left_margin == 0) &&
@@ -111,7 +158,7 @@ termpty_text_scroll_rev(Termpty *ty, Eina_Bool clear)
         if (ty->circular_offset < 0)
           ty->circular_offset = ty->h - 1;
 
-        cells = &(ty->screen[ty->circular_offset * ty->w]);
+        cells = ty->rows[ty->circular_offset];
         if (clear)
           termpty_cells_clear(ty, cells, ty->w);
      }
@@ -124,6 +171,17 @@ termpty_text_scroll_rev(Termpty *ty, Eina_Bool clear)
         if (ty->termstate.right_margin)
           w = ty->termstate.right_margin - x;
 
+        if ((x == 0) && (w == ty->w) && (start_y < end_y))
+          {
+             cells = _rows_rotate(ty, start_y, end_y, EINA_FALSE);
+             if (clear)
+               termpty_cells_clear(ty, cells, w);
+             else
+               TERMPTY_CELL_COPY(ty, &(TERMPTY_SCREEN(ty, 0, start_y + 1)),
+                                 cells, w);
+             return;
+          }
+
         cells = &(TERMPTY_SCREEN(ty, x, end_y));
         for (y = end_y; y > start_y; y--)
           {
@@ -177,12 +235,152 @@ termpty_text_scroll_rev_test(Termpty *ty, Eina_Bool clear)
      }
 }
 
+/* Length of the run at the start of codepoints that is displayed as is:
+ * single width, nothing to skip and no combining character */
+static inline int
+_text_run_len(const Termpty *ty, const Eina_Unicode *codepoints, int len)
+{
+   /* some of latin1 is wide as ambiguous or emoji */
+   Eina_Unicode max = 0xff;
+   int n;
+
+   if ((ty->termstate.cjk_ambiguous_wide) || (ty->config->emoji_dbl_width))
+     max = 0xa0;
+
+   for (n = 0; (n < len) && (codepoints[n] <= max); n++)
+     ;
+   return n;
+}
+
+/* Whether text is written as is: no insert mode, no margins, no charset
+ * translation and no attribute changing the characters */
+static inline Eina_Bool
+_text_is_plain(const Termpty *ty)
+{
+   return ((!ty->termstate.insert) && (ty->termstate.wrap) &&
+           (!ty->termstate.left_margin) && (!ty->termstate.right_margin) &&
+           (ty->termstate.charsetch != '0') &&
+           (ty->termstate.charsetch != 'A') &&
+           (!ty->termstate.att.fraktur) && (!ty->termstate.att.encircled));
+}
+
+/* Write a run of plain text when there is no insert mode, no margins and
+ * no charset translation. Whole row segments are filled at once */
+static void
+_text_append_run(Termpty *ty, const Eina_Unicode *codepoints, int len)
+{
+   Termatt att = ty->termstate.att;
+
+   att.dblwidth = 0;
+   while (len > 0)
+     {
+        Termcell *cells;
+        int n;
+
+        if (ty->cursor_state.wrapnext)
+          {
+             cells = &(TERMPTY_SCREEN(ty, 0, ty->cursor_state.cy));
+             cells[ty->w - 1].autowrapped = 1;
+             ty->cursor_state.wrapnext = 0;
+             ty->cursor_state.cx = 0;
+             ty->cursor_state.cy++;
+             termpty_text_scroll_test(ty, EINA_TRUE);
+          }
+        cells = &(TERMPTY_SCREEN(ty, 0, ty->cursor_state.cy));
+        n = ty->w - ty->cursor_state.cx;
+        if (n > len)
+          n = len;
+        termpty_cell_codepoints_att_fill(ty, codepoints, att,
+                                         &(cells[ty->cursor_state.cx]), n);
+        if (ty->cursor_state.cx + n >= ty->w)
+          {
+             ty->cursor_state.cx = ty->w - 1;
+             ty->cursor_state.wrapnext = 1;
+          }
+        else
+          ty->cursor_state.cx += n;
+        codepoints += n;
+        len -= n;
+     }
+}
+
+/* Codepoints that go with the one before them in a cluster: combining marks,
+ * variation selectors, emoji modifiers and tags, and the zero width joiner */
+static inline Eina_Bool
+_codepoint_is_extend(Eina_Unicode g)
+{
+   return (((g >= 0x300) && (g <= 0x36f)) ||
+           ((g >= 0x1ab0) && (g <= 0x1aff)) ||
+           ((g >= 0x1dc0) && (g <= 0x1dff)) ||
+           (g == 0x200d) ||
+           ((g >= 0x20d0) && (g <= 0x20ff)) ||
+           ((g >= 0xfe00) && (g <= 0xfe0f)) ||
+           ((g >= 0xfe20) && (g <= 0xfe2f)) ||
+           ((g >= 0x1f3fb) && (g <= 0x1f3ff)) ||
+           ((g >= 0xe0020) && (g <= 0xe007f)) ||
+           ((g >= 0xe0100) && (g <= 0xe01ef)));
+}
+
+/* Rough blocks of pictographs, that a zero width joiner joins together */
+static inline Eina_Bool
+_codepoint_is_pictographic(Eina_Unicode g)
+{
+   return (((g >= 0x2300) && (g <= 0x23ff)) ||
+           ((g >= 0x2600) && (g <= 0x27bf)) ||
+           ((g >= 0x2b00) && (g <= 0x2bff)) ||
+           ((g >= 0x1f000) && (g <= 0x1faff)));
+}
+
+static inline Eina_Bool
+_codepoint_is_regional_indicator(Eina_Unicode g)
+{
+   return (g >= 0x1f1e6) && (g <= 0x1f1ff);
+}
+
+/* The cell written last on the cursor row, NULL if there is none */
+static Termcell *
+_text_cluster_last(Termpty *ty, Termcell *cells)
+{
+   int x = ty->cursor_state.cx;
+
+   if (!ty->cursor_state.wrapnext)
+     {
+        if (x <= 0)
+          return NULL;
+        x--;
+        if ((x > 0) && (cells[x].codepoint == 0) && (cells[x - 1].dblwidth))
+          x--;
+     }
+   if ((cells[x].codepoint == 0) || (cells[x].codepoint & 0x80000000))
+     return NULL;
+   return &cells[x];
+}
+
+/* Whether @g, not extending what is before, still joins the cluster
+ * @codepoint: pictographs after a joiner, or a pair of regional indicators
+ * making a flag */
+static Eina_Bool
+_text_cluster_joins(const Termpty *ty, Eina_Unicode codepoint,
+                    Eina_Unicode g)
+{
+   Eina_Unicode codepoints[TERMPTY_CLUSTER_LEN];
+   int len;
+
+   len = termpty_cluster_codepoints_get(ty, codepoint, codepoints);
+   if ((len == 1) && _codepoint_is_regional_indicator(g))
+     return _codepoint_is_regional_indicator(codepoints[0]);
+   return ((len > 1) && (codepoints[len - 1] == 0x200d) &&
+           _codepoint_is_pictographic(codepoints[0]) &&
+           _codepoint_is_pictographic(g));
+}
+
 void
 termpty_text_append(Termpty *ty, const Eina_Unicode *codepoints, int len)
 {
    Termcell *cells;
    int i, j;
    int origin = ty->termstate.left_margin;
+   Eina_Bool run = _text_is_plain(ty);
 
    cells = &(TERMPTY_SCREEN(ty, 0, ty->cursor_state.cy));
    for (i = 0; i < len; i++)
@@ -190,6 +388,60 @@ termpty_text_append(Termpty *ty, const Eina_Unicode *codepoints, int len)
         int max_right = ty->w;
         Eina_Unicode g;
 
+        if ((run) && (!ty->termstate.combining_strike))
+          {
+             int n = _text_run_len(ty, codepoints + i, len - i);
+
+             if (n > 1)
+               {
+                  _text_append_run(ty, codepoints + i, n);
+                  cells = &(TERMPTY_SCREEN(ty, 0, ty->cursor_state.cy));
+                  i += n - 1;
+                  continue;
+               }
+          }
+
+        g = _termpty_charset_trans(ty, codepoints[i]);
+        /* Skip 0-width space or RTL/LTR marks */
+        if (EINA_UNLIKELY(g >= 0x200b && g <= 0x200f && g != 0x200d))
+          {
+             continue;
+          }
+        if (EINA_UNLIKELY(g >= 0x300))
+          {
+             Termcell *last;
+
+             if (EINA_UNLIKELY(g == 0x336))
+               {
+                  /* combining strike is shown as an attribute */
+                  ty->termstate.combining_strike = 1;
+                  continue;
+               }
+             if (_codepoint_is_extend(g))
+               {
+                  /* dropped when there is nothing to combine with */
+                  last = _text_cluster_last(ty, cells);
+                  if (last)
+                    last->codepoint = termpty_cluster_append(ty,
+                                                             last->codepoint,
+                                                             g);
+                  continue;
+               }
+             if (((_codepoint_is_regional_indicator(g)) ||
+                  (_codepoint_is_pictographic(g))) &&
+                 (last = _text_cluster_last(ty, cells)) &&
+                 (_text_cluster_joins(ty, last->codepoint, g)))
+               {
+                  last->codepoint = termpty_cluster_append(ty,
+                                                           last->codepoint,
+                                                           g);
+                  continue;
+               }
+             /* clusters are only made here */
+             if (EINA_UNLIKELY(TERMPTY_CODEPOINT_IS_CLUSTER(g)))
+               g = 0xfffd;
+          }
+
         if (ty->termstate.right_margin &&
             (ty->cursor_state.cx < ty->termstate.right_margin))
           {
@@ -198,7 +450,7 @@ termpty_text_append(Termpty *ty, const Eina_Unicode *codepoints, int len)
 
         if (ty->cursor_state.wrapnext)
           {
-             cells[max_right-1].att.autowrapped = 1;
+             cells[max_right-1].autowrapped = 1;
              ty->cursor_state.wrapnext = 0;
              ty->cursor_state.cx = origin;
              ty->cursor_state.cy++;
@@ -211,40 +463,27 @@ termpty_text_append(Termpty *ty, const Eina_Unicode *codepoints, int len)
                TERMPTY_CELL_COPY(ty, &(cells[j - 1]), &(cells[j]), 1);
           }
 
-        g = _termpty_charset_trans(ty, codepoints[i]);
-        /* Skip 0-width space or RTL/LTR marks */
-        if (EINA_UNLIKELY(g >= 0x200b && g <= 0x200f))
-          {
-             continue;
-          }
-        /* Skip variation selectors */
-        if (EINA_UNLIKELY(g >= 0xfe00 && g <= 0xfe0f))
-          {
-             continue;
-          }
-        if (EINA_UNLIKELY(g >= 0x300 && g <=0x36f))
-          {
-             /* combining chars */
-             if (EINA_UNLIKELY(g == 0x336))
-               {
-                  ty->termstate.combining_strike = 1;
-               }
-             continue;
-          }
 
         termpty_cell_codepoint_att_fill(ty, g, ty->termstate.att,
                                         &(cells[ty->cursor_state.cx]), 1);
         if (EINA_UNLIKELY(ty->termstate.combining_strike))
           {
+             Termatt att;
+
              ty->termstate.combining_strike = 0;
-             cells[ty->cursor_state.cx].att.strike = 1;
+             termpty_cell_att_get(ty, &cells[ty->cursor_state.cx], &att);
+             att.strike = 1;
+             termpty_cell_att_set(ty, &cells[ty->cursor_state.cx], &att);
           }
 
-        cells[ty->cursor_state.cx].att.dblwidth = _termpty_is_dblwidth_get(ty, g);
-        if (EINA_UNLIKELY((cells[ty->cursor_state.cx].att.dblwidth) && (ty->cursor_state.cx < (max_right - 1))))
+        cells[ty->cursor_state.cx].dblwidth = _termpty_is_dblwidth_get(ty, g);
+        if (EINA_UNLIKELY((cells[ty->cursor_state.cx].dblwidth) && (ty->cursor_state.cx < (max_right - 1))))
           {
-             cells[ty->cursor_state.cx].att.newline = 0;
-             termpty_cell_codepoint_att_fill(ty, 0, cells[ty->cursor_state.cx].att,
+             Termatt att;
+
+             cells[ty->cursor_state.cx].newline = 0;
+             termpty_cell_att_get(ty, &cells[ty->cursor_state.cx], &att);
+             termpty_cell_codepoint_att_fill(ty, 0, att,
                                              &(cells[ty->cursor_state.cx + 1]), 1);
           }
 
@@ -253,7 +492,7 @@ termpty_text_append(Termpty *ty, const Eina_Unicode *codepoints, int len)
              unsigned char offset = 1;
 
              ty->cursor_state.wrapnext = 0;
-             if (EINA_UNLIKELY(cells[ty->cursor_state.cx].att.dblwidth))
+             if (EINA_UNLIKELY(cells[ty->cursor_state.cx].dblwidth))
                offset = 2;
              if (EINA_UNLIKELY(ty->cursor_state.cx >= (max_right - offset)))
                ty->cursor_state.wrapnext = 1;
@@ -268,7 +507,7 @@ termpty_text_append(Termpty *ty, const Eina_Unicode *codepoints, int len)
              unsigned char offset = 1;
 
              ty->cursor_state.wrapnext = 0;
-             if (EINA_UNLIKELY(cells[ty->cursor_state.cx].att.dblwidth))
+             if (EINA_UNLIKELY(cells[ty->cursor_state.cx].dblwidth))
                offset = 2;
              ty->cursor_state.cx += offset;
              if (ty->cursor_state.cx > (max_right - offset))
@@ -281,6 +520,92 @@ termpty_text_append(Termpty *ty, const Eina_Unicode *codepoints, int len)
      }
 }
 
+/* The end of the line of printable ascii ended by "\r\n" at @c, NULL if
+ * there is none before @ce or if it does not fit on a row */
+static const Eina_Unicode *
+_text_flood_line(const Termpty *ty, const Eina_Unicode *c,
+                 const Eina_Unicode *ce)
+{
+   const Eina_Unicode *p;
+
+   for (p = c; (p < ce) && (p - c <= ty->w) && (*p >= 0x20) && (*p < 0x7f);
+        p++)
+     ;
+   if ((p - c > ty->w) || (ce - p < 2) || (p[0] != '\r') || (p[1] != '\n'))
+     return NULL;
+   return p + 2;
+}
+
+/* Handle at once the line feed at @c on the last row and the lines of plain
+ * text following it, when there are enough of them to scroll the whole
+ * screen: the screen goes to the backlog, then the lines it would never show
+ * are composed there directly and only the last ones are written on the
+ * screen. Returns how many codepoints were handled, 0 if that cannot be done.
+ * The line feeds before *@checked are known to be followed by too few lines
+ * and are not looked at again */
+int
+termpty_text_flood(Termpty *ty, const Eina_Unicode *c, const Eina_Unicode *ce,
+                   const Eina_Unicode **checked)
+{
+   const Eina_Unicode *line, *end;
+   Termatt att = ty->termstate.att;
+   int lines = 0, direct, had_cr_x = 0, i, y;
+
+   if ((!_text_is_plain(ty)) || (ty->termstate.combining_strike) ||
+       (ty->termstate.top_margin) || (ty->termstate.bottom_margin) ||
+       (ty->altbuf) || (att.link_id) ||
+       ((ty->block.expecting) && (ty->block.on)) ||
+       (ty->cursor_state.cy != ty->h - 1) || (ty->cursor_state.cx != 0))
+     return 0;
+   for (line = c + 1; (end = _text_flood_line(ty, line, ce)); line = end)
+     lines++;
+   if (lines < ty->h)
+     {
+        *checked = line;
+        return 0;
+     }
+
+   for (y = 0; y < ty->h; y++)
+     termpty_text_save_top(ty, &(TERMPTY_SCREEN(ty, 0, y)), ty->w);
+   ty->circular_offset = (ty->circular_offset + lines + 1) % ty->h;
+   for (y = 0; y < ty->h; y++)
+     termpty_cells_clear(ty, &(TERMPTY_SCREEN(ty, 0, y)), ty->w);
+
+   att.dblwidth = 0;
+   direct = lines - ty->h + 1;
+   for (i = 0, line = c + 1; i < lines; i++, line = end)
+     {
+        int n;
+
+        end = _text_flood_line(ty, line, ce);
+        n = end - line - 2;
+        /* where the carriage return found the cursor */
+        if (MIN(n, ty->w - 1) > 0)
+          had_cr_x = MIN(n, ty->w - 1);
+        if (i < direct)
+          {
+             termpty_text_save_codepoints(ty, line, n);
+             continue;
+          }
+        if (n > 0)
+          {
+             Termcell *cells = &(TERMPTY_SCREEN(ty, 0, i - direct));
+
+             termpty_cell_codepoints_att_fill(ty, line, att, cells, n);
+          }
+     }
+   /* the screen scrolled once for each line feed */
+   termpty_scroll(ty, -(lines + 1), 0, ty->h - 1);
+   if (had_cr_x)
+     {
+        ty->termstate.had_cr_x = had_cr_x;
+        ty->termstate.had_cr_y = ty->h - 1;
+     }
+   ty->cursor_state.wrapnext = 0;
+   ty->last_char = 0;
+   return end - c;
+}
+
 void
 termpty_clear_line(Termpty *ty, Termpty_Clear mode, int limit)
 {
@@ -346,22 +671,13 @@ termpty_clear_screen(Termpty *ty, Termpty_Clear mode)
       case TERMPTY_CLR_BEGIN:
         if (ty->cursor_state.cy > 0)
           {
-             // First clear from circular > height, then from 0 to circular
-             int y = ty->cursor_state.cy + ty->circular_offset;
+             int y;
 
-             cells = &(TERMPTY_SCREEN(ty, 0, 0));
-
-             if (y < ty->h)
+             // lines are not contiguous, clear them one by one
+             for (y = 0; y < ty->cursor_state.cy; y++)
                {
-                  termpty_cells_clear(ty, cells, ty->w * ty->cursor_state.cy);
-               }
-             else
-               {
-                  int yt = y % ty->h;
-                  int yb = ty->h - ty->circular_offset;
-
-                  termpty_cells_clear(ty, cells, ty->w * yb);
-                  termpty_cells_clear(ty, ty->screen, ty->w * yt);
+                  cells = &(TERMPTY_SCREEN(ty, 0, y));
+                  termpty_cells_clear(ty, cells, ty->w);
                }
           }
         termpty_clear_line(ty, mode, ty->w);
@@ -411,16 +727,16 @@ termpty_reset_att(Termatt *att)
    att->overlined = 0;
    att->tab_inserted = 0;
    att->tab_last = 0;
+   att->fgrgb = 0;
+   att->bgrgb = 0;
+   att->fg_hi = 0;
+   att->bg_hi = 0;
 }
 
 void
 termpty_soft_reset_state(Termpty *ty)
 {
    int i;
-   Config *config = NULL;
-
-   if (ty->obj)
-     config = termio_config_get(ty->obj);
 
    ty->termstate.top_margin = 0;
    ty->termstate.bottom_margin = 0;
@@ -457,14 +773,19 @@ termpty_soft_reset_state(Termpty *ty)
    ty->mouse_ext = MOUSE_EXT_NONE;
    ty->bracketed_paste = 0;
 
-   termio_reset_main_colors(ty->obj);
    termpty_clear_tabs_on_screen(ty);
    for (i = 0; i < ty->w; i += TAB_WIDTH)
      {
         TAB_SET(ty, i);
      }
-   if (config && ty->obj)
-     termio_set_cursor_shape(ty->obj, config->cursor_shape);
+
+   if (termpty_main_loop_begin(ty))
+     {
+        termio_reset_main_colors(ty->obj);
+        if (ty->config && ty->obj)
+          termio_set_cursor_shape(ty->obj, ty->config->cursor_shape);
+        termpty_main_loop_end(ty);
+     }
 }
 
 void
@@ -473,6 +794,7 @@ termpty_reset_state(Termpty *ty)
    termpty_soft_reset_state(ty);
    ty->cursor_state.cx = 0;
    ty->cursor_state.cy = 0;
+   ty->sync_output.active = EINA_FALSE;
    termpty_clear_backlog(ty);
 }
 
@@ -510,7 +832,7 @@ termpty_move_cursor(Termpty *ty, int cx, int cy)
              /* go down */
              cells = termpty_cellrow_get(ty, cur_cy, &wlen);
              assert(cells);
-             if (cells[wlen-1].att.autowrapped)
+             if (cells[wlen-1].autowrapped)
                {
                   n_to_right += ty->w;
                }
@@ -525,7 +847,7 @@ termpty_move_cursor(Termpty *ty, int cx, int cy)
              /* go up */
              cells = termpty_cellrow_get(ty, cur_cy - 1, &wlen);
              assert(cells);
-             if (cells[wlen-1].att.autowrapped)
+             if (cells[wlen-1].autowrapped)
                {
                   n_to_right -= ty->w;
                }
@@ -9,6 +9,8 @@ typedef enum tag_Termpty_Clear
 } Termpty_Clear;
 
 void termpty_text_save_top(Termpty *ty, Termcell *cells, ssize_t w_max);
+void termpty_text_save_codepoints(Termpty *ty, const Eina_Unicode *codepoints,
+                                  int n);
 void termpty_cells_copy(Termpty *ty, Termcell *cells, Termcell *dest, int count);
 void termpty_cells_clear(Termpty *ty, Termcell *cells, int count);
 void termpty_cells_att_fill_preserve_colors(Termpty *ty, Termcell *cells,
@@ -18,6 +20,8 @@ void termpty_text_scroll_rev(Termpty *ty, Eina_Bool clear);
 void termpty_text_scroll_test(Termpty *ty, Eina_Bool clear);
 void termpty_text_scroll_rev_test(Termpty *ty, Eina_Bool clear);
 void termpty_text_append(Termpty *ty, const Eina_Unicode *codepoints, int len);
+int termpty_text_flood(Termpty *ty, const Eina_Unicode *c,
+                       const Eina_Unicode *ce, const Eina_Unicode **checked);
 void termpty_clear_line(Termpty *ty, Termpty_Clear mode, int limit);
 void termpty_clear_screen(Termpty *ty, Termpty_Clear mode);
 void termpty_clear_all(Termpty *ty);
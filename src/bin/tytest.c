@@ -42,6 +42,16 @@ static struct {
        { "color_parse_css_hsl", tytest_color_parse_css_hsl},
        { "extn_matching", tytest_extn_matching},
        { "base64", tytest_base64},
+       { "base64_chunks", tytest_base64_chunks},
+       { "utf8_decode", tytest_utf8_decode},
+       { "colors_lut", tytest_colors_lut},
+       { "truecolor_ids", tytest_truecolor_ids},
+       { "colors_default", tytest_colors_default},
+       { "cache_stats", tytest_cache_stats},
+       { "atts", tytest_atts},
+       { "row_flags", tytest_row_flags},
+       { "clusters", tytest_clusters},
+       { "backlog", tytest_backlog},
        { NULL, NULL},
 };
 
@@ -138,6 +148,34 @@ _termpty_to_termpty_tests(Termpty *ty, Termpty_Tests *tt)
    tt->bracketed_paste = ty->bracketed_paste;
 }
 
+/* Cells are hashed as they were before attributes were interned, with
+ * their attributes in full, not to depend on the ids. Rows are taken from
+ * the start of the circular buffer, not from the top of the screen */
+static void
+_tytest_checksum_cells(MD5_CTX *ctx, const Termpty *ty, Termcell **rows)
+{
+   struct {
+      Eina_Unicode codepoint;
+      Termatt att;
+   } cell;
+   Eina_Unicode codepoints[TERMPTY_CLUSTER_LEN];
+   int x, y, len;
+
+   for (y = 0; y < ty->h; y++)
+     for (x = 0; x < ty->w; x++)
+       {
+          /* clusters by their codepoints, again not to depend on the ids */
+          len = termpty_cluster_codepoints_get(ty, rows[y][x].codepoint,
+                                               codepoints);
+          if (len > 1)
+            MD5Update(ctx, (unsigned char const*)codepoints,
+                      (len - 1) * sizeof(Eina_Unicode));
+          cell.codepoint = codepoints[len - 1];
+          termpty_cell_att_get(ty, &rows[y][x], &cell.att);
+          MD5Update(ctx, (unsigned char const*)&cell, sizeof(cell));
+       }
+}
+
 static void
 _tytest_checksum(Termpty *ty)
 {
@@ -156,12 +194,8 @@ _tytest_checksum(Termpty *ty)
              (unsigned char const*)&tests,
              sizeof(tests));
    /* The screens */
-   MD5Update(&ctx,
-             (unsigned char const*)ty->screen,
-             sizeof(Termcell) * ty->w * ty->h);
-   MD5Update(&ctx,
-             (unsigned char const*)ty->screen2,
-             sizeof(Termcell) * ty->w * ty->h);
+   _tytest_checksum_cells(&ctx, ty, ty->rows);
+   _tytest_checksum_cells(&ctx, ty, ty->rows2);
    /* Icon/Title */
    if (ty->prop.icon)
      {
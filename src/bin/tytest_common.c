@@ -353,6 +353,19 @@ termio_textgrid_get(const Evas_Object *obj EINA_UNUSED)
    return NULL;
 }
 
+void
+termio_palette_extended_get(const Evas_Object *obj EINA_UNUSED, int c,
+                            int *r, int *g, int *b, int *a)
+{
+   unsigned char r8, g8, b8, a8;
+
+   colors_256_get(c, &r8, &g8, &b8, &a8);
+   *r = r8;
+   *g = g8;
+   *b = b8;
+   *a = a8;
+}
+
 Evas_Object *
 termio_bg_get(const Evas_Object *obj EINA_UNUSED)
 {
@@ -469,12 +482,16 @@ _termpty_init(Termpty *ty, Config *config)
    ty->screen2 = calloc(1, sizeof(Termcell) * ty->w * ty->h);
    assert(ty->screen);
    assert(ty->screen2);
+   assert(termpty_rows_init(ty));
    ty->circular_offset = 0;
    ty->fd = STDIN_FILENO;
    ty->hl.bitmap = calloc(1, HL_LINKS_MAX / 8); /* bit map for 1 << 16 elements */
    assert(ty->hl.bitmap);
    /* Mark id 0 as set */
    ty->hl.bitmap[0] = 1;
+   assert(termpty_atts_init(ty));
+   assert(termpty_clusters_init(ty));
+   assert(termpty_row_flags_reset(ty));
    ty->backlog_beacon.backlog_y = 0;
    ty->backlog_beacon.screen_y = 0;
 }
@@ -484,19 +501,11 @@ tytest_common_main_loop(void)
 {
    do
      {
-        char buf[4097];
-        Eina_Unicode codepoint[4097];
-        int i, j;
-        char *rbuf = buf;
-        int len = sizeof(buf) - 1;
+        char buf[4096];
+        Eina_Unicode *codepoint;
+        int j, len;
 
-        for (i = 0; i < (int)sizeof(_ty.oldbuf) && _ty.oldbuf[i] & 0x80; i++)
-          {
-             *rbuf = _ty.oldbuf[i];
-             rbuf++;
-             len--;
-          }
-        len = read(_ty.fd, rbuf, len);
+        len = read(_ty.fd, buf, sizeof(buf));
         if (len < 0 && errno != EAGAIN)
           {
              ERR("error while reading from tty slave fd");
@@ -504,46 +513,12 @@ tytest_common_main_loop(void)
           }
         if (len <= 0) break;
 
-        for (i = 0; i < (int)sizeof(_ty.oldbuf); i++)
-          _ty.oldbuf[i] = 0;
-
-        len += rbuf - buf;
-
-        buf[len] = 0;
-        // convert UTF8 to codepoint integers
-        j = 0;
-        for (i = 0; i < len;)
-          {
-             int g = 0, prev_i = i;
-
-             if (buf[i])
-               {
-                  g = eina_unicode_utf8_next_get(buf, &i);
-                  if ((0xdc80 <= g) && (g <= 0xdcff) &&
-                      (len - prev_i) <= (int)sizeof(_ty.oldbuf))
-                    {
-                       int k;
-                       for (k = 0;
-                            (k < (int)sizeof(_ty.oldbuf)) &&
-                            (k < (len - prev_i));
-                            k++)
-                         {
-                            _ty.oldbuf[k] = buf[prev_i+k];
-                         }
-                       DBG("failure at %d/%d/%d", prev_i, i, len);
-                       break;
-                    }
-               }
-             else
-               {
-                  g = 0;
-                  i++;
-               }
-             codepoint[j] = g;
-             j++;
-          }
-        codepoint[j] = 0;
-        termpty_handle_buf(&_ty, codepoint, j);
+        // convert UTF8 to codepoint integers, straight into the parser buffer
+        codepoint = termpty_handle_buf_reserve(&_ty, len + UTF8_SEQ_MAX);
+        if (!codepoint)
+          break;
+        j = utf8_decode(&_ty.utf8, buf, len, codepoint);
+        termpty_handle_buf(&_ty, j);
      }
    while (1);
 }
@@ -19,5 +19,15 @@ int tytest_color_parse_css_rgb(void);
 int tytest_color_parse_css_hsl(void);
 int tytest_extn_matching(void);
 int tytest_base64(void);
+int tytest_base64_chunks(void);
+int tytest_utf8_decode(void);
+int tytest_colors_lut(void);
+int tytest_truecolor_ids(void);
+int tytest_colors_default(void);
+int tytest_cache_stats(void);
+int tytest_atts(void);
+int tytest_row_flags(void);
+int tytest_clusters(void);
+int tytest_backlog(void);
 
 #endif
@@ -1,5 +1,15 @@
 #include "private.h" 
+#include <string.h>
 #include "utf8.h"
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+# include <immintrin.h>
+#endif
+#if defined(BINARY_TYTEST)
+# include <assert.h>
+#endif
 
 int
 codepoint_to_utf8(Eina_Unicode g, char *txt)
@@ -40,3 +50,281 @@ codepoint_to_utf8(Eina_Unicode g, char *txt)
         return 0;
      }
 }
+
+/* Decoding rules are the ones of eina_unicode_utf8_next_get(): overlong
+ * forms are rejected, 5 and 6 bytes forms are accepted, and an invalid byte
+ * is replaced by 0xdc00 | byte before going on with the next byte. Nul
+ * bytes are decoded as codepoint 0 */
+
+#define UTF8_ERROR(_c) (0xdc00 | (_c))
+
+static const Eina_Unicode _seq_min[UTF8_SEQ_MAX + 1] = {
+     0, 0, 0x80, 0x800, 0x10000, 0x200000, 0x4000000
+};
+
+static inline int
+_seq_len(unsigned char lead)
+{
+   if (lead < 0x80)
+     return 1;
+   if ((lead & 0xe0) == 0xc0)
+     return 2;
+   if ((lead & 0xf0) == 0xe0)
+     return 3;
+   if ((lead & 0xf8) == 0xf0)
+     return 4;
+   if ((lead & 0xfc) == 0xf8)
+     return 5;
+   if ((lead & 0xfe) == 0xfc)
+     return 6;
+   return 0;
+}
+
+/* Decode the sequence starting at s[0], with at most len bytes available.
+ * Sets *used to the number of bytes consumed */
+static inline Eina_Unicode
+_seq_decode(const unsigned char *s, int len, int *used)
+{
+   int n = _seq_len(s[0]), i;
+   Eina_Unicode r;
+
+   *used = 1;
+   if (n == 1)
+     return s[0];
+   if ((n == 0) || (n > len))
+     return UTF8_ERROR(s[0]);
+   r = s[0] & (0x7f >> n);
+   for (i = 1; i < n; i++)
+     {
+        if ((s[i] & 0xc0) != 0x80)
+          return UTF8_ERROR(s[0]);
+        r = (r << 6) | (s[i] & 0x3f);
+     }
+   if (r < _seq_min[n])
+     return UTF8_ERROR(s[0]);
+   *used = n;
+   return r;
+}
+
+/* Whether s[0..len[ is the beginning of a sequence that may still be valid
+ * once more bytes are known */
+static inline Eina_Bool
+_seq_is_prefix(const unsigned char *s, int len)
+{
+   int n = _seq_len(s[0]), i;
+
+   if ((n < 2) || (len >= n))
+     return EINA_FALSE;
+   for (i = 1; i < len; i++)
+     if ((s[i] & 0xc0) != 0x80)
+       return EINA_FALSE;
+   return EINA_TRUE;
+}
+
+/* Widen the run of ASCII bytes starting at s[0]. Returns its length */
+static inline int
+_ascii_run(const unsigned char *s, int len, Eina_Unicode *out)
+{
+   int i = 0;
+
+#if defined(__AVX2__)
+   for (; i + 32 <= len; i += 32)
+     {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+        int k;
+
+        if (_mm256_movemask_epi8(v))
+          break;
+        for (k = 0; k < 32; k += 8)
+          {
+             __m128i b = _mm_loadl_epi64((const __m128i *)(s + i + k));
+
+             _mm256_storeu_si256((__m256i *)(out + i + k),
+                                 _mm256_cvtepu8_epi32(b));
+          }
+     }
+#endif
+#if defined(__SSE2__)
+   for (; i + 16 <= len; i += 16)
+     {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i lo, hi;
+
+        if (_mm_movemask_epi8(v))
+          break;
+        lo = _mm_unpacklo_epi8(v, zero);
+        hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *)(out + i + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *)(out + i + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i *)(out + i + 12), _mm_unpackhi_epi16(hi, zero));
+     }
+#endif
+   for (; (i < len) && (s[i] < 0x80); i++)
+     out[i] = s[i];
+   return i;
+}
+
+void
+utf8_decoder_reset(Utf8_Decoder *dec)
+{
+   dec->carry_len = 0;
+}
+
+/* Decode len bytes of buf, following the bytes given to the previous calls.
+ * codepoints must have room for len + UTF8_SEQ_MAX entries.
+ * Returns the number of codepoints written */
+int
+utf8_decode(Utf8_Decoder *dec, const char *buf, int len,
+            Eina_Unicode *codepoints)
+{
+   const unsigned char *s = (const unsigned char *)buf;
+   int i = 0, j = 0;
+
+   if (dec->carry_len > 0)
+     {
+        unsigned char seq[UTF8_SEQ_MAX];
+        int n = _seq_len(dec->carry[0]), k, used;
+
+        /* complete the pending sequence with the first bytes of buf */
+        memcpy(seq, dec->carry, dec->carry_len);
+        for (k = dec->carry_len; (k < n) && (i < len); k++, i++)
+          seq[k] = s[i];
+        if (_seq_is_prefix(seq, k))
+          {
+             memcpy(dec->carry, seq, k);
+             dec->carry_len = k;
+             return 0;
+          }
+        codepoints[j++] = _seq_decode(seq, k, &used);
+        if (used == 1)
+          {
+             /* the carried continuation bytes are invalid on their own,
+              * anything taken from buf is decoded again */
+             for (k = 1; k < dec->carry_len; k++)
+               codepoints[j++] = UTF8_ERROR(seq[k]);
+             i = 0;
+          }
+        dec->carry_len = 0;
+     }
+
+   while (i < len)
+     {
+        int used;
+
+        if (s[i] < 0x80)
+          {
+             used = _ascii_run(s + i, len - i, codepoints + j);
+             i += used;
+             j += used;
+             continue;
+          }
+        if (_seq_is_prefix(s + i, len - i))
+          {
+             dec->carry_len = len - i;
+             memcpy(dec->carry, s + i, dec->carry_len);
+             break;
+          }
+        codepoints[j++] = _seq_decode(s + i, len - i, &used);
+        i += used;
+     }
+   return j;
+}
+
+#if defined(BINARY_TYTEST)
+static unsigned int _rand_state = 0x1234567;
+
+static unsigned int
+_test_rand(void)
+{
+   _rand_state = _rand_state * 1103515245 + 12345;
+   return (_rand_state >> 8) & 0xffffff;
+}
+
+/* fill buf with a mix of ascii runs, valid and broken sequences */
+static int
+_test_fill(char *buf, int size)
+{
+   int len = 0;
+
+   while (len < size - 40)
+     {
+        char txt[8];
+        int k, n;
+
+        switch (_test_rand() % 5)
+          {
+           case 0:
+              n = _test_rand() % 40;
+              for (k = 0; k < n; k++)
+                buf[len++] = ' ' + (_test_rand() % 95);
+              break;
+           case 1:
+              n = codepoint_to_utf8(0x80 + (_test_rand() % 0x10ff80), txt);
+              memcpy(buf + len, txt, n);
+              len += n;
+              break;
+           case 2:
+              n = codepoint_to_utf8(0x80 + (_test_rand() % 0x10ff80), txt);
+              n = 1 + (_test_rand() % n);
+              memcpy(buf + len, txt, n);
+              len += n;
+              break;
+           case 3:
+              buf[len++] = _test_rand() & 0xff;
+              break;
+           default:
+              buf[len++] = '\0';
+          }
+     }
+   /* make sure nothing is left in the decoder at the end */
+   buf[len++] = 'x';
+   return len;
+}
+
+int
+tytest_utf8_decode(void)
+{
+   char buf[4096];
+   Eina_Unicode expected[4096], res[4096 + UTF8_SEQ_MAX];
+   int round;
+
+   for (round = 0; round < 200; round++)
+     {
+        Utf8_Decoder dec;
+        int len = _test_fill(buf, sizeof(buf) - 1), i, j, n;
+
+        buf[len] = '\0';
+        for (i = 0, n = 0; i < len; n++)
+          {
+             if (buf[i])
+               expected[n] = eina_unicode_utf8_next_get(buf, &i);
+             else
+               expected[n] = buf[i++];
+          }
+
+        /* the whole buffer at once */
+        utf8_decoder_reset(&dec);
+        j = utf8_decode(&dec, buf, len, res);
+        assert(j == n);
+        assert(dec.carry_len == 0);
+        assert(memcmp(res, expected, n * sizeof(Eina_Unicode)) == 0);
+
+        /* in small random chunks */
+        utf8_decoder_reset(&dec);
+        for (i = 0, j = 0; i < len;)
+          {
+             int chunk = 1 + (_test_rand() % 7);
+
+             if (chunk > len - i)
+               chunk = len - i;
+             j += utf8_decode(&dec, buf + i, chunk, res + j);
+             i += chunk;
+          }
+        assert(j == n);
+        assert(memcmp(res, expected, n * sizeof(Eina_Unicode)) == 0);
+     }
+   return 0;
+}
+#endif
@@ -1,7 +1,22 @@
 #ifndef TERMINOLOGY_UTF8_H_
 #define TERMINOLOGY_UTF8_H_ 1
 #include <Eina.h>
+
+/* Longest sequence accepted by eina_unicode_utf8_next_get() */
+#define UTF8_SEQ_MAX 6
+
+/* Streaming UTF-8 decoder: an incomplete sequence at the end of a chunk is
+ * kept here until the next chunk completes it */
+typedef struct tag_Utf8_Decoder
+{
+   unsigned char carry[UTF8_SEQ_MAX - 1];
+   int carry_len;
+} Utf8_Decoder;
+
 int codepoint_to_utf8(Eina_Unicode g, char *txt);
 
+void utf8_decoder_reset(Utf8_Decoder *dec);
+int utf8_decode(Utf8_Decoder *dec, const char *buf, int len,
+                Eina_Unicode *codepoints);
+
 #endif
- 
\ No newline at end of file
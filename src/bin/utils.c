@@ -4,7 +4,6 @@
 
 #include <Ecore.h>
 #include <Ecore_File.h>
-#include <Emile.h>
 
 #include <assert.h>
 #include <unistd.h>
@@ -77,30 +76,110 @@ end:
    free(s);
 }
 
+void
+ty_base64_decoder_init(Ty_Base64_Decoder *dec)
+{
+   dec->bits = 0;
+   dec->nbits = 0;
+   dec->padding = EINA_FALSE;
+   dec->error = EINA_FALSE;
+}
+
+static inline int
+_base64_value(Eina_Unicode c)
+{
+   if ((c >= 'A') && (c <= 'Z'))
+     return c - 'A';
+   if ((c >= 'a') && (c <= 'z'))
+     return c - 'a' + 26;
+   if ((c >= '0') && (c <= '9'))
+     return c - '0' + 52;
+   if (c == '+')
+     return 62;
+   if (c == '/')
+     return 63;
+   return -1;
+}
+
+/* Decode len more base64 characters, appending the bytes to out.
+ * Returns EINA_FALSE once invalid input has been seen */
+Eina_Bool
+ty_eina_unicode_base64_decode_chunk(Ty_Base64_Decoder *dec,
+                                    const Eina_Unicode *src, size_t len,
+                                    Eina_Binbuf *out)
+{
+   unsigned char bytes[1024];
+   size_t i, n = 0;
+
+   if (dec->error)
+     return EINA_FALSE;
+   for (i = 0; i < len; i++)
+     {
+        int v = _base64_value(src[i]);
+
+        if (v < 0)
+          {
+             if (src[i] == '=')
+               {
+                  dec->padding = EINA_TRUE;
+                  continue;
+               }
+             dec->error = EINA_TRUE;
+             break;
+          }
+        if (dec->padding)
+          {
+             dec->error = EINA_TRUE;
+             break;
+          }
+        dec->bits = (dec->bits << 6) | v;
+        dec->nbits += 6;
+        if (dec->nbits >= 8)
+          {
+             dec->nbits -= 8;
+             bytes[n++] = (dec->bits >> dec->nbits) & 0xff;
+             if (n == sizeof(bytes))
+               {
+                  eina_binbuf_append_length(out, bytes, n);
+                  n = 0;
+               }
+          }
+     }
+   if (n > 0)
+     eina_binbuf_append_length(out, bytes, n);
+   return !dec->error;
+}
+
+/* Whether the input ended on a complete group */
+Eina_Bool
+ty_base64_decoder_end(Ty_Base64_Decoder *dec)
+{
+   /* a lone character can not encode a byte */
+   if (dec->nbits == 6)
+     dec->error = EINA_TRUE;
+   return !dec->error;
+}
+
 char *
 ty_eina_unicode_base64_decode(Eina_Unicode *unicode)
 {
-   int utf8_len = 0;
+   Ty_Base64_Decoder dec;
    Eina_Binbuf *bb;
-   char *src;
    char *res;
-   Eina_Strbuf *sb;
 
-   src = eina_unicode_unicode_to_utf8(unicode, &utf8_len);
-   if (!src)
+   bb = eina_binbuf_new();
+   if (!bb)
      return NULL;
-   sb = eina_strbuf_manage_new_length(src, utf8_len);
-   if (!sb)
+   ty_base64_decoder_init(&dec);
+   if ((!ty_eina_unicode_base64_decode_chunk(&dec, unicode,
+                                             eina_unicode_strlen(unicode),
+                                             bb)) ||
+       (!ty_base64_decoder_end(&dec)))
      {
-        free(src);
+        eina_binbuf_free(bb);
         return NULL;
      }
 
-   bb = emile_base64_decode(sb);
-   eina_strbuf_free(sb);
-   if (!bb)
-     return NULL;
-
    res = (char*) eina_binbuf_string_steal(bb);
    eina_binbuf_free(bb);
    return res;
@@ -145,4 +224,48 @@ int tytest_base64(void)
 
    return 0;
 }
+
+int tytest_base64_chunks(void)
+{
+   Ty_Base64_Decoder dec;
+   Eina_Binbuf *bb;
+   Eina_Unicode *src;
+   const char *expected = "♥♡👍🚲✿ ❀ ❁🙌";
+   int len, i, step;
+
+   src = eina_unicode_utf8_to_unicode(
+      "4pml4pmh8J+RjfCfmrLinL8g4p2AIOKdgfCfmYw=", &len);
+   assert(src);
+   for (step = 1; step <= len; step++)
+     {
+        bb = eina_binbuf_new();
+        assert(bb);
+        ty_base64_decoder_init(&dec);
+        for (i = 0; i < len; i += step)
+          assert(ty_eina_unicode_base64_decode_chunk(
+                &dec, src + i, (len - i < step) ? len - i : step, bb));
+        assert(ty_base64_decoder_end(&dec));
+        assert(eina_binbuf_length_get(bb) == strlen(expected));
+        assert(memcmp(eina_binbuf_string_get(bb), expected,
+                      strlen(expected)) == 0);
+        eina_binbuf_free(bb);
+     }
+   free(src);
+
+   /* invalid characters and data after padding */
+   src = eina_unicode_utf8_to_unicode("YQ==YQ==", &len);
+   assert(src);
+   bb = eina_binbuf_new();
+   ty_base64_decoder_init(&dec);
+   assert(!ty_eina_unicode_base64_decode_chunk(&dec, src, len, bb));
+   free(src);
+   src = eina_unicode_utf8_to_unicode("YQ;=", &len);
+   assert(src);
+   ty_base64_decoder_init(&dec);
+   assert(!ty_eina_unicode_base64_decode_chunk(&dec, src, len, bb));
+   eina_binbuf_free(bb);
+   free(src);
+
+   return 0;
+}
 #endif
@@ -7,5 +7,19 @@
 Eina_Bool homedir_get(char *buf, size_t size);
 void open_url(const Config *config, const char *url);
 
+/* Incremental base64 decoding, see ty_eina_unicode_base64_decode_chunk() */
+typedef struct tag_Ty_Base64_Decoder
+{
+   unsigned int bits;
+   int nbits;
+   Eina_Bool padding;
+   Eina_Bool error;
+} Ty_Base64_Decoder;
+
+void ty_base64_decoder_init(Ty_Base64_Decoder *dec);
+Eina_Bool ty_eina_unicode_base64_decode_chunk(Ty_Base64_Decoder *dec,
+                                             const Eina_Unicode *src,
+                                             size_t len, Eina_Binbuf *out);
+Eina_Bool ty_base64_decoder_end(Ty_Base64_Decoder *dec);
 char * ty_eina_unicode_base64_decode(Eina_Unicode *c);
 #endif
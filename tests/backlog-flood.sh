@@ -0,0 +1,33 @@
+#!/bin/sh
+
+# clear screen
+printf '\033[2J\033[H'
+
+# lines of plain text scrolling more than a screen at once, on a colored
+# background so that their blank cells are kept in the backlog
+printf '\033[44;33m'
+L=''
+for i in $(seq 60); do
+   case $((i % 4)) in
+      0) L="$L\r\n" ;;
+      1) L="${L}line $i\r\n" ;;
+      2) L="${L}$(printf '%080d' "$i")\r\n" ;;
+      3) L="${L}$(printf '%-20s' "$i")|\r\n" ;;
+   esac
+done
+printf "$L"
+
+# then with the default background, lines ending with spaces
+printf '\033[0m'
+L=''
+for i in $(seq 60); do
+   L="${L}$i trailing   \r\n"
+done
+printf "$L"
+
+# mouse wheel to scroll up into the backlog
+for _ in $(seq 10); do
+   printf '\033}tw;0;0;1;1;0\0'
+done
+# force render
+printf '\033}tr\0'
@@ -0,0 +1,17 @@
+#!/bin/sh
+
+# query modes that are set
+printf '\033[?7h\033[?2004h\033[4h'
+printf '\033[?7$p\033[?2004$p\033[4$p'
+
+# query modes that are reset
+printf '\033[?7l\033[?2004l\033[4l'
+printf '\033[?7$p\033[?2004$p\033[4$p'
+
+# synchronized output
+printf '\033[?2026h\033[?2026$p'
+printf 'foo'
+printf '\033[?2026l\033[?2026$p'
+
+# unknown modes
+printf '\033[?4242$p\033[42$p'
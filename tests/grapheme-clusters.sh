@@ -0,0 +1,25 @@
+#!/bin/sh
+
+# fill space with E
+printf '\033#8'
+# move to 2;1
+printf '\033[2;1H'
+
+# combining acute and grave accents, and two marks on the same letter
+printf 'e\xcc\x81te\xcc\x80 a\xcc\x81\xcc\xa7\r\n'
+# variation selector
+printf '\xe2\x9d\xa4\xef\xb8\x8f\r\n'
+# emoji modifier, then a zero width joiner sequence
+printf '\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd \xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x92\xbb\r\n'
+# a flag from two regional indicators, then a lone one
+printf '\xf0\x9f\x87\xab\xf0\x9f\x87\xb7\xf0\x9f\x87\xab\r\n'
+# a joiner between letters does not join them
+printf 'a\xe2\x80\x8db\r\n'
+# nothing to combine with at the start of a line
+printf '\xcc\x81x\r\n'
+# on the last column, the mark goes with it and does not wrap
+printf '\033[80Gz\xcc\x81\r\n'
+# more marks than a cluster holds
+printf 'o\xcc\x81\xcc\x82\xcc\x83\xcc\x84\xcc\x85\xcc\x86\xcc\x87\xcc\x88\xcc\x89\xcc\x8a\r\n'
+# the combining strike is still an attribute, of what follows
+printf 's\xcc\xb6t\r\n'
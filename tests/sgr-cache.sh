@@ -0,0 +1,18 @@
+#!/bin/sh
+
+# clear screen
+printf '\033[2J'
+
+# move
+printf '\033[2;1H'
+
+# same sequences applied over different attributes
+for i in 1 2 3; do
+   printf '\033[1;31mbold-red\033[0m \033[38;5;208morange\033[0m '
+   printf '\033[4mfoo\033[31mbar\033[1mqux\033[22mquux\r\n'
+   printf '\033[7;38;2;10;20;30mtruecolor\033[27mnoreverse\033[0m\r\n'
+   printf '\033[3m\033[1;31mitalic-bold-red\033[23m\033[39mbold\033[m\r\n'
+done
+
+# invalid sequences are not remembered
+printf '\033[1;38;5;300mfoo\033[1;38;5;300mbar\033[m\r\n'
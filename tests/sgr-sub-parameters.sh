@@ -0,0 +1,32 @@
+#!/bin/sh
+
+# clear screen
+printf '\033[2J'
+
+# fill space with E
+printf '\033#8'
+
+# move
+printf '\033[2;2H'
+# curly underline: underline, not italic
+printf '\033[4:3m'
+printf 'curly'
+# 4:0 is no underline
+printf '\033[4:0m'
+printf 'none'
+
+# move
+printf '\033[4;2H'
+# sub-parameters of an attribute are not attributes on their own
+printf '\033[m\033[1:2;7m'
+printf 'bold'
+printf '\033[m\033[38:5:1:2:9;4m'
+printf 'red'
+
+# move
+printf '\033[6;2H'
+# parameters and sub-parameters mixed
+printf '\033[m\033[4:1;38:2::10:200:30;48:5:4m'
+printf 'mixed'
+printf '\033[4:0;1m'
+printf 'bold'
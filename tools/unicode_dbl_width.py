@@ -61,157 +61,88 @@ def get_ranges(xmlfile):
     return (ranges_basic, ranges_emoji_double)
 
 
-def merge_ranges(ranges, is_same_width):
-    res = []
-    cur_range = ranges[0]
-    for r in ranges:
-        if is_same_width(r, cur_range):
-            cur_range = cur_range._replace(end=r.end)
-        else:
-            res.append(cur_range)
-            cur_range = r
-    res.append(cur_range)
-    return res
+PAGE_BITS = 8
+PAGE_SIZE = 1 << PAGE_BITS
+PAGE_WORDS = PAGE_SIZE // 32
 
-def skip_ranges(ranges, width_skipped):
+def wide_ranges(ranges, widths):
+    """[start, end] of the codepoints whose width is in widths"""
     res = []
-    for r in ranges:
-        if r.width not in width_skipped:
-            res.append(r)
+    prev = None
+    for r in ranges[1:]:
+        if r.width in widths:
+            if prev is not None and prev.width in widths:
+                res[-1] = (res[-1][0], r.end)
+            else:
+                res.append((r.start, r.end))
+        prev = r
     return res
 
-def gen_header(mininum_codepoint, file_header):
+def gen_tables(tables):
+    """
+    Two stages: the codepoint divided by PAGE_SIZE indexes, in the table of
+    a variant, a page of bits shared by all the variants
+    """
+    maximum_codepoint = max(t[-1][1] for t in tables)
+    nb_pages = (maximum_codepoint >> PAGE_BITS) + 1
+    pages = [(0,) * PAGE_WORDS]
+    page_ids = {pages[0]: 0}
+    indexes = []
+    for ranges in tables:
+        bits = [0] * nb_pages * PAGE_WORDS
+        for (start, end) in ranges:
+            for cp in range(start, end + 1):
+                bits[cp >> 5] |= 1 << (cp & 31)
+        index = []
+        for p in range(nb_pages):
+            page = tuple(bits[p * PAGE_WORDS:(p + 1) * PAGE_WORDS])
+            if page not in page_ids:
+                page_ids[page] = len(pages)
+                pages.append(page)
+            index.append(page_ids[page])
+        indexes.append(index)
+    assert len(pages) <= 256
+    return (maximum_codepoint, nb_pages, pages, indexes)
+
+def gen_header(mininum_codepoint, maximum_codepoint, nb_pages, nb_bits,
+               file_header):
     file_header.write(
 """/* XXX: Code generated by tool unicode_dbl_width.py */
 #ifndef TERMINOLOGY_TERMPTY_DBL_H_
 #define TERMINOLOGY_TERMPTY_DBL_H_ 1
 
-Eina_Bool _termpty_is_wide(const Eina_Unicode g, Eina_Bool emoji_dbl_width);
-Eina_Bool _termpty_is_ambigous_wide(const Eina_Unicode g, Eina_Bool emoji_dbl_width);
+""")
+    file_header.write(f"#define TERMPTY_DBL_PAGE_BITS {PAGE_BITS}\n")
+    file_header.write(f"#define TERMPTY_DBL_MAX 0x{maximum_codepoint:X}\n")
+    file_header.write(
+f"""
+/* Pages of the tables, by [cjk_ambiguous_wide][emoji_dbl_width] */
+extern const uint8_t _termpty_dbl_pages[2][2][{nb_pages}];
+/* Bits of the pages, set on double-width codepoints */
+extern const uint32_t _termpty_dbl_bits[{nb_bits}][{PAGE_WORDS}];
 
 static inline Eina_Bool
 _termpty_is_dblwidth_get(const Termpty *ty, const Eina_Unicode g)
-{
+{{
+   const uint8_t *pages;
+
    /* optimize for latin1 non-ambiguous */
 """)
-    file_header.write(f"   if (g <= 0x{mininum_codepoint:X})")
+    file_header.write(f"   if ((g <= 0x{mininum_codepoint:X}) || (g > TERMPTY_DBL_MAX))")
     file_header.write(
 """
      return EINA_FALSE;
-   if (!ty->termstate.cjk_ambiguous_wide)
-     return _termpty_is_wide(g, ty->config->emoji_dbl_width);
-   else
-     return _termpty_is_ambigous_wide(g, ty->config->emoji_dbl_width);
+   pages = _termpty_dbl_pages[ty->termstate.cjk_ambiguous_wide]
+      [!!ty->config->emoji_dbl_width];
+   return (_termpty_dbl_bits[pages[g >> TERMPTY_DBL_PAGE_BITS]]
+           [(g >> 5) & ((1 << (TERMPTY_DBL_PAGE_BITS - 5)) - 1)]
+           >> (g & 31)) & 1;
 }
 
 #endif
 """)
 
-def gen_ambigous(ranges_basic, ranges_emoji_double, file_source):
-    def handle_ranges(ranges):
-        def is_same_width(r1, r2):
-            if r1.width == 'N':
-                return r2.width == 'N'
-            else:
-                return r2.width in ('A', 'W')
-        ranges = merge_ranges(ranges[1:], is_same_width)
-        ranges = skip_ranges(ranges, ('N',))
-        fallthrough = " EINA_FALLTHROUGH;"
-        for idx, r in enumerate(ranges):
-            if r.width == 'N':
-                continue;
-            if idx == len(ranges) -1:
-                fallthrough = ""
-            if r.start == r.end:
-                file_source.write(f"           case 0x{r.start:X}:{fallthrough}\n")
-            else:
-                file_source.write(f"           case 0x{r.start:X} ... 0x{r.end:X}:{fallthrough}\n")
-
-    file_source.write(
-"""
-__attribute__((const))
-Eina_Bool
-_termpty_is_ambigous_wide(Eina_Unicode g, Eina_Bool emoji_dbl_width)
-{
-   if (emoji_dbl_width)
-     {
-        switch (g)
-          {
-""")
-    handle_ranges(ranges_emoji_double)
-    file_source.write(
-"""             return EINA_TRUE;
-         }
-     }
-   else
-     {
-        switch (g)
-          {
-""")
-    handle_ranges(ranges_basic)
-    file_source.write(
-"""             return EINA_TRUE;
-          }
-     }
-   return EINA_FALSE;
-}
-""")
-
-
-def gen_wide(ranges_basic, ranges_emoji_double, file_source):
-    def handle_ranges(ranges):
-        def is_same_width(r1, r2):
-            if r1.width in ('N', 'A'):
-                return r2.width in ('N', 'A')
-            else:
-                return r2.width == 'W'
-        ranges = merge_ranges(ranges[1:], is_same_width)
-        ranges = skip_ranges(ranges, ('N', 'A'))
-        fallthrough = " EINA_FALLTHROUGH;"
-        for idx, r in enumerate(ranges):
-            if r.width in ('N', 'A'):
-                continue;
-            if idx == len(ranges) -1:
-                fallthrough = ""
-            if r.start == r.end:
-                file_source.write(f"        case 0x{r.start:X}:{fallthrough}\n")
-            else:
-                file_source.write(f"        case 0x{r.start:X} ... 0x{r.end:X}:{fallthrough}\n")
-
-    file_source.write(
-"""
-__attribute__((const))
-Eina_Bool
-_termpty_is_wide(Eina_Unicode g, Eina_Bool emoji_dbl_width)
-{
-   if (emoji_dbl_width)
-     {
-        switch (g)
-          {
-""")
-    handle_ranges(ranges_emoji_double)
-    file_source.write(
-"""             return EINA_TRUE;
-          }
-     }
-   else
-     {
-        switch (g)
-          {
-""")
-    handle_ranges(ranges_basic)
-    file_source.write(
-"""             return EINA_TRUE;
-          }
-     }
-   return EINA_FALSE;
-}
-""")
-
-
-def gen_c(ranges_basic, ranges_emoji_double, file_header, file_source):
-    mininum_codepoint = min(ranges_basic[0].end, ranges_emoji_double[0].end)
-    gen_header(mininum_codepoint, file_header)
+def gen_source(pages, indexes, file_source):
     file_source.write(
 """/* XXX: Code generated by tool unicode_dbl_width.py */
 #include "private.h"
@@ -219,16 +150,50 @@ def gen_c(ranges_basic, ranges_emoji_double, file_header, file_source):
 #include <Elementary.h>
 #include "termpty.h"
 #include "termptydbl.h"
-""")
-    gen_ambigous(ranges_basic, ranges_emoji_double, file_source)
-    gen_wide(ranges_basic, ranges_emoji_double, file_source)
-
-parser = argparse.ArgumentParser(description='Generate code handling different widths of unicode codepoints.')
-parser.add_argument('xml', type=argparse.FileType('r'))
-parser.add_argument('header', type=argparse.FileType('w'))
-parser.add_argument('source', type=argparse.FileType('w'))
 
-args = parser.parse_args()
+const uint8_t _termpty_dbl_pages[2][2][""")
+    file_source.write(f"{len(indexes[0])}] =\n{{\n")
+    names = ("not ambiguous, no emoji", "not ambiguous, emoji",
+             "ambiguous, no emoji", "ambiguous, emoji")
+    for ambiguous in (0, 1):
+        file_source.write("   {\n")
+        for emoji in (0, 1):
+            index = indexes[ambiguous * 2 + emoji]
+            file_source.write(f"      /* {names[ambiguous * 2 + emoji]} */\n")
+            file_source.write("      {\n")
+            for i in range(0, len(index), 16):
+                line = ", ".join(f"{v:3d}" for v in index[i:i + 16])
+                file_source.write(f"         {line},\n")
+            file_source.write("      },\n")
+        file_source.write("   },\n")
+    file_source.write("};\n\n")
+    file_source.write(
+f"const uint32_t _termpty_dbl_bits[{len(pages)}][{PAGE_WORDS}] =\n{{\n")
+    for page in pages:
+        words = [f"0x{w:08X}" for w in page]
+        file_source.write("   { " + ", ".join(words[:4]) + ",\n")
+        file_source.write("     " + ", ".join(words[4:]) + " },\n")
+    file_source.write("};\n")
 
-(ranges_basic, ranges_emoji_double) = get_ranges(args.xml)
-gen_c(ranges_basic, ranges_emoji_double, args.header, args.source)
+def gen_c(ranges_basic, ranges_emoji_double, file_header, file_source):
+    mininum_codepoint = min(ranges_basic[0].end, ranges_emoji_double[0].end)
+    # same order as _termpty_dbl_pages
+    tables = [wide_ranges(ranges_basic, ('W',)),
+              wide_ranges(ranges_emoji_double, ('W',)),
+              wide_ranges(ranges_basic, ('A', 'W')),
+              wide_ranges(ranges_emoji_double, ('A', 'W'))]
+    (maximum_codepoint, nb_pages, pages, indexes) = gen_tables(tables)
+    gen_header(mininum_codepoint, maximum_codepoint, nb_pages, len(pages),
+               file_header)
+    gen_source(pages, indexes, file_source)
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Generate code handling different widths of unicode codepoints.')
+    parser.add_argument('xml', type=argparse.FileType('r'))
+    parser.add_argument('header', type=argparse.FileType('w'))
+    parser.add_argument('source', type=argparse.FileType('w'))
+
+    args = parser.parse_args()
+
+    (ranges_basic, ranges_emoji_double) = get_ranges(args.xml)
+    gen_c(ranges_basic, ranges_emoji_double, args.header, args.source)